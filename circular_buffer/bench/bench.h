@@ -0,0 +1,134 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <utility>
+
+namespace bench
+{
+
+using clock_type = std::chrono::steady_clock;
+
+// Keeps the compiler from discarding a value that is otherwise unused.
+template<typename T>
+inline void do_not_optimize(const T& value)
+{
+#if defined(__GNUC__)
+    asm volatile("" : : "m"(value) : "memory");
+#else
+    static const volatile void* sink;
+    sink = &value;
+#endif
+}
+
+/*
+    Every result is also written to csv() when it is open, one line per value:
+
+        benchmark,name,metric,value
+
+    metric is ns_per_op, p50_ns, p99_ns, p999_ns, max_ns, peak_bytes, live_bytes,
+    allocations, steals or steal_rate.
+*/
+inline std::ofstream& csv()
+{
+    static std::ofstream stream;
+    return stream;
+}
+
+// The registered benchmark that is running.
+inline std::string& current_benchmark()
+{
+    static std::string name;
+    return name;
+}
+
+template<typename Value>
+inline void write_csv(const std::string& name, const char* metric, Value value)
+{
+    if(csv().is_open())
+        csv() << current_benchmark() << ',' << name << ',' << metric << ',' << value << '\n';
+}
+
+template<typename F>
+clock_type::duration measure(F&& f)
+{
+    const auto start = clock_type::now();
+    std::forward<F>(f)();
+    return clock_type::now() - start;
+}
+
+inline void report(const std::string& name, std::size_t operations, clock_type::duration elapsed)
+{
+    const auto ns = std::chrono::duration<double, std::nano>(elapsed).count();
+    const auto ns_per_op = ns / static_cast<double>(operations);
+    std::cout << std::left << std::setw(48) << name << std::right
+              << std::fixed << std::setprecision(3)
+              << std::setw(12) << ns_per_op << " ns/op"
+              << std::setw(12) << (1.0e3 / ns_per_op) << " Mops/s"
+              << std::endl;
+    write_csv(name, "ns_per_op", ns_per_op);
+}
+
+// samples: nanoseconds.
+inline void report_latency(const std::string& name, std::vector<std::int64_t> samples)
+{
+    if(samples.empty())
+        return;
+    std::sort(samples.begin(), samples.end());
+    const auto percentile = [&samples](double p)
+    {
+        const auto index = static_cast<std::size_t>(p * static_cast<double>(samples.size() - 1));
+        return samples[index];
+    };
+    std::cout << std::left << std::setw(48) << name << std::right
+              << " p50=" << percentile(0.50) << "ns"
+              << " p99=" << percentile(0.99) << "ns"
+              << " p999=" << percentile(0.999) << "ns"
+              << " max=" << samples.back() << "ns"
+              << std::endl;
+    write_csv(name, "p50_ns", percentile(0.50));
+    write_csv(name, "p99_ns", percentile(0.99));
+    write_csv(name, "p999_ns", percentile(0.999));
+    write_csv(name, "max_ns", samples.back());
+}
+
+// live: bytes still allocated at the end.
+inline void report_memory(const std::string& name, std::size_t peak, std::size_t live)
+{
+    std::cout << std::left << std::setw(48) << name << std::right
+              << " peak=" << (peak / 1024) << "KiB"
+              << " live=" << (live / 1024) << "KiB"
+              << std::endl;
+    write_csv(name, "peak_bytes", peak);
+    write_csv(name, "live_bytes", live);
+}
+
+using function_type = void (*)();
+
+struct entry
+{
+    std::string name;
+    function_type function;
+};
+
+inline std::vector<entry>& registry()
+{
+    static std::vector<entry> entries;
+    return entries;
+}
+
+struct registrar
+{
+    registrar(const char* name, function_type function)
+    {
+        registry().push_back({ name, function });
+    }
+};
+
+}   // namespace bench
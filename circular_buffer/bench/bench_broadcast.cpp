@@ -0,0 +1,96 @@
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <string>
+#include "bench.h"
+#include "spsc_circular_buffer.h"
+#include "broadcast_ring.h"
+
+namespace
+{
+
+constexpr std::size_t count = 1 << 20;
+constexpr std::size_t ring_capacity = 4096;
+
+// What the broadcast ring replaces: one copy per consumer.
+void copy_per_consumer(std::size_t consumer_count)
+{
+    using queue_type = container::spsc_circular_buffer<std::uint64_t>;
+    std::vector<std::unique_ptr<queue_type>> queues;
+    for(std::size_t c = 0; c < consumer_count; c++)
+        queues.push_back(std::make_unique<queue_type>(ring_capacity));
+
+    const auto elapsed = bench::measure([&]()
+    {
+        std::vector<std::thread> consumers;
+        for(std::size_t c = 0; c < consumer_count; c++)
+        {
+            consumers.emplace_back([&queue = *queues[c]]()
+            {
+                std::uint64_t sum = 0;
+                std::uint64_t value;
+                for(std::size_t i = 0; i < count; i++)
+                {
+                    while(!queue.try_pop_front(value))
+                        std::this_thread::yield();
+                    sum += value;
+                }
+                bench::do_not_optimize(sum);
+            });
+        }
+        for(std::uint64_t i = 0; i < count; i++)
+        {
+            for(auto& queue : queues)
+            {
+                while(!queue->try_push_back(i))
+                    std::this_thread::yield();
+            }
+        }
+        for(auto& consumer : consumers)
+            consumer.join();
+    });
+    bench::report("spsc_per_consumer/consumers=" + std::to_string(consumer_count), count, elapsed);
+}
+
+void broadcast(const std::string& name, container::wait_strategy strategy, std::size_t consumer_count)
+{
+    container::broadcast_ring<std::uint64_t> ring(ring_capacity, consumer_count, strategy);
+
+    const auto elapsed = bench::measure([&]()
+    {
+        std::vector<std::thread> consumers;
+        for(std::size_t c = 0; c < consumer_count; c++)
+        {
+            consumers.emplace_back([&ring, c]()
+            {
+                std::uint64_t sum = 0;
+                while(ring.consume(c, [&sum](std::uint64_t value) { sum += value; }) > 0)
+                    ;
+                bench::do_not_optimize(sum);
+            });
+        }
+        for(std::uint64_t i = 0; i < count; i++)
+            ring.push(i);
+        ring.close();
+        for(auto& consumer : consumers)
+            consumer.join();
+    });
+    bench::report("broadcast/" + name + "/consumers=" + std::to_string(consumer_count), count, elapsed);
+}
+
+void run()
+{
+    const std::size_t consumer_counts[] = { 1, 2, 3 };
+    for(auto consumers : consumer_counts)
+    {
+        copy_per_consumer(consumers);
+        broadcast("busy_spin", container::wait_strategy::busy_spin, consumers);
+        broadcast("yield", container::wait_strategy::yield, consumers);
+        broadcast("block", container::wait_strategy::block, consumers);
+    }
+}
+
+const bench::registrar registrar("broadcast", &run);
+
+}   // namespace
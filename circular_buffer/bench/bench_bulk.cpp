@@ -0,0 +1,71 @@
+#include <cstddef>
+#include <vector>
+#include <string>
+#include "bench.h"
+#include "circular_buffer.h"
+
+namespace
+{
+
+constexpr std::size_t capacity = 16384;
+constexpr std::size_t total = 32 * 1024 * 1024;
+
+void per_element(std::size_t block)
+{
+    container::circular_buffer<float> cb(capacity);
+    std::vector<float> input(block, 1.f);
+    std::vector<float> output(block);
+
+    const auto elapsed = bench::measure([&]()
+    {
+        for(std::size_t done = 0; done < total; done += block)
+        {
+            for(std::size_t i = 0; i < block; i++)
+                cb.push_back(input[i]);
+            for(std::size_t i = 0; i < block; i++)
+            {
+                output[i] = cb.front();
+                cb.pop_front();
+            }
+            bench::do_not_optimize(output.front());
+        }
+    });
+    bench::report("per_element/block=" + std::to_string(block), total, elapsed);
+}
+
+void bulk(std::size_t block)
+{
+    container::circular_buffer<float> cb(capacity);
+    std::vector<float> input(block, 1.f);
+    std::vector<float> output(block);
+
+    // Start off-center so that blocks keep straddling the wrap point.
+    cb.push_back(input.data(), input.data() + block / 2);
+    cb.pop_front(block / 2);
+
+    const auto elapsed = bench::measure([&]()
+    {
+        for(std::size_t done = 0; done < total; done += block)
+        {
+            cb.push_back(input.data(), input.data() + block);
+            cb.copy_out(output.data(), block);
+            cb.pop_front(block);
+            bench::do_not_optimize(output.front());
+        }
+    });
+    bench::report("bulk/block=" + std::to_string(block), total, elapsed);
+}
+
+void run()
+{
+    const std::size_t blocks[] = { 16, 256, 4096 };
+    for(auto block : blocks)
+    {
+        per_element(block);
+        bulk(block);
+    }
+}
+
+const bench::registrar registrar("bulk", &run);
+
+}   // namespace
@@ -0,0 +1,80 @@
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "bench.h"
+#include "circular_buffer.h"
+#include "byte_ring.h"
+
+namespace
+{
+
+constexpr std::size_t total = std::size_t(1) << 30;
+constexpr std::size_t ring_size = 64 * 1024;
+
+// Proxies `total` bytes from one pipe to another through a staging buffer.
+template<typename Forward>
+void run_proxy(const std::string& name, std::size_t chunk, Forward forward)
+{
+    int in[2];
+    int out[2];
+    if((::pipe(in) != 0) || (::pipe(out) != 0))
+        return;
+
+    const std::vector<char> source(chunk, 'x');
+    std::vector<char> sink(chunk);
+    const auto elapsed = bench::measure([&]()
+    {
+        for(std::size_t done = 0; done < total; done += chunk)
+        {
+            if(::write(in[1], source.data(), chunk) != static_cast<ssize_t>(chunk))
+                return;
+            forward(in[0], out[1], chunk);
+            for(std::size_t n = 0; n < chunk;)
+                n += static_cast<std::size_t>(::read(out[0], sink.data(), chunk - n));
+        }
+    });
+    bench::report(name + "/chunk=" + std::to_string(chunk), total / chunk, elapsed);
+
+    for(auto fd : { in[0], in[1], out[0], out[1] })
+        ::close(fd);
+}
+
+void run()
+{
+    for(const std::size_t chunk : { std::size_t(512), std::size_t(4096), std::size_t(16384) })
+    {
+        // What the proxy did before: read into a temporary array, stage, then copy out again to write.
+        container::circular_buffer<char> cb(ring_size);
+        std::vector<char> temp(ring_size);
+        run_proxy("circular_buffer<char>+copies", chunk, [&](int from, int to, std::size_t count)
+        {
+            for(std::size_t n = 0; n < count;)
+            {
+                const auto r = static_cast<std::size_t>(::read(from, temp.data(), cb.capacity() - cb.size()));
+                cb.insert_back(temp.data(), r);
+                n += r;
+            }
+            while(!cb.is_empty())
+            {
+                const auto size = cb.size();
+                cb.copy_out(temp.data(), size);
+                cb.pop_front(static_cast<std::size_t>(::write(to, temp.data(), size)));
+            }
+        });
+
+        container::byte_ring ring(ring_size);
+        run_proxy("byte_ring", chunk, [&ring](int from, int to, std::size_t count)
+        {
+            for(std::size_t n = 0; n < count;)
+                n += static_cast<std::size_t>(ring.read_from(from));
+            while(!ring.is_empty())
+                ring.write_to(to);
+        });
+    }
+}
+
+const bench::registrar registrar("byte_ring", &run);
+
+}   // namespace
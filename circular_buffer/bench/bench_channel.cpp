@@ -0,0 +1,148 @@
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+#include <string>
+#include <iterator>
+#include "bench.h"
+#include "circular_buffer.h"
+#include "channel.h"
+
+namespace
+{
+
+// The usual hand-rolled queue: notifies on every operation, whether anyone waits or not.
+template<typename T>
+class mutex_cv_queue final
+{
+public:
+    explicit mutex_cv_queue(std::size_t capacity)
+        : buffer_(capacity), closed_(false)
+    {}
+
+    bool push(const T& item)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_full_.wait(lock, [this]() { return closed_ || !buffer_.is_full(); });
+        if(closed_)
+            return false;
+        buffer_.push_back(item);
+        lock.unlock();
+        not_empty_.notify_one();
+        return true;
+    }
+
+    bool pop(T& item)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_empty_.wait(lock, [this]() { return closed_ || !buffer_.is_empty(); });
+        if(buffer_.is_empty())
+            return false;
+        item = buffer_.front();
+        buffer_.pop_front();
+        lock.unlock();
+        not_full_.notify_one();
+        return true;
+    }
+
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        not_empty_.notify_all();
+        not_full_.notify_all();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    container::circular_buffer<T> buffer_;
+    bool closed_;
+};
+
+constexpr std::uint64_t total = 1 << 20;
+
+struct single_pop {};
+struct batch_pop {};
+
+template<typename Queue>
+std::uint64_t consume(Queue& queue, single_pop)
+{
+    std::uint64_t sum = 0;
+    std::uint64_t value = 0;
+    while(queue.pop(value))
+        sum += value;
+    return sum;
+}
+
+template<typename Queue>
+std::uint64_t consume(Queue& queue, batch_pop)
+{
+    std::uint64_t sum = 0;
+    std::vector<std::uint64_t> batch;
+    while(queue.pop_all(std::back_inserter(batch)) > 0)
+    {
+        for(auto value : batch)
+            sum += value;
+        batch.clear();
+    }
+    return sum;
+}
+
+template<typename Queue, typename PopMode>
+void run_queue(const std::string& name, std::size_t capacity, std::size_t producers, std::size_t consumers, PopMode mode)
+{
+    Queue queue(capacity);
+    std::vector<std::uint64_t> sums(consumers);
+
+    const auto elapsed = bench::measure([&]()
+    {
+        std::vector<std::thread> consumer_threads;
+        for(std::size_t i = 0; i < consumers; i++)
+            consumer_threads.emplace_back([&queue, &sums, i, mode]() { sums[i] = consume(queue, mode); });
+
+        std::vector<std::thread> producer_threads;
+        for(std::size_t i = 0; i < producers; i++)
+        {
+            producer_threads.emplace_back([&queue, producers]()
+            {
+                for(std::uint64_t value = 0; value < total / producers; value++)
+                    queue.push(value);
+            });
+        }
+        for(auto& thread : producer_threads)
+            thread.join();
+        queue.close();
+        for(auto& thread : consumer_threads)
+            thread.join();
+    });
+    bench::do_not_optimize(sums);
+
+    bench::report(name + "/N=" + std::to_string(capacity)
+        + "/" + std::to_string(producers) + "P" + std::to_string(consumers) + "C", total, elapsed);
+}
+
+void run()
+{
+    using value_type = std::uint64_t;
+
+    const std::size_t configs[][2] = { { 1, 1 }, { 2, 2 }, { 4, 1 } };
+    for(const std::size_t capacity : { std::size_t(64), std::size_t(1024) })
+    {
+        for(const auto& config : configs)
+        {
+            run_queue<mutex_cv_queue<value_type>>("mutex+condition_variable", capacity, config[0], config[1], single_pop());
+            run_queue<container::channel<value_type>>("channel", capacity, config[0], config[1], single_pop());
+            run_queue<container::channel<value_type>>("channel/pop_all", capacity, config[0], config[1], batch_pop());
+        }
+    }
+}
+
+const bench::registrar registrar("channel", &run);
+
+}   // namespace
@@ -0,0 +1,209 @@
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include <string>
+#include "bench.h"
+#include "circular_buffer.h"
+
+namespace
+{
+
+constexpr std::size_t total = 1 << 21;
+
+struct pod64
+{
+    std::uint64_t values[8];
+};
+
+static_assert(sizeof(pod64) == 64, "pod64 is meant to fill a cache line.");
+
+template<typename T> T make_value(std::size_t i);
+template<> std::uint32_t make_value<std::uint32_t>(std::size_t i) { return static_cast<std::uint32_t>(i); }
+template<> pod64 make_value<pod64>(std::size_t i) { return pod64{ { i, i, i, i, i, i, i, i } }; }
+// Long enough to live on the heap.
+template<> std::string make_value<std::string>(std::size_t i) { return std::string(32, static_cast<char>('a' + i % 26)); }
+
+std::uint64_t key_of(std::uint32_t value) { return value; }
+std::uint64_t key_of(const pod64& value) { return value.values[0]; }
+std::uint64_t key_of(const std::string& value) { return static_cast<std::uint64_t>(value[0]); }
+
+// A bounded queue over circular_buffer.
+template<typename T>
+class ring_queue
+{
+public:
+    explicit ring_queue(std::size_t capacity) : cb_(capacity) {}
+
+    void push(T value) { cb_.push_back(std::move(value)); }
+    void pop() { cb_.pop_front(); }
+    const T& front() const { return cb_.front(); }
+    const T& operator[](std::size_t index) const { return cb_[index]; }
+    std::size_t size() const { return cb_.size(); }
+    auto begin() const { return cb_.begin(); }
+    auto end() const { return cb_.end(); }
+
+private:
+    container::circular_buffer<T> cb_;
+};
+
+template<typename T>
+class deque_queue
+{
+public:
+    explicit deque_queue(std::size_t) {}
+
+    void push(T value) { deque_.push_back(std::move(value)); }
+    void pop() { deque_.pop_front(); }
+    const T& front() const { return deque_.front(); }
+    const T& operator[](std::size_t index) const { return deque_[index]; }
+    std::size_t size() const { return deque_.size(); }
+    auto begin() const { return deque_.begin(); }
+    auto end() const { return deque_.end(); }
+
+private:
+    std::deque<T> deque_;
+};
+
+// Pops by advancing an index and compacts once the popped prefix outgrows the rest.
+template<typename T>
+class vector_queue
+{
+public:
+    explicit vector_queue(std::size_t capacity) : head_(0) { vector_.reserve(capacity); }
+
+    void push(T value) { vector_.push_back(std::move(value)); }
+
+    void pop()
+    {
+        if(++head_ > vector_.size() / 2)
+        {
+            vector_.erase(vector_.begin(), vector_.begin() + static_cast<std::ptrdiff_t>(head_));
+            head_ = 0;
+        }
+    }
+
+    const T& front() const { return vector_[head_]; }
+    const T& operator[](std::size_t index) const { return vector_[head_ + index]; }
+    std::size_t size() const { return vector_.size() - head_; }
+    auto begin() const { return vector_.begin() + static_cast<std::ptrdiff_t>(head_); }
+    auto end() const { return vector_.end(); }
+
+private:
+    std::vector<T> vector_;
+    std::size_t head_;
+};
+
+template<typename Queue, typename T>
+void fill(Queue& queue, std::size_t count, const std::vector<T>& values)
+{
+    for(std::size_t i = 0; i < count; i++)
+        queue.push(values[i % values.size()]);
+}
+
+template<typename T, template<typename> class Queue>
+void run_for(const std::string& prefix, std::size_t capacity, const std::vector<T>& values)
+{
+    const auto suffix = "/capacity=" + std::to_string(capacity);
+
+    {   // Steady state at half the capacity.
+        Queue<T> queue(capacity);
+        fill(queue, capacity / 2, values);
+        const auto elapsed = bench::measure([&]()
+        {
+            std::uint64_t sum = 0;
+            for(std::size_t i = 0; i < total; i++)
+            {
+                queue.push(values[i % values.size()]);
+                sum += key_of(queue.front());
+                queue.pop();
+            }
+            bench::do_not_optimize(sum);
+        });
+        bench::report(prefix + "/push_pop" + suffix, total, elapsed);
+    }
+    {   // Fill up, then drain.
+        Queue<T> queue(capacity);
+        const auto elapsed = bench::measure([&]()
+        {
+            std::uint64_t sum = 0;
+            for(std::size_t done = 0; done < total; done += capacity)
+            {
+                fill(queue, capacity, values);
+                for(std::size_t i = 0; i < capacity; i++)
+                {
+                    sum += key_of(queue.front());
+                    queue.pop();
+                }
+            }
+            bench::do_not_optimize(sum);
+        });
+        bench::report(prefix + "/fill_drain" + suffix, total, elapsed);
+    }
+
+    // Exactly capacity elements in every queue, starting mid-storage so that circular_buffer wraps.
+    // ring_queue does not grow, so it is never filled beyond its capacity.
+    Queue<T> queue(capacity);
+    fill(queue, capacity, values);
+    for(std::size_t i = 0; i < capacity / 2; i++)
+        queue.pop();
+    fill(queue, capacity / 2, values);
+    const auto size = queue.size();
+    {
+        const auto elapsed = bench::measure([&]()
+        {
+            std::uint64_t sum = 0;
+            for(std::size_t done = 0; done < total; done += size)
+            {
+                for(const auto& value : queue)
+                    sum += key_of(value);
+            }
+            bench::do_not_optimize(sum);
+        });
+        bench::report(prefix + "/iterate" + suffix, total, elapsed);
+    }
+    {
+        const auto elapsed = bench::measure([&]()
+        {
+            std::uint64_t sum = 0;
+            std::uint32_t state = 1;
+            for(std::size_t i = 0; i < total; i++)
+            {
+                // xorshift32
+                state ^= state << 13;
+                state ^= state >> 17;
+                state ^= state << 5;
+                sum += key_of(queue[state % size]);
+            }
+            bench::do_not_optimize(sum);
+        });
+        bench::report(prefix + "/random_access" + suffix, total, elapsed);
+    }
+}
+
+template<typename T>
+void run_type(const std::string& type_name)
+{
+    std::vector<T> values;
+    for(std::size_t i = 0; i < 64; i++)
+        values.push_back(make_value<T>(i));
+
+    const std::size_t capacities[] = { 64, 4096, 262144 };
+    for(auto capacity : capacities)
+    {
+        run_for<T, ring_queue>("circular_buffer/" + type_name, capacity, values);
+        run_for<T, deque_queue>("std::deque/" + type_name, capacity, values);
+        run_for<T, vector_queue>("vector_queue/" + type_name, capacity, values);
+    }
+}
+
+void run()
+{
+    run_type<std::uint32_t>("uint32");
+    run_type<pod64>("pod64");
+    run_type<std::string>("string");
+}
+
+const bench::registrar registrar("containers", &run);
+
+}   // namespace
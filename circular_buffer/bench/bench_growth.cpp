@@ -0,0 +1,125 @@
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include "bench.h"
+#include "circular_buffer.h"
+
+namespace
+{
+
+// Bytes held by every counting_allocator.
+struct footprint
+{
+    std::size_t live = 0;
+    std::size_t peak = 0;
+};
+
+footprint usage;
+
+template<typename T>
+struct counting_allocator
+{
+    using value_type = T;
+
+    counting_allocator() = default;
+
+    template<typename U>
+    counting_allocator(const counting_allocator<U>&) noexcept {}
+
+    T* allocate(std::size_t n)
+    {
+        usage.live += n * sizeof(T);
+        usage.peak = (std::max)(usage.peak, usage.live);
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept
+    {
+        usage.live -= n * sizeof(T);
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    friend bool operator == (const counting_allocator&, const counting_allocator&) noexcept { return true; }
+    friend bool operator != (const counting_allocator&, const counting_allocator&) noexcept { return false; }
+};
+
+struct message
+{
+    std::uint64_t words[8];
+};
+
+using buffer_type = container::circular_buffer<message, counting_allocator<message>>;
+
+constexpr std::size_t connections = 4096;
+constexpr std::size_t rounds = 64;
+constexpr std::size_t trickle = 8;
+constexpr std::size_t burst = 4096;
+constexpr std::size_t bursty_stride = 64;    // One connection in 64 sees a burst every round.
+
+/*
+    Thousands of per-connection rings that are mostly idle.
+    Each round, every connection receives a few messages and a few busy ones receive a burst,
+    then every ring is drained.
+*/
+template<typename AfterDrain>
+void run_policy(const std::string& name, std::size_t initial_capacity, std::size_t limit, AfterDrain after_drain)
+{
+    usage = footprint();
+
+    std::vector<buffer_type> rings;
+    rings.reserve(connections);
+    for(std::size_t i = 0; i < connections; i++)
+    {
+        rings.emplace_back(initial_capacity);
+        rings.back().set_growth_limit(limit);
+    }
+
+    std::size_t pushes = 0;
+    const auto elapsed = bench::measure([&]()
+    {
+        std::uint64_t sum = 0;
+        for(std::size_t round = 0; round < rounds; round++)
+        {
+            for(std::size_t i = 0; i < connections; i++)
+            {
+                auto& cb = rings[i];
+                const auto count = (i % bursty_stride == 0)? burst : trickle;
+                for(std::size_t j = 0; j < count; j++)
+                    cb.push_back(message{ { j } });
+                pushes += count;
+
+                while(!cb.is_empty())
+                {
+                    sum += cb.front().words[0];
+                    cb.pop_front();
+                }
+                after_drain(cb);
+            }
+        }
+        bench::do_not_optimize(sum);
+    });
+
+    bench::report(name, pushes, elapsed);
+    bench::report_memory(name, usage.peak, usage.live);
+}
+
+void run()
+{
+    const auto keep = [](buffer_type&){};
+
+    run_policy("growth/fixed=4096", burst, 0, keep);
+    run_policy("growth/doubling_16..4096", 16, burst, keep);
+    run_policy("growth/doubling_16..4096+shrink_to_fit", 16, burst, [](buffer_type& cb)
+    {
+        if(cb.capacity() > 16)
+            cb.shrink_to_fit();
+    });
+    run_policy("growth/doubling_16..1024(lossy)", 16, 1024, keep);
+}
+
+const bench::registrar registrar("growth", &run);
+
+}   // namespace
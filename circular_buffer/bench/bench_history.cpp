@@ -0,0 +1,153 @@
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <unordered_map>
+#include <vector>
+#include "bench.h"
+#include "circular_buffer.h"
+#include "history_ring.h"
+
+namespace
+{
+
+struct message
+{
+    std::uint64_t sequence;
+    std::uint64_t fields[7];
+};
+
+constexpr std::size_t capacity = 1 << 16;
+constexpr std::size_t pushes = 1 << 22;
+constexpr std::size_t lookups = 1 << 22;
+constexpr std::size_t range_length = 64;
+
+// The replay requests: mostly recent sequences, some evicted or not yet written.
+std::vector<std::uint64_t> requests(std::uint64_t next_sequence, std::size_t count)
+{
+    std::mt19937_64 engine(1);
+    std::uniform_int_distribution<std::uint64_t> dist(next_sequence - capacity - capacity / 8, next_sequence + capacity / 8);
+    std::vector<std::uint64_t> result(count);
+    for(auto& sequence : result)
+        sequence = dist(engine);
+    return result;
+}
+
+// The side map the history ring replaces: sequence to the number of pushes before it.
+class mapped_history final
+{
+public:
+    explicit mapped_history(std::size_t n) : buffer_(n), evicted_(0) { index_.reserve(n); }
+
+    void push_back(const message& m)
+    {
+        if(buffer_.is_full())
+        {
+            index_.erase(buffer_.front().sequence);
+            buffer_.pop_front();
+            ++evicted_;
+        }
+        index_.emplace(m.sequence, evicted_ + buffer_.size());
+        buffer_.push_back(m);
+    }
+
+    const message* get(std::uint64_t sequence) const
+    {
+        const auto it = index_.find(sequence);
+        return (it != index_.end())? &buffer_[static_cast<std::size_t>(it->second - evicted_)] : nullptr;
+    }
+
+private:
+    container::circular_buffer<message> buffer_;
+    std::unordered_map<std::uint64_t, std::uint64_t> index_;
+    std::uint64_t evicted_;
+};
+
+void run()
+{
+    container::history_ring<message> ring(capacity);
+    mapped_history mapped(capacity);
+    {
+        const auto elapsed = bench::measure([&]()
+        {
+            for(std::uint64_t i = 0; i < pushes; i++)
+                ring.push_back(message{ i, {} });
+        });
+        bench::report("history_ring/push_back", pushes, elapsed);
+    }
+    {
+        const auto elapsed = bench::measure([&]()
+        {
+            for(std::uint64_t i = 0; i < pushes; i++)
+                mapped.push_back(message{ i, {} });
+        });
+        bench::report("map/push_back", pushes, elapsed);
+    }
+
+    const auto sequences = requests(ring.next_sequence(), lookups);
+    {
+        std::uint64_t sum = 0;
+        const auto elapsed = bench::measure([&]()
+        {
+            for(auto sequence : sequences)
+            {
+                const auto result = ring.get(sequence);
+                if(result.first == container::history_status::found)
+                    sum += result.second->fields[0] + result.second->sequence;
+            }
+        });
+        bench::do_not_optimize(sum);
+        bench::report("history_ring/get", lookups, elapsed);
+    }
+    {
+        std::uint64_t sum = 0;
+        const auto elapsed = bench::measure([&]()
+        {
+            for(auto sequence : sequences)
+            {
+                if(const auto m = mapped.get(sequence))
+                    sum += m->fields[0] + m->sequence;
+            }
+        });
+        bench::do_not_optimize(sum);
+        bench::report("map/get", lookups, elapsed);
+    }
+
+    // Replaying range_length messages from each requested sequence.
+    const std::size_t range_count = lookups / range_length;
+    {
+        std::uint64_t sum = 0;
+        const auto elapsed = bench::measure([&]()
+        {
+            for(std::size_t i = 0; i < range_count; i++)
+            {
+                const auto ranges = ring.range(sequences[i], sequences[i] + range_length);
+                for(std::size_t k = 0; k < ranges.first.second; k++)
+                    sum += ranges.first.first[k].sequence;
+                for(std::size_t k = 0; k < ranges.second.second; k++)
+                    sum += ranges.second.first[k].sequence;
+            }
+        });
+        bench::do_not_optimize(sum);
+        bench::report("history_ring/range", range_count * range_length, elapsed);
+    }
+    {
+        std::uint64_t sum = 0;
+        const auto elapsed = bench::measure([&]()
+        {
+            for(std::size_t i = 0; i < range_count; i++)
+            {
+                for(auto sequence = sequences[i]; sequence < sequences[i] + range_length; sequence++)
+                {
+                    if(const auto m = mapped.get(sequence))
+                        sum += m->sequence;
+                }
+            }
+        });
+        bench::do_not_optimize(sum);
+        bench::report("map/range", range_count * range_length, elapsed);
+    }
+}
+
+const bench::registrar registrar("history", &run);
+
+}   // namespace
@@ -0,0 +1,136 @@
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <string>
+#include <numeric>
+#include <algorithm>
+#include "bench.h"
+#include "circular_buffer.h"
+#include "circular_buffer_algorithm.h"
+
+namespace
+{
+
+constexpr std::size_t total = 64 * 1024 * 1024;
+
+// Leaves the head in the middle of the storage so that both segments are used.
+container::circular_buffer<std::int32_t> make_buffer(std::size_t capacity)
+{
+    container::circular_buffer<std::int32_t> cb(capacity);
+    for(std::size_t i = 0; i < capacity + capacity / 2; i++)
+        cb.push_back(static_cast<std::int32_t>(i % 7));
+    return cb;
+}
+
+void iterator_accumulate(std::size_t capacity)
+{
+    const auto cb = make_buffer(capacity);
+    const auto elapsed = bench::measure([&cb, capacity]()
+    {
+        std::int32_t sum = 0;
+        for(std::size_t done = 0; done < total; done += capacity)
+            sum += std::accumulate(cb.begin(), cb.end(), std::int32_t(0));
+        bench::do_not_optimize(sum);
+    });
+    bench::report("iterator/accumulate/capacity=" + std::to_string(capacity), total, elapsed);
+}
+
+void iterator_copy(std::size_t capacity)
+{
+    const auto cb = make_buffer(capacity);
+    std::vector<std::int32_t> out(capacity);
+    const auto elapsed = bench::measure([&cb, &out, capacity]()
+    {
+        for(std::size_t done = 0; done < total; done += capacity)
+        {
+            std::copy(cb.begin(), cb.end(), out.begin());
+            bench::do_not_optimize(out.front());
+        }
+    });
+    bench::report("iterator/copy/capacity=" + std::to_string(capacity), total, elapsed);
+}
+
+void iterator_find(std::size_t capacity)
+{
+    auto cb = make_buffer(capacity);
+    cb.back() = -1;
+    const auto elapsed = bench::measure([&cb, capacity]()
+    {
+        for(std::size_t done = 0; done < total; done += capacity)
+            bench::do_not_optimize(std::find(cb.begin(), cb.end(), -1));
+    });
+    bench::report("iterator/find/capacity=" + std::to_string(capacity), total, elapsed);
+}
+
+void segmented_accumulate(std::size_t capacity)
+{
+    const auto cb = make_buffer(capacity);
+    const auto elapsed = bench::measure([&cb, capacity]()
+    {
+        std::int32_t sum = 0;
+        for(std::size_t done = 0; done < total; done += capacity)
+            sum += container::accumulate(cb, std::int32_t(0));
+        bench::do_not_optimize(sum);
+    });
+    bench::report("segmented/accumulate/capacity=" + std::to_string(capacity), total, elapsed);
+}
+
+void segmented_copy(std::size_t capacity)
+{
+    const auto cb = make_buffer(capacity);
+    std::vector<std::int32_t> out(capacity);
+    const auto elapsed = bench::measure([&cb, &out, capacity]()
+    {
+        for(std::size_t done = 0; done < total; done += capacity)
+        {
+            container::transform(cb, out.begin(), [](std::int32_t item) { return item; });
+            bench::do_not_optimize(out.front());
+        }
+    });
+    bench::report("segmented/transform/capacity=" + std::to_string(capacity), total, elapsed);
+}
+
+void segmented_for_each(std::size_t capacity)
+{
+    auto cb = make_buffer(capacity);
+    const auto elapsed = bench::measure([&cb, capacity]()
+    {
+        for(std::size_t done = 0; done < total; done += capacity)
+        {
+            container::for_each(cb, [](std::int32_t& item) { item += 1; });
+            bench::do_not_optimize(cb.front());
+        }
+    });
+    bench::report("segmented/for_each/capacity=" + std::to_string(capacity), total, elapsed);
+}
+
+void segmented_find(std::size_t capacity)
+{
+    auto cb = make_buffer(capacity);
+    cb.back() = -1;
+    const auto elapsed = bench::measure([&cb, capacity]()
+    {
+        for(std::size_t done = 0; done < total; done += capacity)
+            bench::do_not_optimize(container::find(cb, -1));
+    });
+    bench::report("segmented/find/capacity=" + std::to_string(capacity), total, elapsed);
+}
+
+void run()
+{
+    const std::size_t capacities[] = { 1024, 1024 * 1024 };
+    for(auto capacity : capacities)
+    {
+        iterator_accumulate(capacity);
+        iterator_copy(capacity);
+        iterator_find(capacity);
+        segmented_accumulate(capacity);
+        segmented_copy(capacity);
+        segmented_for_each(capacity);
+        segmented_find(capacity);
+    }
+}
+
+const bench::registrar registrar("iteration", &run);
+
+}   // namespace
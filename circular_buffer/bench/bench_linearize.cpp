@@ -0,0 +1,82 @@
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "bench.h"
+#include "circular_buffer.h"
+
+namespace
+{
+
+constexpr std::size_t reps = 8;
+
+// Leaves size elements that wrap around the end of the storage, half on each side.
+template<typename T>
+void make_wrapped(container::circular_buffer<T>& cb, std::size_t size)
+{
+    cb.clear();
+    const auto offset = cb.capacity() - size / 2;
+    for(std::size_t i = 0; i < offset; i++)
+        cb.push_back(T());
+    cb.pop_front(offset);
+    for(std::size_t i = 0; i < size; i++)
+        cb.push_back(T());
+}
+
+// Times f alone, after a fresh make_wrapped each time.
+template<typename T, typename F>
+bench::clock_type::duration time_wrapped(container::circular_buffer<T>& cb, std::size_t size, F f)
+{
+    bench::clock_type::duration elapsed{};
+    for(std::size_t i = 0; i < reps; i++)
+    {
+        make_wrapped(cb, size);
+        elapsed += bench::measure([&]() { f(cb); });
+    }
+    return elapsed;
+}
+
+template<typename T>
+void run_for(const std::string& type_name, std::size_t capacity)
+{
+    container::circular_buffer<T> cb(capacity);
+    std::vector<T> dest(capacity);
+
+    const std::size_t percents[] = { 1, 10, 50, 90, 100 };
+    for(auto percent : percents)
+    {
+        const auto size = capacity * percent / 100;
+        const auto suffix = "/" + type_name + "/fill=" + std::to_string(percent) + "%";
+
+        bench::report("linearize" + suffix, reps, time_wrapped(cb, size, [](auto& buffer)
+        {
+            buffer.linearize();
+        }));
+        // What linearize did before when the buffer was not full.
+        bench::report("move_to_new_storage" + suffix, reps, time_wrapped(cb, size, [](auto& buffer)
+        {
+            container::circular_buffer<T> temp(buffer.capacity());
+            for(auto& item : buffer)
+                temp.push_back(std::move(item));
+            buffer = std::move(temp);
+        }));
+        bench::report("copy_linearized" + suffix, reps, time_wrapped(cb, size, [&dest](const auto& buffer)
+        {
+            bench::do_not_optimize(buffer.copy_linearized(dest.data()));
+        }));
+        bench::report("to_vector" + suffix, reps, time_wrapped(cb, size, [](const auto& buffer)
+        {
+            bench::do_not_optimize(buffer.to_vector());
+        }));
+    }
+}
+
+void run()
+{
+    run_for<std::uint32_t>("uint32", std::size_t(1) << 22);
+    run_for<std::string>("string", std::size_t(1) << 18);
+}
+
+const bench::registrar registrar("linearize", &run);
+
+}   // namespace
@@ -0,0 +1,41 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include "bench.h"
+
+int main(int argc, char* argv[])
+{
+    // Runs every registered benchmark whose name contains the filter.
+    // --csv path also writes the results to path, for comparing runs.
+    std::string filter;
+    for(int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        if((arg == "--csv") && (i + 1 < argc))
+        {
+            bench::csv().open(argv[++i]);
+            if(!bench::csv())
+            {
+                std::cerr << "cannot open " << argv[i] << std::endl;
+                return 1;
+            }
+            bench::csv() << std::fixed << std::setprecision(3);
+            bench::csv() << "benchmark,name,metric,value" << '\n';
+        }
+        else
+        {
+            filter = arg;
+        }
+    }
+
+    for(const auto& entry : bench::registry())
+    {
+        if(entry.name.find(filter) == std::string::npos)
+            continue;
+        std::cout << "# " << entry.name << std::endl;
+        bench::current_benchmark() = entry.name;
+        entry.function();
+        std::cout << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,74 @@
+#if defined(__unix__) || defined(__APPLE__)
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <unistd.h>
+#include "bench.h"
+#include "circular_buffer.h"
+#include "mapped_circular_buffer.h"
+
+namespace
+{
+
+struct record
+{
+    std::uint64_t timestamp;
+    double values[7];
+};
+
+constexpr std::size_t capacity = 1 << 16;
+
+template<typename Buffer>
+void push(const std::string& name, Buffer& cb, std::size_t count)
+{
+    const auto elapsed = bench::measure([&]()
+    {
+        for(std::size_t i = 0; i < count; i++)
+            cb.push_back(record{ i, {} });
+    });
+    bench::report(name, count, elapsed);
+}
+
+void run()
+{
+    const auto path = "/tmp/bench_mapped_" + std::to_string(::getpid()) + ".ring";
+    constexpr std::size_t count = 1 << 22;
+
+    {
+        container::circular_buffer<record> cb(capacity);
+        push("circular_buffer/push_back", cb, count);
+    }
+    {
+        container::mapped_circular_buffer<record> cb(path, capacity);
+        push("mapped/push_back/none", cb, count);
+    }
+    std::remove(path.c_str());
+    {
+        container::mapped_circular_buffer<record> cb(path, capacity, container::sync_policy::async);
+        push("mapped/push_back/async", cb, count / 64);
+    }
+    std::remove(path.c_str());
+    {
+        container::mapped_circular_buffer<record> cb(path, capacity, container::sync_policy::sync);
+        push("mapped/push_back/sync", cb, 1 << 10);
+    }
+    {   // Reopening maps the file and checks a header, whatever the capacity.
+        constexpr std::size_t reopens = 1 << 10;
+        const auto elapsed = bench::measure([&]()
+        {
+            for(std::size_t i = 0; i < reopens; i++)
+            {
+                container::mapped_circular_buffer<record> cb(path, capacity);
+                bench::do_not_optimize(cb.size());
+            }
+        });
+        bench::report("mapped/reopen", reopens, elapsed);
+    }
+    std::remove(path.c_str());
+}
+
+const bench::registrar registrar("mapped", &run);
+
+}   // namespace
+#endif
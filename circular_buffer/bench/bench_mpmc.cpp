@@ -0,0 +1,122 @@
+#include <cstdint>
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <thread>
+#include <vector>
+#include <string>
+#include "bench.h"
+#include "mpmc_queue.h"
+
+namespace
+{
+
+using queue_type = container::mpmc_queue<std::uint64_t>;
+
+constexpr std::size_t batch_size = 32;
+
+void produce(queue_type& queue, std::uint64_t first, std::uint64_t count, bool bulk)
+{
+    if(!bulk)
+    {
+        for(auto value = first; value < first + count; value++)
+        {
+            while(!queue.try_push(value))
+                std::this_thread::yield();
+        }
+        return;
+    }
+
+    std::uint64_t batch[batch_size];
+    for(std::uint64_t done = 0; done < count;)
+    {
+        const auto n = static_cast<std::size_t>(std::min<std::uint64_t>(batch_size, count - done));
+        for(std::size_t i = 0; i < n; i++)
+            batch[i] = first + done + i;
+        std::size_t pushed = 0;
+        while(pushed < n)
+        {
+            const auto k = queue.try_push_bulk(batch + pushed, batch + n);
+            if(k == 0)
+                std::this_thread::yield();
+            pushed += k;
+        }
+        done += n;
+    }
+}
+
+std::uint64_t consume(queue_type& queue, std::atomic<std::uint64_t>& remaining, bool bulk)
+{
+    std::uint64_t sum = 0;
+    std::uint64_t batch[batch_size];
+    while(remaining.load(std::memory_order_relaxed) > 0)
+    {
+        std::size_t n = 0;
+        if(bulk)
+        {
+            n = queue.try_pop_bulk(batch, batch_size);
+        }
+        else if(queue.try_pop(batch[0]))
+        {
+            n = 1;
+        }
+        if(n == 0)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        for(std::size_t i = 0; i < n; i++)
+            sum += batch[i];
+        remaining.fetch_sub(n, std::memory_order_relaxed);
+    }
+    return sum;
+}
+
+void throughput(std::size_t producers, std::size_t consumers, bool bulk)
+{
+    constexpr std::uint64_t count = 2000000;
+    const auto per_producer = count / producers;
+    const auto total = per_producer * producers;
+
+    queue_type queue(1024);
+    std::atomic<std::uint64_t> remaining(total);
+
+    const auto elapsed = bench::measure([&]()
+    {
+        std::vector<std::thread> threads;
+        for(std::size_t p = 0; p < producers; p++)
+            threads.emplace_back(produce, std::ref(queue), p * per_producer, per_producer, bulk);
+        for(std::size_t c = 0; c < consumers; c++)
+        {
+            threads.emplace_back([&queue, &remaining, bulk]()
+            {
+                bench::do_not_optimize(consume(queue, remaining, bulk));
+            });
+        }
+        for(auto& thread : threads)
+            thread.join();
+    });
+
+    const std::string name = std::string(bulk? "bulk" : "single")
+        + "/producers=" + std::to_string(producers)
+        + "/consumers=" + std::to_string(consumers);
+    bench::report(name, static_cast<std::size_t>(total), elapsed);
+}
+
+void run()
+{
+    const std::size_t max_threads = std::max(2u, std::thread::hardware_concurrency());
+
+    for(std::size_t producers = 1; producers <= max_threads; producers *= 2)
+    {
+        for(std::size_t consumers = 1; consumers <= max_threads; consumers *= 2)
+        {
+            throughput(producers, consumers, false);
+            throughput(producers, consumers, true);
+        }
+    }
+}
+
+const bench::registrar registrar("mpmc", &run);
+
+}   // namespace
@@ -0,0 +1,106 @@
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <string>
+#include <random>
+#include "bench.h"
+#include "circular_buffer.h"
+#include "pow2_circular_buffer.h"
+
+namespace
+{
+
+constexpr std::size_t total = 16 * 1024 * 1024;
+
+// Leaves the head in the middle of the storage so that accesses wrap.
+template<typename Buffer>
+void fill(Buffer& cb)
+{
+    for(std::size_t i = 0; i < cb.capacity() + cb.capacity() / 2; i++)
+        cb.push_back(static_cast<std::uint32_t>(i));
+}
+
+template<typename Buffer>
+void random_access(const std::string& name, std::size_t capacity)
+{
+    Buffer cb(capacity);
+    fill(cb);
+
+    std::mt19937 engine(1);
+    std::uniform_int_distribution<std::size_t> distribution(0, capacity - 1);
+    std::vector<std::size_t> indices(4096);
+    for(auto& index : indices)
+        index = distribution(engine);
+
+    const auto elapsed = bench::measure([&]()
+    {
+        std::uint32_t sum = 0;
+        for(std::size_t done = 0; done < total; done += indices.size())
+        {
+            for(auto index : indices)
+                sum += cb[index];
+        }
+        bench::do_not_optimize(sum);
+    });
+    bench::report(name + "/random_access/capacity=" + std::to_string(capacity), total, elapsed);
+}
+
+template<typename Buffer>
+void iteration(const std::string& name, std::size_t capacity)
+{
+    Buffer cb(capacity);
+    fill(cb);
+
+    const auto elapsed = bench::measure([&]()
+    {
+        std::uint32_t sum = 0;
+        for(std::size_t done = 0; done < total; done += capacity)
+        {
+            for(auto item : cb)
+                sum += item;
+        }
+        bench::do_not_optimize(sum);
+    });
+    bench::report(name + "/iteration/capacity=" + std::to_string(capacity), total, elapsed);
+}
+
+template<typename Buffer>
+void push_pop(const std::string& name, std::size_t capacity)
+{
+    Buffer cb(capacity);
+    fill(cb);
+
+    const auto elapsed = bench::measure([&]()
+    {
+        std::uint32_t sum = 0;
+        for(std::size_t i = 0; i < total; i++)
+        {
+            cb.push_back(static_cast<std::uint32_t>(i));
+            sum += cb.front();
+            cb.pop_front();
+        }
+        bench::do_not_optimize(sum);
+    });
+    bench::report(name + "/push_pop/capacity=" + std::to_string(capacity), total, elapsed);
+}
+
+void run()
+{
+    using plain = container::circular_buffer<std::uint32_t>;
+    using pow2 = container::pow2_circular_buffer<std::uint32_t>;
+
+    const std::size_t capacities[] = { 1024, 1024 * 1024 };
+    for(auto capacity : capacities)
+    {
+        random_access<plain>("circular_buffer", capacity);
+        random_access<pow2>("pow2_circular_buffer", capacity);
+        iteration<plain>("circular_buffer", capacity);
+        iteration<pow2>("pow2_circular_buffer", capacity);
+        push_pop<plain>("circular_buffer", capacity);
+        push_pop<pow2>("pow2_circular_buffer", capacity);
+    }
+}
+
+const bench::registrar registrar("pow2", &run);
+
+}   // namespace
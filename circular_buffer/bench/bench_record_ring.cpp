@@ -0,0 +1,94 @@
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "bench.h"
+#include "circular_buffer.h"
+#include "record_ring.h"
+
+namespace
+{
+
+constexpr std::size_t count = 1 << 20;
+constexpr std::size_t batch = 32;
+constexpr std::size_t max_message_size = 4096;
+
+// Mostly small messages with an occasional large one, 16 bytes to 4 KiB.
+std::vector<std::size_t> message_sizes()
+{
+    std::mt19937 engine(1);
+    std::uniform_int_distribution<std::size_t> small(16, 256);
+    std::uniform_int_distribution<std::size_t> large(257, max_message_size);
+    std::uniform_int_distribution<int> percent(0, 99);
+    std::vector<std::size_t> sizes(4096);
+    for(auto& size : sizes)
+        size = (percent(engine) < 90)? small(engine) : large(engine);
+    return sizes;
+}
+
+std::uint64_t digest(const unsigned char* data, std::size_t size)
+{
+    return data[0] + data[size - 1] + size;
+}
+
+// What the record ring replaces: one heap block per message.
+void heap_blocks(const std::vector<std::size_t>& sizes, const std::vector<unsigned char>& source)
+{
+    container::circular_buffer<std::vector<unsigned char>> cb(batch);
+    std::uint64_t sum = 0;
+    const auto elapsed = bench::measure([&]()
+    {
+        for(std::size_t i = 0; i < count; i += batch)
+        {
+            for(std::size_t k = 0; k < batch; k++)
+            {
+                const auto size = sizes[(i + k) % sizes.size()];
+                cb.push_back(std::vector<unsigned char>(source.data(), source.data() + size));
+            }
+            while(!cb.is_empty())
+            {
+                sum += digest(cb.front().data(), cb.front().size());
+                cb.pop_front();
+            }
+        }
+    });
+    bench::do_not_optimize(sum);
+    bench::report("circular_buffer<vector>", count, elapsed);
+}
+
+void record_ring(const std::vector<std::size_t>& sizes, const std::vector<unsigned char>& source)
+{
+    container::record_ring ring(batch * container::record_ring::footprint(max_message_size));
+    std::uint64_t sum = 0;
+    const auto elapsed = bench::measure([&]()
+    {
+        for(std::size_t i = 0; i < count; i += batch)
+        {
+            for(std::size_t k = 0; k < batch; k++)
+                ring.try_push_back(source.data(), sizes[(i + k) % sizes.size()]);
+            while(!ring.is_empty())
+            {
+                const auto record = ring.front();
+                sum += digest(record.first, record.second);
+                ring.pop_front();
+            }
+        }
+    });
+    bench::do_not_optimize(sum);
+    bench::report("record_ring", count, elapsed);
+}
+
+void run()
+{
+    const auto sizes = message_sizes();
+    std::vector<unsigned char> source(max_message_size);
+    for(std::size_t i = 0; i < source.size(); i++)
+        source[i] = static_cast<unsigned char>(i);
+
+    heap_blocks(sizes, source);
+    record_ring(sizes, source);
+}
+
+const bench::registrar registrar("record_ring", &run);
+
+}   // namespace
@@ -0,0 +1,52 @@
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "bench.h"
+#include "rollup_ring.h"
+
+namespace
+{
+
+using ring_type = container::rollup_ring<double>;
+
+constexpr std::int64_t second = 1000;   // Times are in milliseconds.
+constexpr std::int64_t step = 10;       // One sample every 10 ms.
+constexpr std::size_t samples = std::size_t(1) << 24;
+
+void run()
+{
+    // A second for an hour, a minute for a day, an hour for a month.
+    ring_type ring({ { second, 3600 }, { 60 * second, 1440 }, { 3600 * second, 720 } });
+
+    const auto ingest = bench::measure([&]()
+    {
+        for(std::size_t i = 0; i < samples; i++)
+            ring.push(static_cast<std::int64_t>(i) * step, 1.0);
+    });
+    bench::report("rollup_ring/push", samples, ingest);
+
+    constexpr std::size_t queries = 1 << 14;
+    const auto now = static_cast<std::int64_t>(samples) * step;
+    for(const auto span : { 60 * second, 3600 * second, 24 * 3600 * second })
+    {
+        const auto elapsed = bench::measure([&]()
+        {
+            for(std::size_t i = 0; i < queries; i++)
+                bench::do_not_optimize(ring.query(now - span, now));
+        });
+        bench::report("rollup_ring/query/span=" + std::to_string(span / second) + "s", queries, elapsed);
+    }
+
+    std::size_t bytes = 0;
+    for(std::size_t i = 0; i < ring.tier_count(); i++)
+        bytes += ring.tier(i).capacity() * sizeof(ring_type::bucket);
+    bench::report_memory("rollup_ring", bytes, bytes);
+
+    // Raw samples over the same 31 days, for comparison.
+    const auto raw = static_cast<std::size_t>(31 * 24 * 3600 * second / step) * sizeof(ring_type::bucket);
+    bench::report_memory("raw samples", raw, raw);
+}
+
+const bench::registrar registrar("rollup", &run);
+
+}   // namespace
@@ -0,0 +1,108 @@
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+#include <iostream>
+#include "bench.h"
+#include "circular_buffer.h"
+
+namespace
+{
+
+std::size_t allocations = 0;
+
+template<typename T>
+struct counting_allocator
+{
+    using value_type = T;
+
+    counting_allocator() = default;
+
+    template<typename U>
+    counting_allocator(const counting_allocator<U>&) noexcept {}
+
+    T* allocate(std::size_t n)
+    {
+        ++allocations;
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept
+    {
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    friend bool operator == (const counting_allocator&, const counting_allocator&) noexcept { return true; }
+    friend bool operator != (const counting_allocator&, const counting_allocator&) noexcept { return false; }
+};
+
+void report_allocations(const std::string& name)
+{
+    std::cout << "  allocations=" << allocations << std::endl;
+    bench::write_csv(name, "allocations", allocations);
+}
+
+constexpr std::size_t buffers = std::size_t(1) << 16;
+constexpr std::size_t rounds = 16;
+constexpr std::size_t capacity = 8;
+
+// Many short-lived small buffers, each filled past its capacity.
+template<std::size_t InlineN>
+void create_destroy(const std::string& name)
+{
+    using buffer_type = container::circular_buffer<std::uint32_t, counting_allocator<std::uint32_t>, InlineN>;
+
+    allocations = 0;
+    const auto elapsed = bench::measure([]()
+    {
+        for(std::size_t i = 0; i < buffers * rounds; i++)
+        {
+            buffer_type cb(capacity);
+            for(std::uint32_t j = 0; j < 2 * capacity; j++)
+                cb.push_back(j);
+            bench::do_not_optimize(cb.front());
+        }
+    });
+    bench::report("create_destroy/" + name, buffers * rounds, elapsed);
+    report_allocations("create_destroy/" + name);
+}
+
+// A table of small buffers, such as one per connection, visited round after round.
+template<std::size_t InlineN>
+void visit_table(const std::string& name)
+{
+    using buffer_type = container::circular_buffer<std::uint32_t, counting_allocator<std::uint32_t>, InlineN>;
+
+    allocations = 0;
+    std::vector<buffer_type> table;
+    table.reserve(buffers);
+    for(std::size_t i = 0; i < buffers; i++)
+        table.emplace_back(capacity);
+
+    const auto elapsed = bench::measure([&table]()
+    {
+        for(std::uint32_t r = 0; r < rounds; r++)
+        {
+            for(auto& cb : table)
+            {
+                cb.push_back(r);
+                bench::do_not_optimize(cb.front() + cb.back());
+            }
+        }
+    });
+    bench::report("visit_table/" + name, buffers * rounds, elapsed);
+    report_allocations("visit_table/" + name);
+}
+
+void run()
+{
+    create_destroy<0>("allocator");
+    create_destroy<capacity>("inline");
+    visit_table<0>("allocator");
+    visit_table<capacity>("inline");
+}
+
+const bench::registrar registrar("sbo", &run);
+
+}   // namespace
@@ -0,0 +1,101 @@
+#include <cstdint>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <string>
+#include "bench.h"
+#include "circular_buffer.h"
+#include "seqlock_circular_buffer.h"
+
+namespace
+{
+
+struct sample
+{
+    std::uint64_t timestamp;
+    double value;
+};
+
+constexpr std::size_t ring_capacity = 4096;
+constexpr std::size_t latest = 256;
+
+// What the seqlock replaces: readers copy under the writer's lock.
+class locked_buffer
+{
+public:
+    explicit locked_buffer(std::size_t capacity)
+        : cb_(capacity)
+    {}
+
+    void push_back(const sample& item)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cb_.push_back(item);
+    }
+
+    std::size_t read_latest(sample* dest, std::size_t count) const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        count = (std::min)(count, cb_.size());
+        std::copy(cb_.end() - static_cast<std::ptrdiff_t>(count), cb_.end(), dest);
+        return count;
+    }
+
+private:
+    mutable std::mutex mutex_;
+    container::circular_buffer<sample> cb_;
+};
+
+template<typename Buffer>
+void writer_throughput(const std::string& name, std::size_t reader_count)
+{
+    constexpr std::size_t count = 1 << 22;
+    Buffer buffer(ring_capacity);
+    std::atomic<bool> done(false);
+    std::atomic<std::size_t> reads(0);
+
+    std::vector<std::thread> readers;
+    for(std::size_t r = 0; r < reader_count; r++)
+    {
+        readers.emplace_back([&]()
+        {
+            std::vector<sample> dest(latest);
+            std::size_t local = 0;
+            while(!done.load(std::memory_order_relaxed))
+            {
+                bench::do_not_optimize(buffer.read_latest(dest.data(), latest));
+                local++;
+            }
+            reads.fetch_add(local);
+        });
+    }
+
+    const auto elapsed = bench::measure([&]()
+    {
+        for(std::size_t i = 0; i < count; i++)
+            buffer.push_back(sample{ i, 1.0 });
+    });
+    done.store(true);
+    for(auto& reader : readers)
+        reader.join();
+
+    const auto prefix = name + "/readers=" + std::to_string(reader_count);
+    bench::report(prefix + "/push_back", count, elapsed);
+    if(reader_count > 0)
+        bench::report(prefix + "/read_latest", reads.load(), elapsed);
+}
+
+void run()
+{
+    const std::size_t reader_counts[] = { 0, 1, 2, 4, 8, 16 };
+    for(auto readers : reader_counts)
+    {
+        writer_throughput<locked_buffer>("mutex", readers);
+        writer_throughput<container::seqlock_circular_buffer<sample>>("seqlock", readers);
+    }
+}
+
+const bench::registrar registrar("seqlock", &run);
+
+}   // namespace
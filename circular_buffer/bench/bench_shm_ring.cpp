@@ -0,0 +1,228 @@
+#if defined(__linux__)
+#include <cstddef>
+#include <cstdint>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "bench.h"
+#include "shm_spsc_ring.h"
+
+namespace
+{
+
+using ring = container::shm_spsc_ring<std::uint64_t>;
+
+constexpr std::size_t count = 1 << 22;
+constexpr std::size_t batch = 64;
+
+// Runs f in a child process; the caller waits for it.
+// The child exits with 125 if f throws, rather than unwinding into the rest of the benchmark.
+template<typename F>
+pid_t spawn(F f)
+{
+    const auto pid = ::fork();
+    if(pid == 0)
+    {
+        int status = 125;
+        try
+        {
+            status = f();
+        }
+        catch(...)
+        {
+        }
+        ::_exit(status);
+    }
+    return pid;
+}
+
+void wait_for(pid_t pid)
+{
+    int status = 0;
+    ::waitpid(pid, &status, 0);
+}
+
+std::string unique_name(const char* suffix)
+{
+    return "/bench_shm_ring_" + std::to_string(::getpid()) + "_" + suffix;
+}
+
+// The parent pushes, a child process pops until the ring is closed.
+void throughput(const std::string& name, std::size_t capacity, bool batched)
+{
+    const auto shm_name = unique_name("throughput");
+    ring::unlink(shm_name);
+    ring producer(shm_name, capacity);
+
+    const auto elapsed = bench::measure([&]()
+    {
+        const auto pid = spawn([&shm_name, capacity, batched]()
+        {
+            ring consumer(shm_name, capacity);
+            std::uint64_t sum = 0;
+            if(batched)
+            {
+                std::uint64_t items[batch];
+                for(;;)
+                {
+                    const auto n = consumer.try_pop(items, batch);
+                    for(std::size_t k = 0; k < n; k++)
+                        sum += items[k];
+                    if(n == 0)
+                    {
+                        std::uint64_t item;
+                        if(!consumer.pop(item))
+                            break;
+                        sum += item;
+                    }
+                }
+            }
+            else
+            {
+                std::uint64_t item;
+                while(consumer.pop(item))
+                    sum += item;
+            }
+            bench::do_not_optimize(sum);
+            return 0;
+        });
+
+        if(batched)
+        {
+            std::uint64_t items[batch];
+            for(std::size_t i = 0; i < count;)
+            {
+                for(std::size_t k = 0; k < batch; k++)
+                    items[k] = i + k;
+                std::size_t pushed = 0;
+                while(pushed < batch)
+                {
+                    const auto n = producer.try_push(items + pushed, batch - pushed);
+                    if(n == 0)
+                        std::this_thread::yield();
+                    pushed += n;
+                }
+                i += batch;
+            }
+        }
+        else
+        {
+            for(std::uint64_t i = 0; i < count; i++)
+            {
+                while(!producer.try_push(i))
+                    std::this_thread::yield();
+            }
+        }
+        producer.close();
+        wait_for(pid);
+    });
+    bench::report(name + "/capacity=" + std::to_string(capacity), count, elapsed);
+    ring::unlink(shm_name);
+}
+
+// Round trip through a pair of rings, to a child process that echoes.
+void latency()
+{
+    constexpr std::size_t round_trips = 100000;
+    const auto ping_name = unique_name("ping");
+    const auto pong_name = unique_name("pong");
+    ring::unlink(ping_name);
+    ring::unlink(pong_name);
+    ring ping(ping_name, 64);
+    ring pong(pong_name, 64);
+
+    const auto pid = spawn([&ping_name, &pong_name]()
+    {
+        ring in(ping_name, 64);
+        ring out(pong_name, 64);
+        std::uint64_t item;
+        while(in.pop(item))
+        {
+            while(!out.try_push(item))
+                std::this_thread::yield();
+        }
+        return 0;
+    });
+
+    std::vector<std::int64_t> samples;
+    samples.reserve(round_trips);
+    for(std::uint64_t i = 0; i < round_trips; i++)
+    {
+        const auto start = bench::clock_type::now();
+        ping.try_push(i);
+        std::uint64_t item = 0;
+        pong.pop(item);
+        const auto elapsed = bench::clock_type::now() - start;
+        bench::do_not_optimize(item);
+        samples.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    }
+    ping.close();
+    wait_for(pid);
+    ring::unlink(ping_name);
+    ring::unlink(pong_name);
+
+    bench::report_latency("shm/round_trip", std::move(samples));
+}
+
+// The same round trip through a pair of pipes, for reference.
+void pipe_latency()
+{
+    constexpr std::size_t round_trips = 100000;
+    int ping[2];
+    int pong[2];
+    if(::pipe(ping) != 0 || ::pipe(pong) != 0)
+        return;
+
+    const auto pid = spawn([&ping, &pong]()
+    {   // Without the other ends, the read sees the end of the stream once the parent closes.
+        ::close(ping[1]);
+        ::close(pong[0]);
+        std::uint64_t item;
+        while(::read(ping[0], &item, sizeof(item)) == sizeof(item))
+        {
+            if(::write(pong[1], &item, sizeof(item)) != sizeof(item))
+                return 1;
+        }
+        return 0;
+    });
+    ::close(ping[0]);
+    ::close(pong[1]);
+
+    std::vector<std::int64_t> samples;
+    samples.reserve(round_trips);
+    for(std::uint64_t i = 0; i < round_trips; i++)
+    {
+        const auto start = bench::clock_type::now();
+        std::uint64_t item = i;
+        if(::write(ping[1], &item, sizeof(item)) != sizeof(item) || ::read(pong[0], &item, sizeof(item)) != sizeof(item))
+            break;
+        const auto elapsed = bench::clock_type::now() - start;
+        bench::do_not_optimize(item);
+        samples.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    }
+    ::close(ping[1]);
+    wait_for(pid);
+    ::close(pong[0]);
+
+    bench::report_latency("pipe/round_trip", std::move(samples));
+}
+
+void run()
+{
+    const std::size_t capacities[] = { 1024, 65536 };
+    for(auto capacity : capacities)
+    {
+        throughput("shm/try_push", capacity, false);
+        throughput("shm/try_push_batch", capacity, true);
+    }
+    latency();
+    pipe_latency();
+}
+
+const bench::registrar registrar("shm_ring", &run);
+
+}   // namespace
+#endif
@@ -0,0 +1,121 @@
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include "bench.h"
+#include "circular_buffer.h"
+#include "circular_buffer_algorithm.h"
+#include "sliding_window.h"
+
+namespace
+{
+
+using value_type = double;
+
+struct statistics
+{
+    double sum;
+    double mean;
+    double variance;
+    value_type min;
+    value_type max;
+};
+
+// What we did before: recompute everything over the window on every tick.
+statistics recompute(const container::circular_buffer<value_type>& cb)
+{
+    statistics result;
+    const auto n = static_cast<double>(cb.size());
+    result.sum = container::accumulate(cb, 0.0);
+    result.mean = result.sum / n;
+    result.variance = container::accumulate(cb, 0.0, [&result](double acc, value_type value)
+    {
+        const auto d = value - result.mean;
+        return acc + d * d;
+    }) / n;
+    result.min = container::accumulate(cb, cb.front(), [](value_type a, value_type b) { return (std::min)(a, b); });
+    result.max = container::accumulate(cb, cb.front(), [](value_type a, value_type b) { return (std::max)(a, b); });
+    return result;
+}
+
+template<typename Window>
+statistics read(const Window& window)
+{
+    return { window.sum(), window.mean(), window.variance(), window.min(), window.max() };
+}
+
+void run_for(std::size_t window_size, const std::vector<value_type>& input)
+{
+    const auto suffix = "/W=" + std::to_string(window_size);
+    const auto mask = input.size() - 1;
+
+    {   // The naive version gets fewer ticks, or it would run for hours.
+        const auto ticks = (std::max<std::size_t>)(64, (std::size_t(1) << 26) / window_size);
+        container::circular_buffer<value_type> cb(window_size);
+        for(std::size_t i = 0; i < window_size; i++)
+            cb.push_back(input[i & mask]);
+        const auto elapsed = bench::measure([&]()
+        {
+            for(std::size_t i = 0; i < ticks; i++)
+            {
+                cb.push_back(input[i & mask]);
+                bench::do_not_optimize(recompute(cb));
+            }
+        });
+        bench::report("naive_recompute" + suffix, ticks, elapsed);
+    }
+
+    constexpr std::size_t ticks = std::size_t(1) << 22;
+    {
+        container::sliding_window<value_type> window(window_size);
+        for(std::size_t i = 0; i < window_size; i++)
+            window.push_back(input[i & mask]);
+        const auto elapsed = bench::measure([&]()
+        {
+            for(std::size_t i = 0; i < ticks; i++)
+            {
+                window.push_back(input[i & mask]);
+                bench::do_not_optimize(read(window));
+            }
+        });
+        bench::report("sliding_window" + suffix, ticks, elapsed);
+    }
+
+    // A tick delivers a batch of values; ops are values.
+    for(const std::size_t batch : { std::size_t(16), std::size_t(256) })
+    {
+        if(batch >= window_size)
+            continue;
+        container::sliding_window<value_type> window(window_size);
+        for(std::size_t i = 0; i < window_size; i++)
+            window.push_back(input[i & mask]);
+        const auto elapsed = bench::measure([&]()
+        {
+            for(std::size_t i = 0; i < ticks; i += batch)
+            {
+                window.push_back(input.data() + (i & mask), batch);
+                bench::do_not_optimize(read(window));
+            }
+        });
+        bench::report("sliding_window/batch=" + std::to_string(batch) + suffix, ticks, elapsed);
+    }
+}
+
+void run()
+{
+    // A power of two, so that a batch never crosses the end.
+    std::vector<value_type> input(std::size_t(1) << 16);
+    std::mt19937 engine(1);
+    std::normal_distribution<value_type> distribution(0.0, 1.0);
+    for(auto& value : input)
+        value = distribution(engine);
+
+    for(const std::size_t window_size : { std::size_t(64), std::size_t(1024), std::size_t(16384), std::size_t(262144), std::size_t(1) << 20 })
+        run_for(window_size, input);
+}
+
+const bench::registrar registrar("sliding_window", &run);
+
+}   // namespace
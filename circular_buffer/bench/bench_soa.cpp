@@ -0,0 +1,75 @@
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "bench.h"
+#include "circular_buffer.h"
+#include "circular_buffer_algorithm.h"
+#include "soa_circular_buffer.h"
+
+namespace
+{
+
+struct row
+{
+    std::int64_t timestamp;
+    double price;
+    double qty;
+    std::uint32_t flags;
+};
+
+constexpr std::size_t rows = std::size_t(1) << 20;
+constexpr std::size_t scans = 64;
+
+// Sums the price column of a wrapped buffer.
+void run()
+{
+    container::circular_buffer<row> aos(rows);
+    container::soa_circular_buffer<std::int64_t, double, double, std::uint32_t> soa(rows);
+    for(std::size_t i = 0; i < rows + rows / 3; i++)
+    {
+        const auto price = static_cast<double>(i % 1000) * 0.25;
+        aos.push_back(row{ static_cast<std::int64_t>(i), price, 1.0, 0 });
+        soa.push_back(static_cast<std::int64_t>(i), price, 1.0, 0);
+    }
+
+    const auto aos_elapsed = bench::measure([&]()
+    {
+        for(std::size_t i = 0; i < scans; i++)
+            bench::do_not_optimize(container::accumulate(aos, 0.0, [](double sum, const row& r) { return sum + r.price; }));
+    });
+    bench::report("circular_buffer<row>/sum_price", rows * scans, aos_elapsed);
+
+    const auto soa_elapsed = bench::measure([&]()
+    {
+        for(std::size_t i = 0; i < scans; i++)
+            bench::do_not_optimize(container::accumulate(soa.column<1>(), 0.0));
+    });
+    bench::report("soa_circular_buffer/sum_price", rows * scans, soa_elapsed);
+
+    const auto aos_filter = bench::measure([&]()
+    {
+        for(std::size_t i = 0; i < scans; i++)
+        {
+            std::size_t count = 0;
+            container::for_each(aos, [&count](const row& r) { count += (r.price > 100.0)? 1 : 0; });
+            bench::do_not_optimize(count);
+        }
+    });
+    bench::report("circular_buffer<row>/count_price", rows * scans, aos_filter);
+
+    auto prices = soa.column<1>();
+    const auto soa_filter = bench::measure([&]()
+    {
+        for(std::size_t i = 0; i < scans; i++)
+        {
+            std::size_t count = 0;
+            container::for_each(prices, [&count](double price) { count += (price > 100.0)? 1 : 0; });
+            bench::do_not_optimize(count);
+        }
+    });
+    bench::report("soa_circular_buffer/count_price", rows * scans, soa_filter);
+}
+
+const bench::registrar registrar("soa", &run);
+
+}   // namespace
@@ -0,0 +1,132 @@
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <string>
+#include "bench.h"
+#include "circular_buffer.h"
+#include "spsc_circular_buffer.h"
+
+namespace
+{
+
+// What the lock-free variant replaces.
+template<typename T>
+class locked_circular_buffer
+{
+public:
+    explicit locked_circular_buffer(std::size_t capacity)
+        : cb_(capacity)
+    {}
+
+    bool try_push_back(const T& item)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if(cb_.is_full())
+            return false;
+        cb_.push_back(item);
+        return true;
+    }
+
+    bool try_pop_front(T& item)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if(cb_.is_empty())
+            return false;
+        item = cb_.front();
+        cb_.pop_front();
+        return true;
+    }
+
+private:
+    std::mutex mutex_;
+    container::circular_buffer<T> cb_;
+};
+
+template<typename Queue>
+void push(Queue& queue, std::uint64_t value)
+{
+    while(!queue.try_push_back(value))
+        std::this_thread::yield();
+}
+
+template<typename Queue>
+std::uint64_t pop(Queue& queue)
+{
+    std::uint64_t value;
+    while(!queue.try_pop_front(value))
+        std::this_thread::yield();
+    return value;
+}
+
+template<typename Queue>
+void throughput(const std::string& name, std::size_t capacity)
+{
+    constexpr std::size_t count = 4000000;
+    Queue queue(capacity);
+
+    const auto elapsed = bench::measure([&queue]()
+    {
+        std::thread producer([&queue]()
+        {
+            for(std::size_t i = 0; i < count; i++)
+                push(queue, i);
+        });
+
+        std::uint64_t sum = 0;
+        for(std::size_t i = 0; i < count; i++)
+            sum += pop(queue);
+        bench::do_not_optimize(sum);
+
+        producer.join();
+    });
+    bench::report(name + "/capacity=" + std::to_string(capacity), count, elapsed);
+}
+
+// Round trip through a pair of queues.
+template<typename Queue>
+void latency(const std::string& name)
+{
+    constexpr std::size_t count = 100000;
+    Queue ping(64);
+    Queue pong(64);
+
+    std::thread echo([&ping, &pong]()
+    {
+        for(std::size_t i = 0; i < count; i++)
+            push(pong, pop(ping));
+    });
+
+    std::vector<std::int64_t> samples;
+    samples.reserve(count);
+    for(std::size_t i = 0; i < count; i++)
+    {
+        const auto start = bench::clock_type::now();
+        push(ping, i);
+        bench::do_not_optimize(pop(pong));
+        const auto elapsed = bench::clock_type::now() - start;
+        samples.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    }
+    echo.join();
+
+    bench::report_latency(name + "/round_trip", std::move(samples));
+}
+
+void run()
+{
+    using spsc = container::spsc_circular_buffer<std::uint64_t>;
+    using locked = locked_circular_buffer<std::uint64_t>;
+
+    const std::size_t capacities[] = { 64, 1024, 65536 };
+    for(auto capacity : capacities)
+    {
+        throughput<locked>("mutex", capacity);
+        throughput<spsc>("spsc", capacity);
+    }
+    latency<locked>("mutex");
+    latency<spsc>("spsc");
+}
+
+const bench::registrar registrar("spsc", &run);
+
+}   // namespace
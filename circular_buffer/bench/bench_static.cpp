@@ -0,0 +1,104 @@
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <memory_resource>
+#include "bench.h"
+#include "circular_buffer.h"
+#include "static_circular_buffer.h"
+#include "stack_resource.h"
+
+namespace
+{
+
+constexpr std::size_t total = 16 * 1024 * 1024;
+
+// A short-lived ring, as a local in a hot function: construct, fill, drain, destroy.
+template<std::size_t N, typename MakeBuffer>
+void short_lived(const std::string& name, MakeBuffer make_buffer)
+{
+    const auto elapsed = bench::measure([&]()
+    {
+        std::uint32_t sum = 0;
+        for(std::size_t done = 0; done < total; done += 2 * N)
+        {
+            make_buffer([&sum](auto& cb)
+            {
+                for(std::size_t i = 0; i < 2 * N; i++)
+                    cb.push_back(static_cast<std::uint32_t>(i));
+                for(auto item : cb)
+                    sum += item;
+            });
+        }
+        bench::do_not_optimize(sum);
+    });
+    bench::report(name + "/short_lived/N=" + std::to_string(N), total, elapsed);
+}
+
+// A long-lived ring used as a queue.
+template<typename Buffer>
+void push_pop(const std::string& name, Buffer& cb)
+{
+    for(std::size_t i = 0; i < cb.capacity() / 2; i++)
+        cb.push_back(static_cast<std::uint32_t>(i));
+
+    const auto elapsed = bench::measure([&]()
+    {
+        std::uint32_t sum = 0;
+        for(std::size_t i = 0; i < total; i++)
+        {
+            cb.push_back(static_cast<std::uint32_t>(i));
+            sum += cb.front();
+            cb.pop_front();
+        }
+        bench::do_not_optimize(sum);
+    });
+    bench::report(name + "/push_pop/N=" + std::to_string(cb.capacity()), total, elapsed);
+}
+
+template<std::size_t N>
+void run_for()
+{
+    using value_type = std::uint32_t;
+
+    short_lived<N>("static_circular_buffer", [](auto f)
+    {
+        container::static_circular_buffer<value_type, N> cb;
+        f(cb);
+    });
+    short_lived<N>("circular_buffer", [](auto f)
+    {
+        container::circular_buffer<value_type> cb(N);
+        f(cb);
+    });
+    short_lived<N>("pmr::circular_buffer+stack", [](auto f)
+    {
+        container::pmr::stack_resource<N * sizeof(value_type) + 64> resource;
+        container::pmr::circular_buffer<value_type> cb(N, &resource);
+        f(cb);
+    });
+
+    {
+        container::static_circular_buffer<value_type, N> cb;
+        push_pop("static_circular_buffer", cb);
+    }
+    {
+        container::circular_buffer<value_type> cb(N);
+        push_pop("circular_buffer", cb);
+    }
+    {
+        container::pmr::stack_resource<N * sizeof(value_type) + 64> resource;
+        container::pmr::circular_buffer<value_type> cb(N, &resource);
+        push_pop("pmr::circular_buffer+stack", cb);
+    }
+}
+
+void run()
+{
+    run_for<8>();
+    run_for<64>();
+    run_for<1000>();
+}
+
+const bench::registrar registrar("static", &run);
+
+}   // namespace
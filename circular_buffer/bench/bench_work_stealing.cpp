@@ -0,0 +1,280 @@
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <string>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include "bench.h"
+#include "work_stealing_deque.h"
+
+namespace
+{
+
+class worker;
+
+// Runs once, on whichever worker pops or steals it.
+struct task
+{
+    explicit task(void (*f)(task&, worker&)) : run(f) {}
+
+    void (*run)(task&, worker&);
+    std::atomic<bool> done{false};
+};
+
+// A minimal fork/join scheduler: one deque per worker, random victims, no sleeping.
+class worker final
+{
+public:
+    worker(std::vector<std::unique_ptr<worker>>& all, std::size_t index)
+        : deque_(64), all_(all), index_(index), random_(static_cast<std::uint32_t>(index) * 2654435761u + 1)
+    {}
+
+    void spawn(task& t) { deque_.push_back(&t); }
+
+    // Runs other tasks until t is done.
+    void join(task& t)
+    {
+        while(!t.done.load(std::memory_order_acquire))
+        {
+            task* next;
+            if(deque_.try_pop_back(next) || try_steal(next))
+                execute(*next);
+            else
+                std::this_thread::yield();
+        }
+    }
+
+    bool try_steal(task*& t)
+    {
+        if(all_.size() < 2)
+            return false;
+        random_ ^= random_ << 13;
+        random_ ^= random_ >> 17;
+        random_ ^= random_ << 5;
+        auto victim = random_ % (all_.size() - 1);
+        if(victim >= index_)
+            victim++;
+        ++attempts;
+        if(!all_[victim]->deque_.try_steal(t))
+            return false;
+        ++steals;
+        return true;
+    }
+
+    void execute(task& t)
+    {
+        t.run(t, *this);
+        t.done.store(true, std::memory_order_release);
+        ++executed;
+    }
+
+    // Written by the worker's own thread only.
+    std::uint64_t executed = 0;
+    std::uint64_t steals = 0;
+    std::uint64_t attempts = 0;
+
+private:
+    container::work_stealing_deque<task*> deque_;
+    std::vector<std::unique_ptr<worker>>& all_;
+    std::size_t index_;
+    std::uint32_t random_;
+};
+
+struct statistics
+{
+    std::uint64_t executed = 0;
+    std::uint64_t steals = 0;
+    std::uint64_t attempts = 0;
+};
+
+// Runs root on worker 0 in the calling thread while the others steal.
+template<typename F>
+statistics run_on(std::size_t worker_count, F root)
+{
+    std::vector<std::unique_ptr<worker>> workers;
+    for(std::size_t i = 0; i < worker_count; i++)
+        workers.push_back(std::make_unique<worker>(workers, i));
+
+    std::atomic<bool> stop(false);
+    std::vector<std::thread> threads;
+    for(std::size_t i = 1; i < worker_count; i++)
+    {
+        threads.emplace_back([&stop, &w = *workers[i]]()
+        {
+            while(!stop.load(std::memory_order_relaxed))
+            {
+                task* t;
+                if(w.try_steal(t))
+                    w.execute(*t);
+                else
+                    std::this_thread::yield();
+            }
+        });
+    }
+    root(*workers[0]);
+    stop = true;
+    for(auto& thread : threads)
+        thread.join();
+
+    statistics result;
+    for(const auto& w : workers)
+    {
+        result.executed += w->executed;
+        result.steals += w->steals;
+        result.attempts += w->attempts;
+    }
+    return result;
+}
+
+void report_steals(const std::string& name, const statistics& stats)
+{
+    // The share of spawned tasks that ran on another worker than the one that spawned them.
+    const auto steal_rate = (stats.executed > 0)? 100.0 * static_cast<double>(stats.steals) / static_cast<double>(stats.executed) : 0.0;
+    std::cout << "  tasks=" << stats.executed
+              << " steals=" << stats.steals
+              << " attempts=" << stats.attempts
+              << " steal_rate=" << std::fixed << std::setprecision(2) << steal_rate << "%" << std::endl;
+    bench::write_csv(name, "steals", stats.steals);
+    bench::write_csv(name, "steal_rate", steal_rate);
+}
+
+// Fork/join fib: each call spawns fib(n - 1) and computes fib(n - 2) itself.
+constexpr int fib_n = 27;
+
+struct fib_task : task
+{
+    explicit fib_task(int value) : task(&fib_task::run_fib), n(value) {}
+
+    static void run_fib(task& t, worker& w);
+
+    int n;
+    std::uint64_t result = 0;
+};
+
+std::uint64_t fib(worker& w, int n)
+{
+    if(n < 2)
+        return static_cast<std::uint64_t>(n);
+    fib_task child(n - 1);
+    w.spawn(child);
+    const auto second = fib(w, n - 2);
+    w.join(child);
+    return child.result + second;
+}
+
+void fib_task::run_fib(task& t, worker& w)
+{
+    auto& self = static_cast<fib_task&>(t);
+    self.result = fib(w, self.n);
+}
+
+std::uint64_t sequential_fib(std::uint64_t n)
+{
+    return (n < 2)? n : sequential_fib(n - 1) + sequential_fib(n - 2);
+}
+
+// Parallel-for: splits the range in halves down to grain elements.
+constexpr std::size_t loop_count = std::size_t(1) << 20;
+constexpr std::size_t grain = 1024;
+
+std::uint64_t work_item(std::size_t i)
+{
+    auto x = static_cast<std::uint64_t>(i);
+    for(int k = 0; k < 32; k++)
+        x = x * 6364136223846793005u + 1442695040888963407u;
+    return x;
+}
+
+struct range_task : task
+{
+    range_task(std::uint64_t* out, std::size_t first, std::size_t last)
+        : task(&range_task::run_range), out_(out), first_(first), last_(last)
+    {}
+
+    static void run_range(task& t, worker& w);
+
+    std::uint64_t* out_;
+    std::size_t first_;
+    std::size_t last_;
+};
+
+void parallel_for(worker& w, std::uint64_t* out, std::size_t first, std::size_t last)
+{
+    if(last - first <= grain)
+    {
+        for(auto i = first; i < last; i++)
+            out[i] = work_item(i);
+        return;
+    }
+    const auto middle = first + (last - first) / 2;
+    range_task right(out, middle, last);
+    w.spawn(right);
+    parallel_for(w, out, first, middle);
+    w.join(right);
+}
+
+void range_task::run_range(task& t, worker& w)
+{
+    auto& self = static_cast<range_task&>(t);
+    parallel_for(w, self.out_, self.first_, self.last_);
+}
+
+void run()
+{
+    // Doubles up to the number of cores, and at least once so that there is someone to steal.
+    std::vector<std::size_t> worker_counts;
+    const auto cores = (std::max)(std::thread::hardware_concurrency(), 2u);
+    for(std::size_t n = 1; n <= cores; n *= 2)
+        worker_counts.push_back(n);
+
+    {
+        std::uint64_t result = 0;
+        const auto elapsed = bench::measure([&result]() { result = sequential_fib(fib_n); });
+        bench::do_not_optimize(result);
+        bench::report("fib/sequential", static_cast<std::size_t>(result), elapsed);
+    }
+    for(auto n : worker_counts)
+    {
+        std::uint64_t result = 0;
+        statistics stats;
+        const auto elapsed = bench::measure([&]()
+        {
+            stats = run_on(n, [&result](worker& w) { result = fib(w, fib_n); });
+        });
+        bench::do_not_optimize(result);
+        const auto name = "fib/workers=" + std::to_string(n);
+        bench::report(name, static_cast<std::size_t>(result), elapsed);
+        report_steals(name, stats);
+    }
+
+    std::vector<std::uint64_t> out(loop_count);
+    {
+        const auto elapsed = bench::measure([&out]()
+        {
+            for(std::size_t i = 0; i < loop_count; i++)
+                out[i] = work_item(i);
+        });
+        bench::do_not_optimize(out.front());
+        bench::report("parallel_for/sequential", loop_count, elapsed);
+    }
+    for(auto n : worker_counts)
+    {
+        statistics stats;
+        const auto elapsed = bench::measure([&]()
+        {
+            stats = run_on(n, [&out](worker& w) { parallel_for(w, out.data(), 0, loop_count); });
+        });
+        bench::do_not_optimize(out.front());
+        const auto name = "parallel_for/workers=" + std::to_string(n);
+        bench::report(name, loop_count, elapsed);
+        report_steals(name, stats);
+    }
+}
+
+const bench::registrar registrar("work_stealing", &run);
+
+}   // namespace
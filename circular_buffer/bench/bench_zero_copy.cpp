@@ -0,0 +1,194 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <new>
+#include <thread>
+#include <vector>
+#include "bench.h"
+#include "circular_buffer.h"
+#include "spsc_circular_buffer.h"
+
+namespace
+{
+
+// A decoded message, large enough that copying it is not free.
+struct record
+{
+    std::uint64_t sequence;
+    std::uint32_t type;
+    std::uint32_t length;
+    unsigned char payload[240];
+};
+
+constexpr std::size_t encoded_size = 256;
+constexpr std::size_t count = 1 << 20;
+constexpr std::size_t ring_capacity = 1024;
+constexpr std::size_t batch = 64;
+
+// Wire input: count records back to back, cycling through a small pool so it stays in cache.
+const unsigned char* encoded(std::size_t i)
+{
+    static const std::vector<unsigned char> pool = []()
+    {
+        std::vector<unsigned char> bytes(encoded_size * 64);
+        for(std::size_t k = 0; k < bytes.size(); k++)
+            bytes[k] = static_cast<unsigned char>(k * 31);
+        return bytes;
+    }();
+    return pool.data() + (i % 64) * encoded_size;
+}
+
+// Decodes straight into dest, which may be an uninitialized slot.
+void decode(const unsigned char* src, std::uint64_t sequence, record* dest)
+{
+    auto r = ::new(static_cast<void*>(dest)) record;
+    r->sequence = sequence;
+    std::memcpy(&r->type, src, sizeof(r->type));
+    r->length = sizeof(r->payload);
+    std::memcpy(r->payload, src + 16, sizeof(r->payload));
+}
+
+std::uint64_t digest(const record& r)
+{
+    return r.sequence + r.type + r.payload[0] + r.payload[r.length - 1];
+}
+
+void single_thread()
+{
+    {
+        container::circular_buffer<record> cb(ring_capacity);
+        std::uint64_t sum = 0;
+        const auto elapsed = bench::measure([&]()
+        {
+            for(std::size_t i = 0; i < count; i += batch)
+            {
+                for(std::size_t k = 0; k < batch; k++)
+                {
+                    record r;
+                    decode(encoded(i + k), i + k, &r);
+                    cb.push_back(r);
+                }
+                for(std::size_t k = 0; k < batch; k++)
+                {
+                    const record r = cb.front();
+                    cb.pop_front();
+                    sum += digest(r);
+                }
+            }
+        });
+        bench::do_not_optimize(sum);
+        bench::report("circular_buffer/push_back_pop_front", count, elapsed);
+    }
+    {
+        container::circular_buffer<record> cb(ring_capacity);
+        std::uint64_t sum = 0;
+        const auto elapsed = bench::measure([&]()
+        {
+            for(std::size_t i = 0; i < count; i += batch)
+            {
+                auto sequence = i;
+                const auto slots = cb.reserve_back(batch);
+                for(std::size_t k = 0; k < slots.first.second; k++, sequence++)
+                    decode(encoded(sequence), sequence, slots.first.first + k);
+                for(std::size_t k = 0; k < slots.second.second; k++, sequence++)
+                    decode(encoded(sequence), sequence, slots.second.first + k);
+                cb.commit_back(batch);
+
+                const auto items = cb.peek_front(batch);
+                for(std::size_t k = 0; k < items.first.second; k++)
+                    sum += digest(items.first.first[k]);
+                for(std::size_t k = 0; k < items.second.second; k++)
+                    sum += digest(items.second.first[k]);
+                cb.release_front(batch);
+            }
+        });
+        bench::do_not_optimize(sum);
+        bench::report("circular_buffer/reserve_back_peek_front", count, elapsed);
+    }
+}
+
+void two_threads()
+{
+    {
+        container::spsc_circular_buffer<record> cb(ring_capacity);
+        std::uint64_t sum = 0;
+        const auto elapsed = bench::measure([&]()
+        {
+            std::thread producer([&cb]()
+            {
+                for(std::size_t i = 0; i < count; i++)
+                {
+                    record r;
+                    decode(encoded(i), i, &r);
+                    while(!cb.try_push_back(r))
+                        std::this_thread::yield();
+                }
+            });
+            record r;
+            for(std::size_t i = 0; i < count; i++)
+            {
+                while(!cb.try_pop_front(r))
+                    std::this_thread::yield();
+                sum += digest(r);
+            }
+            producer.join();
+        });
+        bench::do_not_optimize(sum);
+        bench::report("spsc/try_push_back_try_pop_front", count, elapsed);
+    }
+    {
+        container::spsc_circular_buffer<record> cb(ring_capacity);
+        std::uint64_t sum = 0;
+        const auto elapsed = bench::measure([&]()
+        {
+            std::thread producer([&cb]()
+            {
+                for(std::size_t i = 0; i < count;)
+                {
+                    const auto slots = cb.reserve_back((std::min)(batch, count - i));
+                    const auto n = slots.first.second + slots.second.second;
+                    if(n == 0)
+                    {
+                        std::this_thread::yield();
+                        continue;
+                    }
+                    for(std::size_t k = 0; k < slots.first.second; k++, i++)
+                        decode(encoded(i), i, slots.first.first + k);
+                    for(std::size_t k = 0; k < slots.second.second; k++, i++)
+                        decode(encoded(i), i, slots.second.first + k);
+                    cb.commit_back(n);
+                }
+            });
+            for(std::size_t i = 0; i < count;)
+            {
+                const auto items = cb.peek_front(batch);
+                const auto n = items.first.second + items.second.second;
+                if(n == 0)
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+                for(std::size_t k = 0; k < items.first.second; k++)
+                    sum += digest(items.first.first[k]);
+                for(std::size_t k = 0; k < items.second.second; k++)
+                    sum += digest(items.second.first[k]);
+                cb.release_front(n);
+                i += n;
+            }
+            producer.join();
+        });
+        bench::do_not_optimize(sum);
+        bench::report("spsc/reserve_back_peek_front", count, elapsed);
+    }
+}
+
+void run()
+{
+    single_thread();
+    two_threads();
+}
+
+const bench::registrar registrar("zero_copy", &run);
+
+}   // namespace
@@ -0,0 +1,475 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <iterator>
+#include <utility>
+#include <type_traits>
+#if defined(__has_include) && __has_include(<memory_resource>)
+#include <memory_resource>
+#endif
+#include "cache_line.h"
+#include "power_of_2.h"
+#include "wait_event.h"
+
+namespace container
+{
+
+// What a thread of broadcast_ring does while it has to wait for another one.
+enum class wait_strategy
+{
+    busy_spin,  // Keeps polling; the lowest latency, but burns a core per waiting thread.
+    yield,      // Polls and yields the processor in between.
+    block       // Yields for a while, then sleeps until woken; waking costs a system call only when someone sleeps.
+};
+
+namespace detail
+{
+
+// Lets threads sleep until a condition over lock-free state becomes true.
+class broadcast_waiter final
+{
+public:
+    broadcast_waiter() noexcept
+        : sleepers_(0)
+    {}
+
+    template<typename Ready>
+    void wait(wait_strategy strategy, Ready ready)
+    {
+        // Blocking yields for a while first, so that a thread that keeps up never pays for a wake-up.
+        for(std::size_t attempts = 0; !ready(); attempts++)
+        {
+            if((strategy == wait_strategy::yield) || ((strategy == wait_strategy::block) && (attempts < yields_before_sleep)))
+                std::this_thread::yield();
+            else if(strategy == wait_strategy::block)
+                sleep(ready);
+        }
+    }
+
+    // Called after the state that Ready observes has changed. Only sleepers need it.
+    void notify(wait_strategy strategy)
+    {
+        if(strategy != wait_strategy::block)
+            return;
+        // Pairs with the fence in sleep: either the sleeper sees the new state or this sees the sleeper.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if(sleepers_.load(std::memory_order_relaxed) == 0)
+            return;
+        bool wake;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            wake = event_.notify_all();
+        }
+        if(wake)
+            event_.wake_all();
+    }
+
+private:
+    template<typename Ready>
+    void sleep(Ready& ready)
+    {
+        sleepers_.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::unique_lock<std::mutex> lock(mutex_);
+        const auto epoch = event_.prepare_wait();
+        // A notify that took the lock before us saw no registered waiter, so check again.
+        if(!ready())
+        {
+            lock.unlock();
+            event_.wait(epoch);
+            lock.lock();
+        }
+        event_.finish_wait();
+        lock.unlock();
+        sleepers_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr std::size_t yields_before_sleep = 64;
+
+    std::atomic<std::size_t> sleepers_;
+    std::mutex mutex_;
+    wait_event event_;
+};
+
+}   // namespace detail
+
+/*
+    Ring that one producer thread broadcasts to a fixed set of consumer threads, after the LMAX Disruptor.
+
+    Every element is stored once and every consumer sees every element, in order.
+    Each consumer owns a cursor, the number of elements it has finished with, and takes
+    everything published since in one batch. The producer publishes a counter of its own
+    and never overwrites a slot before the slowest consumer's cursor has passed it.
+
+    Consumers are numbered from 0 to consumer_count() - 1; each number must be used by one thread only.
+    The capacity is rounded up to a power of two.
+    An element whose construction may throw is built in a temporary and then moved into its slot,
+    so if it throws, the slot keeps its old element and nothing is published; the move must not throw.
+*/
+template<typename T, typename Allocator = std::allocator<T>>
+class broadcast_ring final
+{
+public:
+    using value_type        = typename std::allocator_traits<Allocator>::value_type;
+    using pointer           = typename std::allocator_traits<Allocator>::pointer;
+    using const_pointer     = typename std::allocator_traits<Allocator>::const_pointer;
+    using reference         = value_type&;
+    using const_reference   = const value_type&;
+    using difference_type   = typename std::allocator_traits<Allocator>::difference_type;
+    using size_type         = typename std::allocator_traits<Allocator>::size_type;
+    using allocator_type    = Allocator;
+
+private:
+    using allocator_traits = std::allocator_traits<Allocator>;
+
+    struct alignas(detail::cache_line_size) cursor
+    {
+        cursor() noexcept : value(0) {}
+
+        std::atomic<size_type> value;
+    };
+
+public:
+    broadcast_ring() = delete;
+
+    broadcast_ring(size_type capacity, size_type consumer_count,
+        wait_strategy strategy = wait_strategy::block, const Allocator& alloc = Allocator());
+    ~broadcast_ring();
+
+    broadcast_ring(const broadcast_ring&) = delete;
+    broadcast_ring& operator = (const broadcast_ring&) = delete;
+
+    broadcast_ring(broadcast_ring&&) = delete;
+    broadcast_ring& operator = (broadcast_ring&&) = delete;
+
+// Producer.
+
+    // These wait while the slowest consumer is a whole ring behind.
+    template<typename U = T>
+    std::enable_if_t<std::is_copy_constructible<U>::value>
+    push(const_reference item);
+
+    template<typename U = T>
+    std::enable_if_t<std::is_move_constructible<U>::value>
+    push(value_type&& item);
+
+    template<typename... Args>
+    void emplace(Args&&... args);
+
+    // Publishes the range in as few batches as the consumers allow.
+    template<typename ForwardIt>
+    void push(ForwardIt first, ForwardIt last);
+
+    template<typename U = T>
+    std::enable_if_t<std::is_copy_constructible<U>::value, bool>
+    try_push(const_reference item);
+
+    // Lets consume return 0 once everything published has been consumed.
+    void close();
+
+// Consumers.
+
+    // Calls f(const_reference) for every element published and not yet seen by the consumer,
+    // then advances its cursor once. Returns the number of elements.
+    template<typename F>
+    size_type poll(size_type consumer, F f);
+
+    // Like poll, but waits until there is at least one element. Returns 0 only when closed and drained.
+    template<typename F>
+    size_type consume(size_type consumer, F f);
+
+    // The number of elements the consumer can take now.
+    size_type available(size_type consumer) const noexcept;
+
+// Either side.
+
+    bool is_closed() const noexcept { return closed_.load(std::memory_order_acquire); }
+
+    size_type capacity() const noexcept { return mask_ + 1; }
+
+    size_type consumer_count() const noexcept { return cursors_.size(); }
+
+    wait_strategy strategy() const noexcept { return strategy_; }
+
+    // The number of elements ever published.
+    size_type published() const noexcept { return published_.load(std::memory_order_acquire); }
+
+    allocator_type get_allocator() const noexcept { return alloc_; }
+
+private:
+    // The cursor of the slowest consumer.
+    size_type gate() const noexcept;
+
+    // Waits until count slots from next_ on are free and returns how many are, at most count.
+    size_type claim(size_type count);
+
+    // Makes the slot of element number sequence ready to be constructed.
+    void recycle(size_type sequence) noexcept;
+
+    // Replaces the old element in the slot of element number sequence.
+    template<typename... Args>
+    void construct_slot(size_type sequence, Args&&... args);
+
+    template<typename... Args>
+    void construct_slot(std::true_type, size_type sequence, Args&&... args) noexcept;
+
+    template<typename... Args>
+    void construct_slot(std::false_type, size_type sequence, Args&&... args);
+
+    void publish(size_type last);
+
+private:
+    // Shared, read-only after construction.
+    allocator_type alloc_;
+    pointer array_;
+    size_type mask_;
+    wait_strategy strategy_;
+    std::vector<cursor> cursors_;
+    // Written by the producer.
+    alignas(detail::cache_line_size) std::atomic<size_type> published_;
+    std::atomic<bool> closed_;
+    // Owned by the producer.
+    alignas(detail::cache_line_size) size_type next_;
+    size_type cached_gate_;
+    detail::broadcast_waiter producer_waiter_;
+    detail::broadcast_waiter consumer_waiter_;
+};
+
+template<typename T, typename Allocator>
+broadcast_ring<T, Allocator>::broadcast_ring(size_type capacity, size_type consumer_count,
+    wait_strategy strategy, const Allocator& alloc)
+    : alloc_(alloc)
+    , array_(nullptr)
+    , mask_(detail::round_up_to_power_of_2(capacity) - 1)
+    , strategy_(strategy)
+    , cursors_(consumer_count)
+    , published_(0)
+    , closed_(false)
+    , next_(0)
+    , cached_gate_(0)
+{
+    assert(capacity > 0);
+    assert(consumer_count > 0);
+    array_ = allocator_traits::allocate(alloc_, mask_ + 1);
+}
+
+template<typename T, typename Allocator>
+broadcast_ring<T, Allocator>::~broadcast_ring()
+{
+    // The slots of the latest capacity() elements hold objects, consumed or not.
+    const auto last = published_.load(std::memory_order_relaxed);
+    const auto live = (last < capacity())? last : capacity();
+    for(auto sequence = last - live; sequence != last; sequence++)
+        allocator_traits::destroy(alloc_, std::addressof(array_[sequence & mask_]));
+    allocator_traits::deallocate(alloc_, array_, mask_ + 1);
+}
+
+template<typename T, typename Allocator>
+typename broadcast_ring<T, Allocator>::size_type
+broadcast_ring<T, Allocator>::gate() const noexcept
+{
+    auto result = cursors_[0].value.load(std::memory_order_acquire);
+    for(size_type i = 1; i < cursors_.size(); i++)
+    {
+        const auto value = cursors_[i].value.load(std::memory_order_acquire);
+        if(value < result)
+            result = value;
+    }
+    return result;
+}
+
+template<typename T, typename Allocator>
+typename broadcast_ring<T, Allocator>::size_type
+broadcast_ring<T, Allocator>::claim(size_type count)
+{
+    const auto wanted = next_ + (std::min)(count, capacity());
+    if(wanted - cached_gate_ > capacity())
+    {   // Only read the consumers' cursors when the cached gate says the ring is full.
+        producer_waiter_.wait(strategy_, [this]()
+        {
+            cached_gate_ = gate();
+            return next_ - cached_gate_ < capacity();
+        });
+    }
+    return (std::min)(wanted, cached_gate_ + capacity()) - next_;
+}
+
+template<typename T, typename Allocator>
+void broadcast_ring<T, Allocator>::recycle(size_type sequence) noexcept
+{
+    if(sequence >= capacity())
+        allocator_traits::destroy(alloc_, std::addressof(array_[sequence & mask_]));
+}
+
+template<typename T, typename Allocator>
+template<typename... Args>
+void broadcast_ring<T, Allocator>::construct_slot(size_type sequence, Args&&... args)
+{
+    construct_slot(std::integral_constant<bool, std::is_nothrow_constructible<value_type, Args&&...>::value>(),
+        sequence, std::forward<Args>(args)...);
+}
+
+template<typename T, typename Allocator>
+template<typename... Args>
+void broadcast_ring<T, Allocator>::construct_slot(std::true_type, size_type sequence, Args&&... args) noexcept
+{
+    recycle(sequence);
+    allocator_traits::construct(alloc_, std::addressof(array_[sequence & mask_]), std::forward<Args>(args)...);
+}
+
+// The old element is only destroyed once the new one exists.
+template<typename T, typename Allocator>
+template<typename... Args>
+void broadcast_ring<T, Allocator>::construct_slot(std::false_type, size_type sequence, Args&&... args)
+{
+    static_assert(std::is_nothrow_move_constructible<value_type>::value,
+        "An element that may throw when constructed must be nothrow move constructible.");
+    value_type temp(std::forward<Args>(args)...);
+    construct_slot(std::true_type(), sequence, std::move(temp));
+}
+
+template<typename T, typename Allocator>
+void broadcast_ring<T, Allocator>::publish(size_type last)
+{
+    next_ = last;
+    published_.store(last, std::memory_order_release);
+    consumer_waiter_.notify(strategy_);
+}
+
+template<typename T, typename Allocator>
+template<typename U>
+std::enable_if_t<std::is_copy_constructible<U>::value>
+broadcast_ring<T, Allocator>::push(const_reference item)
+{
+    emplace(item);
+}
+
+template<typename T, typename Allocator>
+template<typename U>
+std::enable_if_t<std::is_move_constructible<U>::value>
+broadcast_ring<T, Allocator>::push(value_type&& item)
+{
+    emplace(std::move(item));
+}
+
+template<typename T, typename Allocator>
+template<typename... Args>
+void broadcast_ring<T, Allocator>::emplace(Args&&... args)
+{
+    claim(1);
+    construct_slot(next_, std::forward<Args>(args)...);
+    publish(next_ + 1);
+}
+
+template<typename T, typename Allocator>
+template<typename ForwardIt>
+void broadcast_ring<T, Allocator>::push(ForwardIt first, ForwardIt last)
+{
+    auto remaining = static_cast<size_type>(std::distance(first, last));
+    while(remaining > 0)
+    {
+        const auto count = claim(remaining);
+        size_type i = 0;
+        try
+        {
+            for(; i < count; i++, ++first)
+                construct_slot(next_ + i, *first);
+        }
+        catch(...)
+        {   // The elements before the one that threw are published.
+            publish(next_ + i);
+            throw;
+        }
+        publish(next_ + count);
+        remaining -= count;
+    }
+}
+
+template<typename T, typename Allocator>
+template<typename U>
+std::enable_if_t<std::is_copy_constructible<U>::value, bool>
+broadcast_ring<T, Allocator>::try_push(const_reference item)
+{
+    if(next_ - cached_gate_ >= capacity())
+    {
+        cached_gate_ = gate();
+        if(next_ - cached_gate_ >= capacity())
+            return false;
+    }
+    emplace(item);
+    return true;
+}
+
+template<typename T, typename Allocator>
+void broadcast_ring<T, Allocator>::close()
+{
+    closed_.store(true, std::memory_order_release);
+    consumer_waiter_.notify(strategy_);
+}
+
+template<typename T, typename Allocator>
+typename broadcast_ring<T, Allocator>::size_type
+broadcast_ring<T, Allocator>::available(size_type consumer) const noexcept
+{
+    assert(consumer < consumer_count());
+    return published_.load(std::memory_order_acquire) - cursors_[consumer].value.load(std::memory_order_relaxed);
+}
+
+template<typename T, typename Allocator>
+template<typename F>
+typename broadcast_ring<T, Allocator>::size_type
+broadcast_ring<T, Allocator>::poll(size_type consumer, F f)
+{
+    assert(consumer < consumer_count());
+    auto& position = cursors_[consumer].value;
+    const auto first = position.load(std::memory_order_relaxed);
+    const auto last = published_.load(std::memory_order_acquire);
+    if(first == last)
+        return 0;
+
+    // At most two contiguous segments.
+    const auto head = first & mask_;
+    const auto count = last - first;
+    const auto first_count = (std::min)(count, capacity() - head);
+    for(size_type i = 0; i < first_count; i++)
+        f(std::as_const(array_[head + i]));
+    for(size_type i = 0; i < count - first_count; i++)
+        f(std::as_const(array_[i]));
+
+    position.store(last, std::memory_order_release);
+    producer_waiter_.notify(strategy_);
+    return count;
+}
+
+template<typename T, typename Allocator>
+template<typename F>
+typename broadcast_ring<T, Allocator>::size_type
+broadcast_ring<T, Allocator>::consume(size_type consumer, F f)
+{
+    assert(consumer < consumer_count());
+    consumer_waiter_.wait(strategy_, [this, consumer]()
+    {
+        // Closing happens after the last publish, so nothing is missed when closed is seen first.
+        return is_closed() || (available(consumer) > 0);
+    });
+    return poll(consumer, std::move(f));
+}
+
+#if defined(__has_include) && __has_include(<memory_resource>)
+namespace pmr
+{
+
+template<typename T>
+using broadcast_ring = container::broadcast_ring<T, std::pmr::polymorphic_allocator<T>>;
+
+}   // namespace pmr
+#endif
+
+}   // namespace container
@@ -0,0 +1,348 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <algorithm>
+#if defined(__has_include) && __has_include(<memory_resource>)
+#include <memory_resource>
+#endif
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace container
+{
+
+/*
+    Byte stream staging buffer for file descriptor I/O.
+
+    Both the data and the free space occupy at most two contiguous arrays.
+    read_from() fills the free space with a single readv(2) and write_to() drains the data
+    with a single writev(2), so the bytes never pass through a temporary array.
+    Code that fills or drains the arrays itself, e.g. a parser or an encoder,
+    reports what it did with commit_write() and consume().
+
+    When the ring becomes empty the head moves back to the start, so that the next read
+    can use one contiguous array.
+*/
+template<typename Allocator = std::allocator<char>>
+class basic_byte_ring final
+{
+public:
+    using value_type        = typename std::allocator_traits<Allocator>::value_type;
+    using pointer           = typename std::allocator_traits<Allocator>::pointer;
+    using const_pointer     = typename std::allocator_traits<Allocator>::const_pointer;
+    using size_type         = typename std::allocator_traits<Allocator>::size_type;
+    using allocator_type    = Allocator;
+
+    using array_range_t = std::pair<pointer, size_type>;
+    using const_array_range_t = std::pair<const_pointer, size_type>;
+
+    static_assert(sizeof(value_type) == 1, "value_type must be a byte type.");
+
+private:
+    using allocator_traits = std::allocator_traits<Allocator>;
+
+public:
+    basic_byte_ring() = delete;
+
+    explicit basic_byte_ring(size_type capacity, const Allocator& alloc = Allocator())
+        : alloc_(alloc)
+        , array_(allocator_traits::allocate(alloc_, capacity))
+        , capacity_(capacity)
+        , head_(0)
+        , contents_size_(0)
+    {
+        assert(capacity > 0);
+    }
+
+    ~basic_byte_ring()
+    {
+        deallocate();
+    }
+
+    basic_byte_ring(const basic_byte_ring&) = delete;
+    basic_byte_ring& operator = (const basic_byte_ring&) = delete;
+
+    basic_byte_ring(basic_byte_ring&& other) noexcept
+        : alloc_(std::move(other.alloc_))
+        , array_(std::exchange(other.array_, nullptr))
+        , capacity_(std::exchange(other.capacity_, 0))
+        , head_(std::exchange(other.head_, 0))
+        , contents_size_(std::exchange(other.contents_size_, 0))
+    {}
+
+    // The storage is taken over when the allocator propagates or compares equal; otherwise the bytes are copied.
+    // Either way, other is left without storage.
+    basic_byte_ring& operator = (basic_byte_ring&& other)
+        noexcept(allocator_traits::propagate_on_container_move_assignment::value
+            || allocator_traits::is_always_equal::value)
+    {
+        if(this != &other)
+        {
+            deallocate();
+            move_assign(other, typename allocator_traits::propagate_on_container_move_assignment());
+        }
+        return *this;
+    }
+
+    // The data, in order.
+    array_range_t array_one();
+    const_array_range_t array_one() const;
+
+    array_range_t array_two();
+    const_array_range_t array_two() const;
+
+    // The free space after the data, in order.
+    array_range_t free_one();
+    array_range_t free_two();
+
+    // Appends count bytes that have been written into the free space.
+    void commit_write(size_type count);
+
+    // Removes the first count bytes.
+    void consume(size_type count);
+
+    // Appends only what fits into the free space and returns the number of bytes appended.
+    size_type append(const_pointer data, size_type count);
+
+    void clear() noexcept;
+
+#if defined(__unix__) || defined(__APPLE__)
+    // These return the result of readv(2) / writev(2), or read(2) / write(2) when one array suffices;
+    // errno is left as the call set it.
+    // read_from() requires free space, write_to() requires data.
+    ssize_t read_from(int fd);
+    ssize_t write_to(int fd);
+#endif
+
+    size_type size() const noexcept { return contents_size_; }
+    size_type free_size() const noexcept { return capacity_ - contents_size_; }
+
+    bool is_empty() const noexcept { return contents_size_ == 0; }
+    bool is_full() const noexcept { return contents_size_ == capacity_; }
+
+    size_type capacity() const noexcept { return capacity_; }
+
+    allocator_type get_allocator() const noexcept { return alloc_; }
+
+private:
+    size_type tail() const noexcept;
+
+    void deallocate() noexcept;
+    void take_storage(basic_byte_ring& other) noexcept;
+    void move_assign(basic_byte_ring& other, std::true_type) noexcept;
+    void move_assign(basic_byte_ring& other, std::false_type);
+
+private:
+    allocator_type alloc_;
+    pointer array_;
+    size_type capacity_;
+    size_type head_;
+    size_type contents_size_;
+};
+
+using byte_ring = basic_byte_ring<>;
+
+template<typename Allocator>
+typename basic_byte_ring<Allocator>::size_type
+basic_byte_ring<Allocator>::tail() const noexcept
+{
+    const auto index = head_ + contents_size_;
+    return (index < capacity_)? index : index - capacity_;
+}
+
+// Leaves the ring without storage.
+template<typename Allocator>
+void basic_byte_ring<Allocator>::deallocate() noexcept
+{
+    if(array_ != nullptr)
+        allocator_traits::deallocate(alloc_, array_, capacity_);
+    array_ = nullptr;
+    capacity_ = 0;
+    head_ = 0;
+    contents_size_ = 0;
+}
+
+template<typename Allocator>
+void basic_byte_ring<Allocator>::take_storage(basic_byte_ring& other) noexcept
+{
+    array_ = std::exchange(other.array_, nullptr);
+    capacity_ = std::exchange(other.capacity_, 0);
+    head_ = std::exchange(other.head_, 0);
+    contents_size_ = std::exchange(other.contents_size_, 0);
+}
+
+template<typename Allocator>
+void basic_byte_ring<Allocator>::move_assign(basic_byte_ring& other, std::true_type) noexcept
+{
+    alloc_ = std::move(other.alloc_);
+    take_storage(other);
+}
+
+template<typename Allocator>
+void basic_byte_ring<Allocator>::move_assign(basic_byte_ring& other, std::false_type)
+{
+    if(alloc_ == other.alloc_)
+    {
+        take_storage(other);
+    }
+    else if(other.capacity_ > 0)
+    {   // When both allocators are different, the bytes are copied into storage from our own.
+        array_ = allocator_traits::allocate(alloc_, other.capacity_);
+        capacity_ = other.capacity_;
+        const auto one = other.array_one();
+        const auto two = other.array_two();
+        append(one.first, one.second);
+        append(two.first, two.second);
+        other.deallocate();
+    }
+}
+
+template<typename Allocator>
+typename basic_byte_ring<Allocator>::array_range_t
+basic_byte_ring<Allocator>::array_one()
+{
+    return std::make_pair(array_ + head_, (std::min)(contents_size_, capacity_ - head_));
+}
+
+template<typename Allocator>
+typename basic_byte_ring<Allocator>::const_array_range_t
+basic_byte_ring<Allocator>::array_one() const
+{
+    return std::make_pair(array_ + head_, (std::min)(contents_size_, capacity_ - head_));
+}
+
+template<typename Allocator>
+typename basic_byte_ring<Allocator>::array_range_t
+basic_byte_ring<Allocator>::array_two()
+{
+    return std::make_pair(array_, contents_size_ - (std::min)(contents_size_, capacity_ - head_));
+}
+
+template<typename Allocator>
+typename basic_byte_ring<Allocator>::const_array_range_t
+basic_byte_ring<Allocator>::array_two() const
+{
+    return std::make_pair(array_, contents_size_ - (std::min)(contents_size_, capacity_ - head_));
+}
+
+template<typename Allocator>
+typename basic_byte_ring<Allocator>::array_range_t
+basic_byte_ring<Allocator>::free_one()
+{
+    const auto index = tail();
+    return std::make_pair(array_ + index, (std::min)(free_size(), capacity_ - index));
+}
+
+template<typename Allocator>
+typename basic_byte_ring<Allocator>::array_range_t
+basic_byte_ring<Allocator>::free_two()
+{
+    return std::make_pair(array_, free_size() - (std::min)(free_size(), capacity_ - tail()));
+}
+
+template<typename Allocator>
+void basic_byte_ring<Allocator>::commit_write(size_type count)
+{
+    assert(count <= free_size());
+    contents_size_ += count;
+}
+
+template<typename Allocator>
+void basic_byte_ring<Allocator>::consume(size_type count)
+{
+    assert(count <= size());
+    contents_size_ -= count;
+    if(contents_size_ == 0)
+    {
+        head_ = 0;
+        return;
+    }
+    head_ += count;
+    if(head_ >= capacity_)
+        head_ -= capacity_;
+}
+
+template<typename Allocator>
+typename basic_byte_ring<Allocator>::size_type
+basic_byte_ring<Allocator>::append(const_pointer data, size_type count)
+{
+    count = (std::min)(count, free_size());
+    const auto one = free_one();
+    const auto first_count = (std::min)(count, one.second);
+    if(first_count > 0)
+        std::memcpy(one.first, data, first_count);
+    if(count > first_count)
+        std::memcpy(array_, data + first_count, count - first_count);
+    contents_size_ += count;
+    return count;
+}
+
+template<typename Allocator>
+void basic_byte_ring<Allocator>::clear() noexcept
+{
+    head_ = 0;
+    contents_size_ = 0;
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+
+template<typename Allocator>
+ssize_t basic_byte_ring<Allocator>::read_from(int fd)
+{
+    assert(!is_full());
+    const auto one = free_one();
+    const auto two = free_two();
+    ssize_t result;
+    if(two.second == 0)
+    {   // A single array needs no iovec.
+        result = ::read(fd, one.first, one.second);
+    }
+    else
+    {
+        iovec iov[2] = { { one.first, one.second }, { two.first, two.second } };
+        result = ::readv(fd, iov, 2);
+    }
+    if(result > 0)
+        commit_write(static_cast<size_type>(result));
+    return result;
+}
+
+template<typename Allocator>
+ssize_t basic_byte_ring<Allocator>::write_to(int fd)
+{
+    assert(!is_empty());
+    const auto one = array_one();
+    const auto two = array_two();
+    ssize_t result;
+    if(two.second == 0)
+    {
+        result = ::write(fd, one.first, one.second);
+    }
+    else
+    {
+        iovec iov[2] = { { one.first, one.second }, { two.first, two.second } };
+        result = ::writev(fd, iov, 2);
+    }
+    if(result > 0)
+        consume(static_cast<size_type>(result));
+    return result;
+}
+
+#endif
+
+#if defined(__has_include) && __has_include(<memory_resource>)
+namespace pmr
+{
+
+using byte_ring = container::basic_byte_ring<std::pmr::polymorphic_allocator<char>>;
+
+}   // namespace pmr
+#endif
+
+}   // namespace container
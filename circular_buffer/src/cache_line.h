@@ -0,0 +1,17 @@
+#pragma once
+#include <cstddef>
+
+namespace container
+{
+
+namespace detail
+{
+
+// Granularity used to keep members written by different threads apart.
+// std::hardware_destructive_interference_size is not used because its value
+// is allowed to change between compiler versions and flags.
+constexpr std::size_t cache_line_size = 64;
+
+}   // namespace detail
+
+}   // namespace container
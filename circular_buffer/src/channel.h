@@ -0,0 +1,315 @@
+#pragma once
+#include <cassert>
+#include <chrono>
+#include <mutex>
+#include <memory>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+#if defined(__has_include) && __has_include(<memory_resource>)
+#include <memory_resource>
+#endif
+#include "circular_buffer.h"
+#include "wait_event.h"
+
+namespace container
+{
+
+// What push does when the channel is full.
+enum class full_policy
+{
+    overwrite,  // Evicts the oldest element, as circular_buffer does.
+    reject,     // Fails immediately.
+    block       // Waits for a free slot, up to the deadline if one is given.
+};
+
+/*
+    Bounded blocking queue for any number of producer and consumer threads.
+
+    The elements are kept in a circular_buffer guarded by a mutex, which is only held to move elements.
+    Blocked threads sleep on a detail::wait_event instead of a condition_variable,
+    and the opposite side only makes a wake-up call when somebody is actually asleep.
+
+    After close(), pushes fail and pops drain the remaining elements before they fail.
+    No thread may be blocked in the channel when it is destroyed.
+*/
+template<typename T, typename Allocator = std::allocator<T>>
+class channel final
+{
+public:
+    using value_type        = T;
+    using reference         = value_type&;
+    using const_reference   = const value_type&;
+    using size_type         = typename circular_buffer<T, Allocator>::size_type;
+    using allocator_type    = Allocator;
+    using clock_type        = std::chrono::steady_clock;
+
+public:
+    channel() = delete;
+
+    explicit channel(size_type capacity, full_policy policy = full_policy::block, const Allocator& alloc = Allocator())
+        : buffer_(capacity, alloc)
+        , policy_(policy)
+        , closed_(false)
+    {}
+
+    ~channel() = default;
+
+    channel(const channel&) = delete;
+    channel& operator = (const channel&) = delete;
+
+    channel(channel&&) = delete;
+    channel& operator = (channel&&) = delete;
+
+    // These return false when the item is rejected, the deadline passes first or the channel is closed.
+    // The item is left untouched in that case.
+    bool push(const_reference item) { return push_impl(item, no_deadline()); }
+    bool push(value_type&& item) { return push_impl(std::move(item), no_deadline()); }
+
+    template<typename Rep, typename Period>
+    bool push_for(const_reference item, const std::chrono::duration<Rep, Period>& timeout);
+
+    template<typename Rep, typename Period>
+    bool push_for(value_type&& item, const std::chrono::duration<Rep, Period>& timeout);
+
+    template<typename Clock, typename Duration>
+    bool push_until(const_reference item, const std::chrono::time_point<Clock, Duration>& deadline);
+
+    template<typename Clock, typename Duration>
+    bool push_until(value_type&& item, const std::chrono::time_point<Clock, Duration>& deadline);
+
+    // These return false when nothing arrives in time, or when the channel is closed and empty.
+    bool try_pop(value_type& item) { return pop_impl(item, clock_type::time_point::min()); }
+    bool pop(value_type& item) { return pop_impl(item, no_deadline()); }
+
+    template<typename Rep, typename Period>
+    bool pop_for(value_type& item, const std::chrono::duration<Rep, Period>& timeout);
+
+    template<typename Clock, typename Duration>
+    bool pop_until(value_type& item, const std::chrono::time_point<Clock, Duration>& deadline);
+
+    // Waits for at least one element, then moves out every element in the channel under a single lock.
+    // Returns the number of elements moved, which is 0 only when the channel is closed and empty.
+    template<typename OutputIt>
+    size_type pop_all(OutputIt dest);
+
+    // Wakes every blocked thread.
+    void close();
+
+    bool is_closed() const;
+
+    size_type size() const;
+    bool is_empty() const { return size() == 0; }
+
+    size_type capacity() const noexcept { return buffer_.capacity(); }
+    full_policy policy() const noexcept { return policy_; }
+
+private:
+    static constexpr clock_type::time_point no_deadline() noexcept { return clock_type::time_point::max(); }
+
+    template<typename Clock, typename Duration>
+    static clock_type::time_point to_deadline(const std::chrono::time_point<Clock, Duration>& deadline);
+
+    template<typename U>
+    bool push_impl(U&& item, clock_type::time_point deadline);
+
+    bool pop_impl(value_type& item, clock_type::time_point deadline);
+
+    // Releases the lock while asleep. Returns false when the deadline has passed.
+    bool wait(detail::wait_event& event, std::unique_lock<std::mutex>& lock, clock_type::time_point deadline);
+
+private:
+    mutable std::mutex mutex_;
+    circular_buffer<T, Allocator> buffer_;
+    const full_policy policy_;
+    bool closed_;
+    detail::wait_event not_empty_;
+    detail::wait_event not_full_;
+};
+
+template<typename T, typename Allocator>
+template<typename Rep, typename Period>
+bool channel<T, Allocator>::push_for(const_reference item, const std::chrono::duration<Rep, Period>& timeout)
+{
+    return push_impl(item, clock_type::now() + std::chrono::duration_cast<clock_type::duration>(timeout));
+}
+
+template<typename T, typename Allocator>
+template<typename Rep, typename Period>
+bool channel<T, Allocator>::push_for(value_type&& item, const std::chrono::duration<Rep, Period>& timeout)
+{
+    return push_impl(std::move(item), clock_type::now() + std::chrono::duration_cast<clock_type::duration>(timeout));
+}
+
+template<typename T, typename Allocator>
+template<typename Clock, typename Duration>
+bool channel<T, Allocator>::push_until(const_reference item, const std::chrono::time_point<Clock, Duration>& deadline)
+{
+    return push_impl(item, to_deadline(deadline));
+}
+
+template<typename T, typename Allocator>
+template<typename Clock, typename Duration>
+bool channel<T, Allocator>::push_until(value_type&& item, const std::chrono::time_point<Clock, Duration>& deadline)
+{
+    return push_impl(std::move(item), to_deadline(deadline));
+}
+
+template<typename T, typename Allocator>
+template<typename Rep, typename Period>
+bool channel<T, Allocator>::pop_for(value_type& item, const std::chrono::duration<Rep, Period>& timeout)
+{
+    return pop_impl(item, clock_type::now() + std::chrono::duration_cast<clock_type::duration>(timeout));
+}
+
+template<typename T, typename Allocator>
+template<typename Clock, typename Duration>
+bool channel<T, Allocator>::pop_until(value_type& item, const std::chrono::time_point<Clock, Duration>& deadline)
+{
+    return pop_impl(item, to_deadline(deadline));
+}
+
+// Deadlines of other clocks are converted once, as a remaining time.
+template<typename T, typename Allocator>
+template<typename Clock, typename Duration>
+typename channel<T, Allocator>::clock_type::time_point
+channel<T, Allocator>::to_deadline(const std::chrono::time_point<Clock, Duration>& deadline)
+{
+    return clock_type::now() + std::chrono::duration_cast<clock_type::duration>(deadline - Clock::now());
+}
+
+template<typename T, typename Allocator>
+template<typename U>
+bool channel<T, Allocator>::push_impl(U&& item, clock_type::time_point deadline)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    for(;;)
+    {
+        if(closed_)
+            return false;
+        if(!buffer_.is_full() || (policy_ == full_policy::overwrite))
+            break;
+        if((policy_ == full_policy::reject) || !wait(not_full_, lock, deadline))
+            return false;
+    }
+
+    buffer_.push_back(std::forward<U>(item));
+    const bool wake = not_empty_.notify_one();
+    lock.unlock();
+
+    if(wake)
+        not_empty_.wake_one();
+    return true;
+}
+
+template<typename T, typename Allocator>
+bool channel<T, Allocator>::pop_impl(value_type& item, clock_type::time_point deadline)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while(buffer_.is_empty())
+    {
+        if(closed_ || !wait(not_empty_, lock, deadline))
+            return false;
+    }
+
+    item = std::move(buffer_.front());
+    buffer_.pop_front();
+    const bool wake = not_full_.notify_one();
+    lock.unlock();
+
+    if(wake)
+        not_full_.wake_one();
+    return true;
+}
+
+template<typename T, typename Allocator>
+template<typename OutputIt>
+typename channel<T, Allocator>::size_type
+channel<T, Allocator>::pop_all(OutputIt dest)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while(buffer_.is_empty())
+    {
+        if(closed_ || !wait(not_empty_, lock, no_deadline()))
+            return 0;
+    }
+
+    const auto one = buffer_.array_one();
+    const auto two = buffer_.array_two();
+    dest = std::move(one.first, one.first + one.second, dest);
+    std::move(two.first, two.first + two.second, dest);
+    const auto count = buffer_.size();
+    buffer_.clear();
+    const bool wake = not_full_.notify_all();
+    lock.unlock();
+
+    // Every slot is free now.
+    if(wake)
+        not_full_.wake_all();
+    return count;
+}
+
+template<typename T, typename Allocator>
+void channel<T, Allocator>::close()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    closed_ = true;
+    const bool wake_consumers = not_empty_.notify_all();
+    const bool wake_producers = not_full_.notify_all();
+    lock.unlock();
+
+    if(wake_consumers)
+        not_empty_.wake_all();
+    if(wake_producers)
+        not_full_.wake_all();
+}
+
+template<typename T, typename Allocator>
+bool channel<T, Allocator>::is_closed() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return closed_;
+}
+
+template<typename T, typename Allocator>
+typename channel<T, Allocator>::size_type
+channel<T, Allocator>::size() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return buffer_.size();
+}
+
+template<typename T, typename Allocator>
+bool channel<T, Allocator>::wait(detail::wait_event& event, std::unique_lock<std::mutex>& lock, clock_type::time_point deadline)
+{
+    if(deadline == no_deadline())
+    {
+        const auto epoch = event.prepare_wait();
+        lock.unlock();
+        event.wait(epoch);
+    }
+    else
+    {
+        const auto now = clock_type::now();
+        if(deadline <= now)
+            return false;
+        const auto epoch = event.prepare_wait();
+        lock.unlock();
+        event.wait_for(epoch, deadline - now);
+    }
+    lock.lock();
+    event.finish_wait();
+    return true;
+}
+
+#if defined(__has_include) && __has_include(<memory_resource>)
+namespace pmr
+{
+
+template<typename T>
+using channel = container::channel<T, std::pmr::polymorphic_allocator<T>>;
+
+}   // namespace pmr
+#endif
+
+}   // namespace container
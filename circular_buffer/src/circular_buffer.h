@@ -1,12 +1,14 @@
 #pragma once
 #include <cassert>
-#include <vector>
 #include <utility>
 #include <algorithm>
 #include <memory>
 #include <iterator>
 #include <utility>
+#include <vector>
 #include <stdexcept>
+#include <cstring>
+#include <type_traits>
 #if defined(__has_include) && __has_include(<memory_resource>)
 #include <memory_resource>
 #endif
@@ -17,6 +19,11 @@ namespace container
 namespace detail
 {
 
+/*
+    Holds the logical index of the element, counted from the front of the buffer.
+    Stepping and comparing are integer operations; only dereferencing maps the index
+    to a slot, through the buffer's operator[].
+*/
 template<typename CB, typename Traits>
 class circular_buffer_iterator
 {
@@ -28,7 +35,7 @@ public:
     using difference_type   = typename Traits::difference_type;
 
     circular_buffer_iterator()
-        : cb_(nullptr), ptr_(nullptr)
+        : cb_(nullptr), index_(0)
     {}
 
     circular_buffer_iterator(const circular_buffer_iterator&) = default;
@@ -37,32 +44,27 @@ public:
     circular_buffer_iterator(circular_buffer_iterator&&) = default;
     circular_buffer_iterator& operator = (circular_buffer_iterator&&) = default;
 
-    circular_buffer_iterator(const CB* cb, const pointer ptr)
-        : cb_(cb), ptr_(ptr)
+    circular_buffer_iterator(const CB* cb, difference_type index)
+        : cb_(cb), index_(index)
     {}
 
     // Indirection operator.
     reference operator * () const
     {
-        return *ptr_;
+        return *operator -> ();
     }
 
     // Structure dereference operator.
     pointer operator -> () const
     {
-        return ptr_;
+        return const_cast<pointer>(std::addressof((*cb_)[static_cast<typename CB::size_type>(index_)]));
     }
 
     // Increment operator (prefix).
     circular_buffer_iterator& operator ++ ()
     {
-        assert(ptr_ != cb_->buffer_end());
-
-        ptr_ = const_cast<pointer>(cb_->increment(ptr_));
-
-        if(ptr_ == cb_->buffer_begin())
-            ptr_ = const_cast<pointer>(cb_->buffer_end());
-
+        assert(index_ < static_cast<difference_type>(cb_->size()));
+        ++index_;
         return *this;
     }
 
@@ -77,13 +79,8 @@ public:
     // Decrement operator (prefix).
     circular_buffer_iterator& operator -- ()
     {
-        assert(ptr_ != cb_->buffer_begin());
-
-        if(ptr_ == cb_->array_end())
-            ptr_ = const_cast<pointer>(cb_->buffer_begin());
-
-        ptr_ = const_cast<pointer>(cb_->decrement(ptr_));
-
+        assert(index_ > 0);
+        --index_;
         return *this;
     }
 
@@ -98,7 +95,7 @@ public:
     // Subtraction operator.
     difference_type operator - (const circular_buffer_iterator& rhs) const
     {
-        return cb_->linearize_pointer(ptr_) - cb_->linearize_pointer(rhs.ptr_);
+        return index_ - rhs.index_;
     }
 
     // Subscript operator.
@@ -110,16 +107,9 @@ public:
     // Addition assignment operator.
     circular_buffer_iterator& operator += (difference_type n)
     {
-        if(n > 0)
-        {
-            auto linearized_ptr = cb_->linearize_pointer(ptr_);
-            assert(n <= (cb_->linearize_pointer(cb_->buffer_end()) - linearized_ptr));
-            ptr_ = const_cast<pointer>(cb_->unlinearize_pointer(linearized_ptr + n));
-        }
-        else if(n < 0)
-        {
-            *this -= -n;
-        }
+        assert(index_ + n >= 0);
+        assert(index_ + n <= static_cast<difference_type>(cb_->size()));
+        index_ += n;
         return *this;
     }
 
@@ -132,17 +122,7 @@ public:
     // Subtraction assignment operator.
     circular_buffer_iterator& operator -= (difference_type n)
     {
-        if(n > 0)
-        {
-            auto linearized_ptr = cb_->linearize_pointer(ptr_);
-            assert(n <= (linearized_ptr - cb_->array_begin()));
-            ptr_ = const_cast<pointer>(cb_->unlinearize_pointer(linearized_ptr - n));
-        }
-        else if(n < 0)
-        {
-            *this += -n;
-        }
-        return *this;
+        return *this += -n;
     }
 
     // Subtraction operator.
@@ -156,19 +136,19 @@ public:
     // Equal to operator.
     bool operator == (const circular_buffer_iterator& rhs) const
     {
-        return ptr_ == rhs.ptr_;
+        return index_ == rhs.index_;
     }
 
     // Not equal to operator.
     bool operator != (const circular_buffer_iterator& rhs) const
     {
-        return ptr_ != rhs.ptr_;
+        return index_ != rhs.index_;
     }
 
     // Less than operator.
     bool operator < (const circular_buffer_iterator& rhs) const
     {
-        return cb_->linearize_pointer(ptr_) < cb_->linearize_pointer(rhs.ptr_);
+        return index_ < rhs.index_;
     }
 
     // Greater than operator.
@@ -191,7 +171,7 @@ public:
 
 private:
     const CB* cb_;
-    pointer ptr_;
+    difference_type index_;
 };
 
 // Addition operator.
@@ -202,13 +182,77 @@ operator + (typename Traits::difference_type n, const circular_buffer_iterator<C
     return rhs + n;
 }
 
+template<typename InputIt, typename OutputIt>
+inline std::pair<InputIt, OutputIt>
+copy_n_impl(InputIt first, std::size_t n, OutputIt dest, std::true_type)
+{
+    if(n > 0)
+        std::memcpy(dest, first, n * sizeof(*first));
+    return std::make_pair(first + n, dest + n);
+}
+
+template<typename InputIt, typename OutputIt>
+inline std::pair<InputIt, OutputIt>
+copy_n_impl(InputIt first, std::size_t n, OutputIt dest, std::false_type)
+{
+    for(; n > 0; --n, ++first, ++dest)
+        *dest = *first;
+    return std::make_pair(first, dest);
+}
+
+template<typename InputIt, typename OutputIt>
+using is_memcpy_copyable = std::integral_constant<bool,
+    std::is_pointer<InputIt>::value
+    && std::is_pointer<OutputIt>::value
+    && std::is_same<std::remove_cv_t<std::remove_pointer_t<InputIt>>, std::remove_pointer_t<OutputIt>>::value
+    && std::is_trivially_copyable<std::remove_pointer_t<OutputIt>>::value>;
+
+// Copies n elements, with memcpy when both sides are pointers to the same trivially copyable type.
+// The ranges must not overlap.
+template<typename InputIt, typename OutputIt>
+inline std::pair<InputIt, OutputIt>
+copy_n(InputIt first, std::size_t n, OutputIt dest)
+{
+    return copy_n_impl(first, n, dest, is_memcpy_copyable<InputIt, OutputIt>());
+}
+
+// Room for N elements inside the object; nothing at all when N is 0.
+template<typename T, std::size_t N>
+class inline_storage
+{
+protected:
+    T* inline_data() noexcept { return reinterpret_cast<T*>(storage_); }
+    const T* inline_data() const noexcept { return reinterpret_cast<const T*>(storage_); }
+
+private:
+    alignas(T) unsigned char storage_[sizeof(T) * N];
+};
+
+template<typename T>
+class inline_storage<T, 0>
+{
+protected:
+    T* inline_data() noexcept { return nullptr; }
+    const T* inline_data() const noexcept { return nullptr; }
+};
+
 }   // namespace detail
 
-template<typename T, typename Allocator = std::allocator<T>>
+/*
+    Capacities up to InlineN are kept in storage inside the object, and only larger ones
+    come from the allocator, so that a small buffer costs no allocation and sits next to
+    its owner. Storage changes, through set_capacity or growth, move between the two as needed.
+
+    Inline elements cannot change hands, so moving a buffer that holds them
+    moves the elements one by one instead of taking over the storage.
+    InlineN > 0 requires an allocator whose pointer is a raw pointer, like std::allocator and the pmr one.
+*/
+template<typename T, typename Allocator = std::allocator<T>, std::size_t InlineN = 0>
 class circular_buffer final
+    : private detail::inline_storage<typename std::allocator_traits<Allocator>::value_type, InlineN>
 {
 public:
-    using self_type         = circular_buffer<T, Allocator>;
+    using self_type         = circular_buffer<T, Allocator, InlineN>;
     using value_type        = typename std::allocator_traits<Allocator>::value_type;
     using pointer           = typename std::allocator_traits<Allocator>::pointer;
     using const_pointer     = typename std::allocator_traits<Allocator>::const_pointer;
@@ -227,61 +271,98 @@ public:
     using array_range_t = std::pair<pointer, size_type>;
     using const_array_range_t = std::pair<const_pointer, size_type>;
 
-    friend iterator;
-    friend const_iterator;
+    // A run of slots that may wrap around: the part up to the end of the storage, then the rest.
+    using array_ranges_t = std::pair<array_range_t, array_range_t>;
+    using const_array_ranges_t = std::pair<const_array_range_t, const_array_range_t>;
+
+private:
+    using allocator_traits = std::allocator_traits<Allocator>;
+
+    static_assert((InlineN == 0) || std::is_same<pointer, value_type*>::value,
+        "Inline storage requires an allocator with raw pointers.");
+
+    // Taking over another buffer's storage only moves elements when they are inline.
+    static constexpr bool nothrow_take_storage = (InlineN == 0) || std::is_nothrow_move_constructible<value_type>::value;
 
 public:
     circular_buffer() = delete;
-    ~circular_buffer() = default;
+
+    ~circular_buffer()
+    {
+        destroy_and_deallocate();
+    }
 
     explicit circular_buffer(size_type capacity, const Allocator& alloc = Allocator())
-        : array_(alloc)
+        : alloc_(alloc)
+        , array_(allocate(capacity))
+        , capacity_(capacity)
+        , growth_limit_(0)
     {
         assert(capacity > 0);
-        array_.resize(capacity);
         set_initial_values();
     }
 
     circular_buffer(const circular_buffer& other)
-        : circular_buffer(other, other.get_allocator())
+        : circular_buffer(other, allocator_traits::select_on_container_copy_construction(other.alloc_))
     {}
 
     circular_buffer(const circular_buffer& other, const Allocator& alloc)
-        : array_(other.array_, alloc)
-        , head_(other.head_)
-        , tail_(other.tail_)
-        , contents_size_(other.contents_size_)
-    {}
+        : alloc_(alloc)
+        , array_(allocate(other.capacity_))
+        , capacity_(other.capacity_)
+        , growth_limit_(other.growth_limit_)
+    {
+        copy_elements(other);
+    }
 
-    circular_buffer(circular_buffer&& other) noexcept
-        : circular_buffer(std::move(other), other.get_allocator())
-    {}
+    circular_buffer(circular_buffer&& other) noexcept(nothrow_take_storage)
+        : alloc_(std::move(other.alloc_))
+        , array_(nullptr)
+        , capacity_(0)
+        , growth_limit_(0)
+    {
+        take_storage(other);
+    }
 
     circular_buffer(circular_buffer&& other, const Allocator& alloc)
-        : array_(std::move(other.array_), alloc)
-        , head_(other.head_)
-        , tail_(other.tail_)
-        , contents_size_(other.contents_size_)
-    {
-        if(other.array_.size() > 0)
-        {   // When both allocator types are different.
-            other.array_.clear();
+        : alloc_(alloc)
+        , array_(nullptr)
+        , capacity_(0)
+        , growth_limit_(0)
+    {
+        if(alloc_ == other.alloc_)
+        {
+            take_storage(other);
+        }
+        else
+        {   // When both allocators are different.
+            array_ = allocate(other.capacity_);
+            capacity_ = other.capacity_;
+            move_elements(other);
+            other.destroy_and_deallocate();
         }
-        other.set_initial_values();
     }
 
-    circular_buffer& operator = (const circular_buffer&) = default;
-
-    circular_buffer& operator = (circular_buffer&& other) noexcept
+    circular_buffer& operator = (const circular_buffer& other)
     {
         if(this != &other)
         {
-            array_ = std::move(other.array_);
-            head_ = other.head_;
-            tail_ = other.tail_;
-            contents_size_ = other.contents_size_;
+            constexpr bool propagate = allocator_traits::propagate_on_container_copy_assignment::value;
+            circular_buffer temp(other, propagate? other.alloc_ : alloc_);
+            destroy_and_deallocate();
+            move_assign(temp, std::integral_constant<bool, propagate>());
+        }
+        return *this;
+    }
 
-            other.set_initial_values();
+    circular_buffer& operator = (circular_buffer&& other)
+        noexcept((allocator_traits::propagate_on_container_move_assignment::value
+            || allocator_traits::is_always_equal::value) && nothrow_take_storage)
+    {
+        if(this != &other)
+        {
+            destroy_and_deallocate();
+            move_assign(other, typename allocator_traits::propagate_on_container_move_assignment());
         }
         return *this;
     }
@@ -300,6 +381,13 @@ public:
 
     void clear();
 
+    // When full, these overwrite the element at the opposite end.
+    template<typename... Args>
+    reference emplace_front(Args&&... args);
+
+    template<typename... Args>
+    reference emplace_back(Args&&... args);
+
     template<typename U = T>
     std::enable_if_t<std::is_copy_constructible<U>::value, void>
     push_front(const_reference item);
@@ -316,22 +404,73 @@ public:
     std::enable_if_t<std::is_move_constructible<U>::value, void>
     push_back(value_type&& item);
 
+    // Overwrites the oldest elements when the range does not fit.
+    template<typename InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+    void push_back(InputIt first, InputIt last);
+
+    // Appends only what fits into the free space and returns the number of elements appended.
+    size_type insert_back(const_pointer items, size_type count);
+    size_type insert_back(const_array_range_t items);
+
     void pop_front();
+    void pop_front(size_type count);
     void pop_back();
 
+    // Up to count uninitialized slots after the tail, for constructing elements in place.
+    // Nothing is overwritten, so fewer slots are returned when the free space is smaller.
+    array_ranges_t reserve_back(size_type count);
+
+    // Appends the elements constructed in the first count slots of the last reserve_back().
+    void commit_back(size_type count);
+
+    // The first count elements, or all of them when there are fewer, to read in place.
+    array_ranges_t peek_front(size_type count);
+    const_array_ranges_t peek_front(size_type count) const;
+
+    // Same as pop_front(count); the counterpart of peek_front().
+    void release_front(size_type count) { pop_front(count); }
+
+    // Copies the first count elements without removing them.
+    template<typename OutputIt>
+    OutputIt copy_out(OutputIt dest, size_type count) const;
+
+    // Copies all elements in order, leaving the buffer as it is.
+    template<typename OutputIt>
+    OutputIt copy_linearized(OutputIt dest) const;
+
+    std::vector<value_type> to_vector() const;
+
     size_type head() const noexcept { return head_; }
     size_type tail() const noexcept { return tail_; }
 
     size_type size() const noexcept { return contents_size_; }
-    size_type max_size() const noexcept { return array_.max_size; }
+    size_type max_size() const noexcept { return allocator_traits::max_size(alloc_); }
 
     bool is_empty() const noexcept { return contents_size_ == 0; }
     bool is_full() const noexcept { return contents_size_ == capacity(); }
 
-    size_type capacity() const noexcept { return array_.size(); }
+    size_type capacity() const noexcept { return capacity_; }
+
+    // Whether the elements live inside the object rather than in allocated storage.
+    bool is_inline() const noexcept { return (InlineN > 0) && (array_ != nullptr) && (array_ == this->inline_data()); }
+
+    // Reallocates to new_capacity (> 0) and linearizes; nothing happens if that changes neither.
+    // When the elements do not fit, only the newest new_capacity elements are kept.
+    void set_capacity(size_type new_capacity);
 
-    pointer data() noexcept { return array_.data(); }
-    const_pointer data() const noexcept { return array_.data(); }
+    // Never shrinks.
+    void reserve(size_type new_capacity);
+
+    // Releases the unused slots, e.g. after a burst has been drained.
+    void shrink_to_fit();
+
+    // Pushing into a full buffer doubles its capacity, up to limit, instead of overwriting.
+    // The limit starts at 0, which disables the growth.
+    void set_growth_limit(size_type limit) noexcept { growth_limit_ = limit; }
+    size_type growth_limit() const noexcept { return growth_limit_; }
+
+    pointer data() noexcept { return array_; }
+    const_pointer data() const noexcept { return array_; }
 
     array_range_t array_one();
     const_array_range_t array_one() const;
@@ -342,13 +481,13 @@ public:
     bool is_linearized() const;
     void linearize();
 
-    allocator_type get_allocator() const noexcept { return array_.get_allocator(); }
+    allocator_type get_allocator() const noexcept { return alloc_; }
 
-    iterator begin(){ return iterator(this, buffer_begin()); }
-    const_iterator begin() const { return const_iterator(this, const_cast<pointer>(buffer_begin())); }
+    iterator begin(){ return iterator(this, 0); }
+    const_iterator begin() const { return const_iterator(this, 0); }
 
-    iterator end(){ return iterator(this, buffer_end()); }
-    const_iterator end() const { return const_iterator(this, const_cast<pointer>(buffer_end())); }
+    iterator end(){ return iterator(this, static_cast<difference_type>(size())); }
+    const_iterator end() const { return const_iterator(this, static_cast<difference_type>(size())); }
 
     const_iterator cbegin() const { return begin(); }
     const_iterator cend() const { return end(); }
@@ -365,54 +504,230 @@ public:
 private:
     void set_initial_values() noexcept;
 
+    pointer allocate(size_type capacity);
+    void destroy_and_deallocate() noexcept;
+    void take_storage(circular_buffer& other) noexcept(nothrow_take_storage);
+    void move_assign(circular_buffer& other, std::true_type) noexcept(nothrow_take_storage);
+    void move_assign(circular_buffer& other, std::false_type);
+    void copy_elements(const circular_buffer& other);
+    void move_elements(circular_buffer& other);
+    void destroy_front(size_type count) noexcept;
+
+    bool can_grow() const noexcept { return capacity_ < growth_limit_; }
+    void grow(size_type count);
+
+    // Moves the newest new_capacity elements into [0, count) of new storage.
+    void reallocate(size_type new_capacity);
+
+    size_type next_index(size_type index) const noexcept { return (index < (capacity() - 1))? index + 1 : 0; }
+    size_type prev_index(size_type index) const noexcept { return (index > 0)? index - 1 : capacity() - 1; }
+
+    // The slot must be free.
+    template<typename... Args>
+    void construct_front(Args&&... args);
+
+    template<typename... Args>
+    void construct_back(Args&&... args);
+
+    template<typename U>
+    void overwrite_front(U&& item, std::true_type);
+
+    template<typename U>
+    void overwrite_front(U&& item, std::false_type);
+
+    template<typename U>
+    void overwrite_back(U&& item, std::true_type);
+
+    template<typename U>
+    void overwrite_back(U&& item, std::false_type);
+
     template<typename U>
     void push_front_fwd(U&& item);
 
     template<typename U>
     void push_back_fwd(U&& item);
 
-    pointer array_begin();
-    const_pointer array_begin() const;
+    template<typename InputIt>
+    void push_back_range(InputIt first, InputIt last, std::input_iterator_tag);
 
-    pointer array_end();
-    const_pointer array_end() const;
+    template<typename ForwardIt>
+    void push_back_range(ForwardIt first, ForwardIt last, std::forward_iterator_tag);
 
-    pointer buffer_begin();
-    const_pointer buffer_begin() const;
+    template<typename InputIt>
+    InputIt construct_back_n(InputIt first, size_type count, std::true_type);
 
-    pointer buffer_end();
-    const_pointer buffer_end() const;
+    template<typename InputIt>
+    InputIt construct_back_n(InputIt first, size_type count, std::false_type);
 
-    pointer increment(const_pointer ptr);
-    const_pointer increment(const_pointer ptr) const;
+    void move_back_n(pointer first, size_type count, std::true_type);
+    void move_back_n(pointer first, size_type count, std::false_type);
 
-    pointer decrement(const_pointer ptr);
-    const_pointer decrement(const_pointer ptr) const;
+    // Moves count elements to a lower address; the destination may overlap the source.
+    void relocate(pointer dest, pointer src, size_type count, std::true_type);
+    void relocate(pointer dest, pointer src, size_type count, std::false_type);
 
-    pointer linearize_pointer(const_pointer ptr);
-    const_pointer linearize_pointer(const_pointer ptr) const;
+    size_type advance_index(size_type index, size_type count) const noexcept;
 
-    pointer unlinearize_pointer(const_pointer ptr);
-    const_pointer unlinearize_pointer(const_pointer ptr) const;
+    pointer array_begin();
+    const_pointer array_begin() const;
+
+    pointer array_end();
+    const_pointer array_end() const;
 
 private:
-    std::vector<value_type, allocator_type> array_;
+    allocator_type alloc_;
+    pointer array_;     // Uninitialized storage; only [head_, head_ + contents_size_) is alive.
+    size_type capacity_;
+    size_type growth_limit_;
     size_type head_;
     size_type tail_;
     size_type contents_size_;
 };
 
-template<typename T, typename Allocator>
-void circular_buffer<T, Allocator>::set_initial_values() noexcept
+template<typename T, typename Allocator, std::size_t InlineN>
+void circular_buffer<T, Allocator, InlineN>::set_initial_values() noexcept
 {
     head_ = 0;
     tail_ = 0;
     contents_size_ = 0;
 }
 
-template<typename T, typename Allocator>
-typename circular_buffer<T, Allocator>::reference
-circular_buffer<T, Allocator>::operator[](size_type index)
+template<typename T, typename Allocator, std::size_t InlineN>
+typename circular_buffer<T, Allocator, InlineN>::pointer
+circular_buffer<T, Allocator, InlineN>::allocate(size_type capacity)
+{
+    if(capacity == 0)
+        return nullptr;
+    if(capacity <= InlineN)
+        return this->inline_data();
+    return allocator_traits::allocate(alloc_, capacity);
+}
+
+template<typename T, typename Allocator, std::size_t InlineN>
+void circular_buffer<T, Allocator, InlineN>::destroy_and_deallocate() noexcept
+{
+    destroy_front(contents_size_);
+    if((array_ != nullptr) && !is_inline())
+        allocator_traits::deallocate(alloc_, array_, capacity_);
+    array_ = nullptr;
+    capacity_ = 0;
+    set_initial_values();
+}
+
+template<typename T, typename Allocator, std::size_t InlineN>
+void circular_buffer<T, Allocator, InlineN>::take_storage(circular_buffer& other) noexcept(nothrow_take_storage)
+{
+    if(other.is_inline())
+    {   // The elements move into the inline storage of *this, at the same positions.
+        array_ = this->inline_data();
+        capacity_ = other.capacity_;
+        growth_limit_ = other.growth_limit_;
+        head_ = other.head_;
+        tail_ = other.head_;
+        contents_size_ = 0;
+        const auto first_count = (std::min)(other.contents_size_, capacity_ - head_);
+        const auto tag = detail::is_memcpy_copyable<pointer, pointer>();
+        move_back_n(other.array_ + head_, first_count, tag);
+        move_back_n(other.array_, other.contents_size_ - first_count, tag);
+        other.destroy_and_deallocate();
+        return;
+    }
+
+    array_ = other.array_;
+    capacity_ = other.capacity_;
+    growth_limit_ = other.growth_limit_;
+    head_ = other.head_;
+    tail_ = other.tail_;
+    contents_size_ = other.contents_size_;
+
+    other.array_ = nullptr;
+    other.capacity_ = 0;
+    other.set_initial_values();
+}
+
+template<typename T, typename Allocator, std::size_t InlineN>
+void circular_buffer<T, Allocator, InlineN>::move_assign(circular_buffer& other, std::true_type) noexcept(nothrow_take_storage)
+{
+    alloc_ = std::move(other.alloc_);
+    take_storage(other);
+}
+
+template<typename T, typename Allocator, std::size_t InlineN>
+void circular_buffer<T, Allocator, InlineN>::move_assign(circular_buffer& other, std::false_type)
+{
+    if(alloc_ == other.alloc_)
+    {
+        take_storage(other);
+    }
+    else
+    {   // When both allocators are different.
+        array_ = allocate(other.capacity_);
+        capacity_ = other.capacity_;
+        move_elements(other);
+        other.destroy_and_deallocate();
+    }
+}
+
+// Keeps the elements at the same positions as in other.
+template<typename T, typename Allocator, std::size_t InlineN>
+void circular_buffer<T, Allocator, InlineN>::copy_elements(const circular_buffer& other)
+{
+    head_ = other.head_;
+    tail_ = other.head_;
+    contents_size_ = 0;
+    try
+    {
+        for(const auto& item : other)
+            construct_back(item);
+    }
+    catch(...)
+    {
+        destroy_and_deallocate();
+        throw;
+    }
+}
+
+template<typename T, typename Allocator, std::size_t InlineN>
+void circular_buffer<T, Allocator, InlineN>::move_elements(circular_buffer& other)
+{
+    growth_limit_ = other.growth_limit_;
+    head_ = other.head_;
+    tail_ = other.head_;
+    contents_size_ = 0;
+    try
+    {
+        for(auto& item : other)
+            construct_back(std::move_if_noexcept(item));
+    }
+    catch(...)
+    {
+        destroy_and_deallocate();
+        throw;
+    }
+}
+
+// Destroys the first count elements without moving the head.
+template<typename T, typename Allocator, std::size_t InlineN>
+void circular_buffer<T, Allocator, InlineN>::destroy_front(size_type count) noexcept
+{
+    if(std::is_trivially_destructible<value_type>::value)
+        return;
+    for(auto index = head_; count > 0; --count, index = next_index(index))
+        allocator_traits::destroy(alloc_, array_ + index);
+}
+
+// Makes room for count more elements if the limit allows, at least doubling the capacity.
+template<typename T, typename Allocator, std::size_t InlineN>
+void circular_buffer<T, Allocator, InlineN>::grow(size_type count)
+{
+    assert(can_grow());
+    const auto wanted = (std::max)(2 * capacity_, contents_size_ + count);
+    set_capacity((std::min)(wanted, growth_limit_));
+}
+
+template<typename T, typename Allocator, std::size_t InlineN>
+typename circular_buffer<T, Allocator, InlineN>::reference
+circular_buffer<T, Allocator, InlineN>::operator[](size_type index)
 {
 #if (defined(_MSC_VER) && (_MSVC_LANG < 201703L)) || (__cplusplus < 201703L)
     const auto& temp = *this;
@@ -422,9 +737,9 @@ circular_buffer<T, Allocator>::operator[](size_type index)
 #endif
 }
 
-template<typename T, typename Allocator>
-typename circular_buffer<T, Allocator>::const_reference
-circular_buffer<T, Allocator>::operator[](size_type index) const
+template<typename T, typename Allocator, std::size_t InlineN>
+typename circular_buffer<T, Allocator, InlineN>::const_reference
+circular_buffer<T, Allocator, InlineN>::operator[](size_type index) const
 {
     assert(!is_empty());
     assert(index < size());
@@ -433,9 +748,9 @@ circular_buffer<T, Allocator>::operator[](size_type index) const
     return array_[actual_index];
 }
 
-template<typename T, typename Allocator>
-typename circular_buffer<T, Allocator>::reference
-circular_buffer<T, Allocator>::at(size_type index)
+template<typename T, typename Allocator, std::size_t InlineN>
+typename circular_buffer<T, Allocator, InlineN>::reference
+circular_buffer<T, Allocator, InlineN>::at(size_type index)
 {
 #if (defined(_MSC_VER) && (_MSVC_LANG < 201703L)) || (__cplusplus < 201703L)
     const auto& temp = *this;
@@ -445,9 +760,9 @@ circular_buffer<T, Allocator>::at(size_type index)
 #endif
 }
 
-template<typename T, typename Allocator>
-typename circular_buffer<T, Allocator>::const_reference
-circular_buffer<T, Allocator>::at(size_type index) const
+template<typename T, typename Allocator, std::size_t InlineN>
+typename circular_buffer<T, Allocator, InlineN>::const_reference
+circular_buffer<T, Allocator, InlineN>::at(size_type index) const
 {
     assert(!is_empty());
     if(index >= size())
@@ -455,9 +770,9 @@ circular_buffer<T, Allocator>::at(size_type index) const
     return (*this)[index];
 }
 
-template<typename T, typename Allocator>
-typename circular_buffer<T, Allocator>::reference
-circular_buffer<T, Allocator>::front()
+template<typename T, typename Allocator, std::size_t InlineN>
+typename circular_buffer<T, Allocator, InlineN>::reference
+circular_buffer<T, Allocator, InlineN>::front()
 {
 #if (defined(_MSC_VER) && (_MSVC_LANG < 201703L)) || (__cplusplus < 201703L)
     const auto& temp = *this;
@@ -467,17 +782,17 @@ circular_buffer<T, Allocator>::front()
 #endif
 }
 
-template<typename T, typename Allocator>
-typename circular_buffer<T, Allocator>::const_reference
-circular_buffer<T, Allocator>::front() const
+template<typename T, typename Allocator, std::size_t InlineN>
+typename circular_buffer<T, Allocator, InlineN>::const_reference
+circular_buffer<T, Allocator, InlineN>::front() const
 {
     assert(!is_empty());
     return array_[head_];
 }
 
-template<typename T, typename Allocator>
-typename circular_buffer<T, Allocator>::reference
-circular_buffer<T, Allocator>::back()
+template<typename T, typename Allocator, std::size_t InlineN>
+typename circular_buffer<T, Allocator, InlineN>::reference
+circular_buffer<T, Allocator, InlineN>::back()
 {
 #if (defined(_MSC_VER) && (_MSVC_LANG < 201703L)) || (__cplusplus < 201703L)
     const auto& temp = *this;
@@ -487,345 +802,581 @@ circular_buffer<T, Allocator>::back()
 #endif
 }
 
-template<typename T, typename Allocator>
-typename circular_buffer<T, Allocator>::const_reference
-circular_buffer<T, Allocator>::back() const
+template<typename T, typename Allocator, std::size_t InlineN>
+typename circular_buffer<T, Allocator, InlineN>::const_reference
+circular_buffer<T, Allocator, InlineN>::back() const
 {
     assert(!is_empty());
     auto index = (tail_ > 0)? tail_ - 1 : capacity() - 1;
     return array_[index];
 }
 
-template<typename T, typename Allocator>
-void circular_buffer<T, Allocator>::clear()
+template<typename T, typename Allocator, std::size_t InlineN>
+void circular_buffer<T, Allocator, InlineN>::clear()
+{
+    destroy_front(contents_size_);
+    set_initial_values();
+}
+
+template<typename T, typename Allocator, std::size_t InlineN>
+template<typename... Args>
+void circular_buffer<T, Allocator, InlineN>::construct_front(Args&&... args)
+{
+    assert(!is_full());
+    const auto index = prev_index(head_);
+    allocator_traits::construct(alloc_, array_ + index, std::forward<Args>(args)...);
+    head_ = index;
+    ++contents_size_;
+}
+
+template<typename T, typename Allocator, std::size_t InlineN>
+template<typename... Args>
+void circular_buffer<T, Allocator, InlineN>::construct_back(Args&&... args)
+{
+    assert(!is_full());
+    allocator_traits::construct(alloc_, array_ + tail_, std::forward<Args>(args)...);
+    tail_ = next_index(tail_);
+    ++contents_size_;
+}
+
+// Full buffer, assignable element: the back element is reused in place.
+template<typename T, typename Allocator, std::size_t InlineN>
+template<typename U>
+void circular_buffer<T, Allocator, InlineN>::overwrite_front(U&& item, std::true_type)
+{
+    const auto index = prev_index(head_);
+    array_[index] = std::forward<U>(item);
+    head_ = index;
+    tail_ = index;
+}
+
+// Full buffer, non-assignable element: the item is built first because it may refer to the evicted element.
+template<typename T, typename Allocator, std::size_t InlineN>
+template<typename U>
+void circular_buffer<T, Allocator, InlineN>::overwrite_front(U&& item, std::false_type)
+{
+    value_type temp(std::forward<U>(item));
+    pop_back();
+    construct_front(std::move(temp));
+}
+
+template<typename T, typename Allocator, std::size_t InlineN>
+template<typename U>
+void circular_buffer<T, Allocator, InlineN>::overwrite_back(U&& item, std::true_type)
+{
+    array_[tail_] = std::forward<U>(item);
+    tail_ = next_index(tail_);
+    head_ = tail_;
+}
+
+template<typename T, typename Allocator, std::size_t InlineN>
+template<typename U>
+void circular_buffer<T, Allocator, InlineN>::overwrite_back(U&& item, std::false_type)
 {
-    const auto old_capacity = array_.size();
-    if(old_capacity > 0)
+    value_type temp(std::forward<U>(item));
+    pop_front();
+    construct_back(std::move(temp));
+}
+
+template<typename T, typename Allocator, std::size_t InlineN>
+template<typename... Args>
+typename circular_buffer<T, Allocator, InlineN>::reference
+circular_buffer<T, Allocator, InlineN>::emplace_front(Args&&... args)
+{
+    if(!is_full())
     {
-        array_.clear();
-        // In practice, no memory reallocation occurs.
-        array_.resize(old_capacity);
+        construct_front(std::forward<Args>(args)...);
     }
-    set_initial_values();
+    else if(can_grow())
+    {   // The arguments may refer to an element that the reallocation moves.
+        value_type temp(std::forward<Args>(args)...);
+        grow(1);
+        construct_front(std::move(temp));
+    }
+    else
+    {
+        overwrite_front(value_type(std::forward<Args>(args)...), std::is_move_assignable<value_type>());
+    }
+    return front();
 }
 
-template<typename T, typename Allocator>
+template<typename T, typename Allocator, std::size_t InlineN>
+template<typename... Args>
+typename circular_buffer<T, Allocator, InlineN>::reference
+circular_buffer<T, Allocator, InlineN>::emplace_back(Args&&... args)
+{
+    if(!is_full())
+    {
+        construct_back(std::forward<Args>(args)...);
+    }
+    else if(can_grow())
+    {   // The arguments may refer to an element that the reallocation moves.
+        value_type temp(std::forward<Args>(args)...);
+        grow(1);
+        construct_back(std::move(temp));
+    }
+    else
+    {
+        overwrite_back(value_type(std::forward<Args>(args)...), std::is_move_assignable<value_type>());
+    }
+    return back();
+}
+
+template<typename T, typename Allocator, std::size_t InlineN>
 template<typename U>
 std::enable_if_t<std::is_copy_constructible<U>::value, void>
-circular_buffer<T, Allocator>::push_front(const_reference item)
+circular_buffer<T, Allocator, InlineN>::push_front(const_reference item)
 {
     push_front_fwd(item);
 }
 
-template<typename T, typename Allocator>
+template<typename T, typename Allocator, std::size_t InlineN>
 template<typename U>
 std::enable_if_t<std::is_move_constructible<U>::value, void>
-circular_buffer<T, Allocator>::push_front(value_type&& item)
+circular_buffer<T, Allocator, InlineN>::push_front(value_type&& item)
 {
     push_front_fwd(std::move(item));
 }
 
-template<typename T, typename Allocator>
+template<typename T, typename Allocator, std::size_t InlineN>
 template<typename U>
-void circular_buffer<T, Allocator>::push_front_fwd(U&& item)
+void circular_buffer<T, Allocator, InlineN>::push_front_fwd(U&& item)
 {
-    const auto cap = capacity();
-
-    head_ = (head_ > 0)? head_ - 1 : cap - 1;
-    array_[head_] = std::forward<U>(item);
-
-    if(contents_size_ < cap)
+    if(!is_full())
     {
-        ++contents_size_;
+        construct_front(std::forward<U>(item));
+    }
+    else if(can_grow())
+    {   // The item may refer to an element that the reallocation moves.
+        value_type temp(std::forward<U>(item));
+        grow(1);
+        construct_front(std::move(temp));
     }
     else
     {
-        tail_ = (tail_ > 0)? tail_ - 1 : cap - 1;
+        overwrite_front(std::forward<U>(item), std::is_assignable<reference, U&&>());
     }
 }
 
-template<typename T, typename Allocator>
+template<typename T, typename Allocator, std::size_t InlineN>
 template<typename U>
 std::enable_if_t<std::is_copy_constructible<U>::value, void>
-circular_buffer<T, Allocator>::push_back(const_reference item)
+circular_buffer<T, Allocator, InlineN>::push_back(const_reference item)
 {
     push_back_fwd(item);
 }
 
-template<typename T, typename Allocator>
+template<typename T, typename Allocator, std::size_t InlineN>
 template<typename U>
 std::enable_if_t<std::is_move_constructible<U>::value, void>
-circular_buffer<T, Allocator>::push_back(value_type&& item)
+circular_buffer<T, Allocator, InlineN>::push_back(value_type&& item)
 {
     push_back_fwd(std::move(item));
 }
 
-template<typename T, typename Allocator>
+template<typename T, typename Allocator, std::size_t InlineN>
 template<typename U>
-void circular_buffer<T, Allocator>::push_back_fwd(U&& item)
+void circular_buffer<T, Allocator, InlineN>::push_back_fwd(U&& item)
 {
-    const auto cap = capacity();
-
-    array_[tail_] = std::forward<U>(item);
-    tail_ = (tail_ < (cap - 1))? tail_ + 1 : 0;
-
-    if(contents_size_ < cap)
+    if(!is_full())
     {
-        ++contents_size_;
+        construct_back(std::forward<U>(item));
+    }
+    else if(can_grow())
+    {   // The item may refer to an element that the reallocation moves.
+        value_type temp(std::forward<U>(item));
+        grow(1);
+        construct_back(std::move(temp));
     }
     else
     {
-        head_ = (head_ < (cap - 1))? head_ + 1 : 0;
+        overwrite_back(std::forward<U>(item), std::is_assignable<reference, U&&>());
     }
 }
 
-template<typename T, typename Allocator>
-void circular_buffer<T, Allocator>::pop_front()
+template<typename T, typename Allocator, std::size_t InlineN>
+template<typename InputIt, typename>
+void circular_buffer<T, Allocator, InlineN>::push_back(InputIt first, InputIt last)
 {
-    assert(!is_empty());
-    head_ = (head_ < (capacity() - 1))? head_ + 1 : 0;
-    --contents_size_;
+    push_back_range(first, last, typename std::iterator_traits<InputIt>::iterator_category());
+}
+
+template<typename T, typename Allocator, std::size_t InlineN>
+template<typename InputIt>
+void circular_buffer<T, Allocator, InlineN>::push_back_range(InputIt first, InputIt last, std::input_iterator_tag)
+{
+    for(; first != last; ++first)
+        push_back_fwd(*first);
+}
+
+template<typename T, typename Allocator, std::size_t InlineN>
+template<typename ForwardIt>
+void circular_buffer<T, Allocator, InlineN>::push_back_range(ForwardIt first, ForwardIt last, std::forward_iterator_tag)
+{
+    auto count = static_cast<size_type>(std::distance(first, last));
+    if((count > capacity() - contents_size_) && can_grow())
+        grow(count);
+
+    const auto cap = capacity();
+    if(count >= cap)
+    {   // Only the last `cap` elements survive.
+        std::advance(first, static_cast<difference_type>(count - cap));
+        clear();
+        count = cap;
+    }
+    else if(count > cap - contents_size_)
+    {   // Evict the oldest elements to make room.
+        pop_front(count - (cap - contents_size_));
+    }
+
+    construct_back_n(first, count, detail::is_memcpy_copyable<ForwardIt, pointer>());
+}
+
+template<typename T, typename Allocator, std::size_t InlineN>
+typename circular_buffer<T, Allocator, InlineN>::size_type
+circular_buffer<T, Allocator, InlineN>::insert_back(const_pointer items, size_type count)
+{
+    count = (std::min)(count, capacity() - contents_size_);
+    construct_back_n(items, count, detail::is_memcpy_copyable<const_pointer, pointer>());
+    return count;
+}
+
+template<typename T, typename Allocator, std::size_t InlineN>
+typename circular_buffer<T, Allocator, InlineN>::size_type
+circular_buffer<T, Allocator, InlineN>::insert_back(const_array_range_t items)
+{
+    return insert_back(items.first, items.second);
+}
+
+// Constructs count (<= free space) elements at the tail in at most two contiguous segments.
+template<typename T, typename Allocator, std::size_t InlineN>
+template<typename InputIt>
+InputIt circular_buffer<T, Allocator, InlineN>::construct_back_n(InputIt first, size_type count, std::true_type)
+{
+    assert(count <= capacity() - contents_size_);
+    const auto first_count = (std::min)(count, capacity() - tail_);
+    first = detail::copy_n_impl(first, first_count, array_begin() + tail_, std::true_type()).first;
+    first = detail::copy_n_impl(first, count - first_count, array_begin(), std::true_type()).first;
+    tail_ = advance_index(tail_, count);
+    contents_size_ += count;
+    return first;
+}
+
+template<typename T, typename Allocator, std::size_t InlineN>
+template<typename InputIt>
+InputIt circular_buffer<T, Allocator, InlineN>::construct_back_n(InputIt first, size_type count, std::false_type)
+{
+    for(; count > 0; --count, ++first)
+        construct_back(*first);
+    return first;
+}
+
+template<typename T, typename Allocator, std::size_t InlineN>
+void circular_buffer<T, Allocator, InlineN>::move_back_n(pointer first, size_type count, std::true_type)
+{
+    construct_back_n(first, count, std::true_type());
+}
+
+template<typename T, typename Allocator, std::size_t InlineN>
+void circular_buffer<T, Allocator, InlineN>::move_back_n(pointer first, size_type count, std::false_type)
+{
+    for(; count > 0; --count, ++first)
+        construct_back(std::move_if_noexcept(*first));
 }
 
-template<typename T, typename Allocator>
-void circular_buffer<T, Allocator>::pop_back()
+template<typename T, typename Allocator, std::size_t InlineN>
+void circular_buffer<T, Allocator, InlineN>::relocate(pointer dest, pointer src, size_type count, std::true_type)
+{
+    assert(dest < src);
+    if(count > 0)
+        std::memmove(dest, src, count * sizeof(value_type));
+}
+
+template<typename T, typename Allocator, std::size_t InlineN>
+void circular_buffer<T, Allocator, InlineN>::relocate(pointer dest, pointer src, size_type count, std::false_type)
+{
+    assert(dest < src);
+    for(; count > 0; --count, ++src, ++dest)
+    {
+        allocator_traits::construct(alloc_, dest, std::move_if_noexcept(*src));
+        allocator_traits::destroy(alloc_, src);
+    }
+}
+
+template<typename T, typename Allocator, std::size_t InlineN>
+typename circular_buffer<T, Allocator, InlineN>::size_type
+circular_buffer<T, Allocator, InlineN>::advance_index(size_type index, size_type count) const noexcept
+{
+    const auto cap = capacity();
+    assert(index < cap);
+    assert(count <= cap);
+    return (count < cap - index)? index + count : index + count - cap;
+}
+
+template<typename T, typename Allocator, std::size_t InlineN>
+void circular_buffer<T, Allocator, InlineN>::pop_front()
 {
     assert(!is_empty());
-    tail_ = (tail_ > 0)? tail_ - 1 : capacity() - 1;
+    allocator_traits::destroy(alloc_, array_ + head_);
+    head_ = next_index(head_);
     --contents_size_;
 }
 
-template<typename T, typename Allocator>
-typename circular_buffer<T, Allocator>::array_range_t
-circular_buffer<T, Allocator>::array_one()
+template<typename T, typename Allocator, std::size_t InlineN>
+void circular_buffer<T, Allocator, InlineN>::pop_front(size_type count)
 {
-    assert(!is_empty());
-    auto size = (head_ < tail_)? tail_ - head_ : capacity() - head_;
-    return std::make_pair(&array_[head_], size);
+    assert(count <= size());
+    destroy_front(count);
+    head_ = advance_index(head_, count);
+    contents_size_ -= count;
 }
 
-template<typename T, typename Allocator>
-typename circular_buffer<T, Allocator>::const_array_range_t
-circular_buffer<T, Allocator>::array_one() const
+template<typename T, typename Allocator, std::size_t InlineN>
+typename circular_buffer<T, Allocator, InlineN>::array_ranges_t
+circular_buffer<T, Allocator, InlineN>::reserve_back(size_type count)
 {
-    assert(!is_empty());
-    auto size = (head_ < tail_)? tail_ - head_ : capacity() - head_;
-    return std::make_pair(&array_[head_], size);
+    count = (std::min)(count, capacity() - contents_size_);
+    const auto first_count = (std::min)(count, capacity() - tail_);
+    return std::make_pair(std::make_pair(array_ + tail_, first_count), std::make_pair(array_, count - first_count));
 }
 
-template<typename T, typename Allocator>
-typename circular_buffer<T, Allocator>::array_range_t
-circular_buffer<T, Allocator>::array_two()
+template<typename T, typename Allocator, std::size_t InlineN>
+void circular_buffer<T, Allocator, InlineN>::commit_back(size_type count)
 {
-    assert(!is_empty());
-    auto size = (tail_ > head_)? 0 : tail_;
-    return std::make_pair(&array_[0], size);
+    assert(count <= capacity() - contents_size_);
+    tail_ = advance_index(tail_, count);
+    contents_size_ += count;
 }
 
-template<typename T, typename Allocator>
-typename circular_buffer<T, Allocator>::const_array_range_t
-circular_buffer<T, Allocator>::array_two() const
+template<typename T, typename Allocator, std::size_t InlineN>
+typename circular_buffer<T, Allocator, InlineN>::array_ranges_t
+circular_buffer<T, Allocator, InlineN>::peek_front(size_type count)
 {
-    assert(!is_empty());
-    auto size = (tail_ > head_)? 0 : tail_;
-    return std::make_pair(&array_[0], size);
+    count = (std::min)(count, contents_size_);
+    const auto first_count = (std::min)(count, capacity() - head_);
+    return std::make_pair(std::make_pair(array_ + head_, first_count), std::make_pair(array_, count - first_count));
 }
 
-template<typename T, typename Allocator>
-bool circular_buffer<T, Allocator>::is_linearized() const
+template<typename T, typename Allocator, std::size_t InlineN>
+typename circular_buffer<T, Allocator, InlineN>::const_array_ranges_t
+circular_buffer<T, Allocator, InlineN>::peek_front(size_type count) const
 {
-    return head_ == 0;
+    count = (std::min)(count, contents_size_);
+    const auto first_count = (std::min)(count, capacity() - head_);
+    return std::make_pair(std::make_pair(const_pointer(array_ + head_), first_count), std::make_pair(const_pointer(array_), count - first_count));
 }
 
-template<typename T, typename Allocator>
-void circular_buffer<T, Allocator>::linearize()
+template<typename T, typename Allocator, std::size_t InlineN>
+void circular_buffer<T, Allocator, InlineN>::pop_back()
 {
-    if(is_linearized())
-        return;
-#if defined(__GNUC__)
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wsign-conversion"
-#endif
-    std::rotate(array_.begin(), array_.begin() + head_, array_.end());
-#if defined(__GNUC__)
-#pragma GCC diagnostic pop
-#endif
-    head_ = 0;
-    tail_ = (is_full())? 0 : contents_size_;
+    assert(!is_empty());
+    tail_ = prev_index(tail_);
+    allocator_traits::destroy(alloc_, array_ + tail_);
+    --contents_size_;
 }
 
-template<typename T, typename Allocator>
-typename circular_buffer<T, Allocator>::pointer
-circular_buffer<T, Allocator>::array_begin()
+template<typename T, typename Allocator, std::size_t InlineN>
+template<typename OutputIt>
+OutputIt circular_buffer<T, Allocator, InlineN>::copy_out(OutputIt dest, size_type count) const
 {
-#if (defined(_MSC_VER) && (_MSVC_LANG < 201703L)) || (__cplusplus < 201703L)
-    const auto& temp = *this;
-    return const_cast<pointer>(temp.array_begin());
-#else
-    return const_cast<pointer>(std::as_const(*this).array_begin());
-#endif
+    assert(count <= size());
+    const auto first_count = (std::min)(count, capacity() - head_);
+    dest = detail::copy_n(array_begin() + head_, first_count, dest).second;
+    dest = detail::copy_n(array_begin(), count - first_count, dest).second;
+    return dest;
 }
 
-template<typename T, typename Allocator>
-typename circular_buffer<T, Allocator>::const_pointer
-circular_buffer<T, Allocator>::array_begin() const
+template<typename T, typename Allocator, std::size_t InlineN>
+template<typename OutputIt>
+OutputIt circular_buffer<T, Allocator, InlineN>::copy_linearized(OutputIt dest) const
 {
-    return array_.data();
+    return copy_out(dest, contents_size_);
 }
 
-template<typename T, typename Allocator>
-typename circular_buffer<T, Allocator>::pointer
-circular_buffer<T, Allocator>::array_end()
+template<typename T, typename Allocator, std::size_t InlineN>
+std::vector<typename circular_buffer<T, Allocator, InlineN>::value_type>
+circular_buffer<T, Allocator, InlineN>::to_vector() const
 {
-#if (defined(_MSC_VER) && (_MSVC_LANG < 201703L)) || (__cplusplus < 201703L)
-    const auto& temp = *this;
-    return const_cast<pointer>(temp.array_end());
-#else
-    return const_cast<pointer>(std::as_const(*this).array_end());
-#endif
+    // Range insertion from pointers copies each segment in one go, with memmove for trivial types.
+    std::vector<value_type> result;
+    result.reserve(contents_size_);
+    const auto first_count = (std::min)(contents_size_, capacity() - head_);
+    result.insert(result.end(), array_begin() + head_, array_begin() + head_ + first_count);
+    result.insert(result.end(), array_begin(), array_begin() + (contents_size_ - first_count));
+    return result;
 }
 
-template<typename T, typename Allocator>
-typename circular_buffer<T, Allocator>::const_pointer
-circular_buffer<T, Allocator>::array_end() const
+template<typename T, typename Allocator, std::size_t InlineN>
+typename circular_buffer<T, Allocator, InlineN>::array_range_t
+circular_buffer<T, Allocator, InlineN>::array_one()
 {
-    return array_.data() + array_.size();
+    assert(!is_empty());
+    auto size = (head_ < tail_)? tail_ - head_ : capacity() - head_;
+    return std::make_pair(&array_[head_], size);
 }
 
-template<typename T, typename Allocator>
-typename circular_buffer<T, Allocator>::pointer
-circular_buffer<T, Allocator>::buffer_begin()
+template<typename T, typename Allocator, std::size_t InlineN>
+typename circular_buffer<T, Allocator, InlineN>::const_array_range_t
+circular_buffer<T, Allocator, InlineN>::array_one() const
 {
-#if (defined(_MSC_VER) && (_MSVC_LANG < 201703L)) || (__cplusplus < 201703L)
-    const auto& temp = *this;
-    return const_cast<pointer>(temp.buffer_begin());
-#else
-    return const_cast<pointer>(std::as_const(*this).buffer_begin());
-#endif
+    assert(!is_empty());
+    auto size = (head_ < tail_)? tail_ - head_ : capacity() - head_;
+    return std::make_pair(&array_[head_], size);
 }
 
-template<typename T, typename Allocator>
-typename circular_buffer<T, Allocator>::const_pointer
-circular_buffer<T, Allocator>::buffer_begin() const
+template<typename T, typename Allocator, std::size_t InlineN>
+typename circular_buffer<T, Allocator, InlineN>::array_range_t
+circular_buffer<T, Allocator, InlineN>::array_two()
 {
-    return &array_[head_];
+    assert(!is_empty());
+    auto size = (tail_ > head_)? 0 : tail_;
+    return std::make_pair(&array_[0], size);
 }
 
-template<typename T, typename Allocator>
-typename circular_buffer<T, Allocator>::pointer
-circular_buffer<T, Allocator>::buffer_end()
+template<typename T, typename Allocator, std::size_t InlineN>
+typename circular_buffer<T, Allocator, InlineN>::const_array_range_t
+circular_buffer<T, Allocator, InlineN>::array_two() const
 {
-#if (defined(_MSC_VER) && (_MSVC_LANG < 201703L)) || (__cplusplus < 201703L)
-    const auto& temp = *this;
-    return const_cast<pointer>(temp.buffer_end());
-#else
-    return const_cast<pointer>(std::as_const(*this).buffer_end());
-#endif
+    assert(!is_empty());
+    auto size = (tail_ > head_)? 0 : tail_;
+    return std::make_pair(&array_[0], size);
 }
 
-template<typename T, typename Allocator>
-typename circular_buffer<T, Allocator>::const_pointer
-circular_buffer<T, Allocator>::buffer_end() const
+template<typename T, typename Allocator, std::size_t InlineN>
+void circular_buffer<T, Allocator, InlineN>::set_capacity(size_type new_capacity)
 {
-    return (is_full())? array_end() : &array_[tail_];
+    assert(new_capacity > 0);
+    if((new_capacity != capacity_) || !is_linearized())
+        reallocate(new_capacity);
 }
 
-template<typename T, typename Allocator>
-typename circular_buffer<T, Allocator>::pointer
-circular_buffer<T, Allocator>::increment(const_pointer ptr)
+template<typename T, typename Allocator, std::size_t InlineN>
+void circular_buffer<T, Allocator, InlineN>::reallocate(size_type new_capacity)
 {
-#if (defined(_MSC_VER) && (_MSVC_LANG < 201703L)) || (__cplusplus < 201703L)
-    const auto& temp = *this;
-    return const_cast<pointer>(temp.increment(ptr));
-#else
-    return const_cast<pointer>(std::as_const(*this).increment(ptr));
-#endif
+    circular_buffer temp(new_capacity, alloc_);
+    temp.growth_limit_ = growth_limit_;
+
+    // The surviving elements are moved segment by segment into [0, count) of the new storage.
+    // Nothing is lost if a copy throws, because *this is only released afterwards.
+    const auto count = (std::min)(contents_size_, new_capacity);
+    if(count > 0)
+    {
+        const auto index = advance_index(head_, contents_size_ - count);
+        const auto first_count = (std::min)(count, capacity_ - index);
+        const auto tag = detail::is_memcpy_copyable<pointer, pointer>();
+        temp.move_back_n(array_begin() + index, first_count, tag);
+        temp.move_back_n(array_begin(), count - first_count, tag);
+    }
+
+    destroy_and_deallocate();
+    take_storage(temp);
 }
 
-template<typename T, typename Allocator>
-typename circular_buffer<T, Allocator>::const_pointer
-circular_buffer<T, Allocator>::increment(const_pointer ptr) const
+template<typename T, typename Allocator, std::size_t InlineN>
+void circular_buffer<T, Allocator, InlineN>::reserve(size_type new_capacity)
 {
-    if(++ptr == array_end())
-        ptr = array_begin();
-    return ptr;
+    if(new_capacity > capacity_)
+        set_capacity(new_capacity);
 }
 
-template<typename T, typename Allocator>
-typename circular_buffer<T, Allocator>::pointer
-circular_buffer<T, Allocator>::decrement(const_pointer ptr)
+template<typename T, typename Allocator, std::size_t InlineN>
+void circular_buffer<T, Allocator, InlineN>::shrink_to_fit()
 {
-#if (defined(_MSC_VER) && (_MSVC_LANG < 201703L)) || (__cplusplus < 201703L)
-    const auto& temp = *this;
-    return const_cast<pointer>(temp.decrement(ptr));
-#else
-    return const_cast<pointer>(std::as_const(*this).decrement(ptr));
-#endif
+    const auto new_capacity = (std::max)(contents_size_, size_type(1));
+    if(new_capacity != capacity_)
+        reallocate(new_capacity);
 }
 
-template<typename T, typename Allocator>
-typename circular_buffer<T, Allocator>::const_pointer
-circular_buffer<T, Allocator>::decrement(const_pointer ptr) const
+template<typename T, typename Allocator, std::size_t InlineN>
+bool circular_buffer<T, Allocator, InlineN>::is_linearized() const
 {
-    if(ptr == array_begin())
-        ptr = array_end();
-    --ptr;
-    return ptr;
+    return head_ == 0;
 }
 
-template<typename T, typename Allocator>
-typename circular_buffer<T, Allocator>::pointer
-circular_buffer<T, Allocator>::linearize_pointer(const_pointer ptr)
+/*
+    Works in place, like static_circular_buffer, and touches only the elements,
+    never the unused slots, so the cost is bounded by size() rather than capacity().
+    When the buffer is not full the first segment is moved down into the gap
+    right behind the second one and the now contiguous elements are rotated.
+
+        [B.. gap A..]  ->  [B.. A.. gap]  ->  [A.. B.. gap]
+
+    Moving into the gap destroys each source slot as it goes, which is only safe when the move cannot throw.
+    Otherwise the elements are copied into new storage, as in set_capacity(), and nothing changes if a copy throws.
+    A full buffer is rotated with swaps, which keep every slot alive even if one throws.
+*/
+template<typename T, typename Allocator, std::size_t InlineN>
+void circular_buffer<T, Allocator, InlineN>::linearize()
+{
+    if(is_linearized())
+        return;
+    const auto tag = detail::is_memcpy_copyable<pointer, pointer>();
+    if(is_full())
+    {   // Every slot is alive.
+        std::rotate(array_begin(), array_begin() + head_, array_end());
+    }
+    else if(!tag && !std::is_nothrow_move_constructible<value_type>::value)
+    {
+        reallocate(capacity_);
+        return;
+    }
+    else if(head_ < tail_)
+    {
+        relocate(array_begin(), array_begin() + head_, contents_size_, tag);
+    }
+    else if(!is_empty())
+    {
+        relocate(array_begin() + tail_, array_begin() + head_, capacity() - head_, tag);
+        std::rotate(array_begin(), array_begin() + tail_, array_begin() + contents_size_);
+    }
+    head_ = 0;
+    tail_ = (is_full())? 0 : contents_size_;
+}
+
+template<typename T, typename Allocator, std::size_t InlineN>
+typename circular_buffer<T, Allocator, InlineN>::pointer
+circular_buffer<T, Allocator, InlineN>::array_begin()
 {
 #if (defined(_MSC_VER) && (_MSVC_LANG < 201703L)) || (__cplusplus < 201703L)
     const auto& temp = *this;
-    return const_cast<pointer>(temp.linearize_pointer(ptr));
+    return const_cast<pointer>(temp.array_begin());
 #else
-    return const_cast<pointer>(std::as_const(*this).linearize_pointer(ptr));
+    return const_cast<pointer>(std::as_const(*this).array_begin());
 #endif
 }
 
-template<typename T, typename Allocator>
-typename circular_buffer<T, Allocator>::const_pointer
-circular_buffer<T, Allocator>::linearize_pointer(const_pointer ptr) const
+template<typename T, typename Allocator, std::size_t InlineN>
+typename circular_buffer<T, Allocator, InlineN>::const_pointer
+circular_buffer<T, Allocator, InlineN>::array_begin() const
 {
-    if(ptr == array_end())
-        return ptr;
-
-    auto base = (ptr >= buffer_begin())? array_begin() : array_end();
-    return base + (ptr - buffer_begin());
+    return array_;
 }
 
-template<typename T, typename Allocator>
-typename circular_buffer<T, Allocator>::pointer
-circular_buffer<T, Allocator>::unlinearize_pointer(const_pointer ptr)
+template<typename T, typename Allocator, std::size_t InlineN>
+typename circular_buffer<T, Allocator, InlineN>::pointer
+circular_buffer<T, Allocator, InlineN>::array_end()
 {
 #if (defined(_MSC_VER) && (_MSVC_LANG < 201703L)) || (__cplusplus < 201703L)
     const auto& temp = *this;
-    return const_cast<pointer>(temp.unlinearize_pointer(ptr));
+    return const_cast<pointer>(temp.array_end());
 #else
-    return const_cast<pointer>(std::as_const(*this).unlinearize_pointer(ptr));
+    return const_cast<pointer>(std::as_const(*this).array_end());
 #endif
 }
 
-template<typename T, typename Allocator>
-typename circular_buffer<T, Allocator>::const_pointer
-circular_buffer<T, Allocator>::unlinearize_pointer(const_pointer ptr) const
+template<typename T, typename Allocator, std::size_t InlineN>
+typename circular_buffer<T, Allocator, InlineN>::const_pointer
+circular_buffer<T, Allocator, InlineN>::array_end() const
 {
-    if(ptr == array_end())
-        return ptr;
-
-    const auto mid = array_end() - buffer_begin();
-    const auto offset = (ptr < array_begin() + mid)? (buffer_begin() - array_begin()) : -mid;
-    return ptr + offset;
+    return array_ + capacity_;
 }
 
 #if defined(__has_include) && __has_include(<memory_resource>)
 namespace pmr
 {
 
-template<typename T>
-using circular_buffer = container::circular_buffer<T, std::pmr::polymorphic_allocator<T>>;
+template<typename T, std::size_t InlineN = 0>
+using circular_buffer = container::circular_buffer<T, std::pmr::polymorphic_allocator<T>, InlineN>;
 
 }   // namespace pmr
 #endif
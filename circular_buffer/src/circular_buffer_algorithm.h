@@ -0,0 +1,107 @@
+#pragma once
+#include <algorithm>
+#include <numeric>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <type_traits>
+
+namespace container
+{
+
+/*
+    Segmented algorithms.
+
+    The elements of a circular buffer occupy at most two contiguous arrays,
+    array_one() and array_two(). These overloads run the standard algorithm
+    on each array with plain pointers, which the compiler can vectorize,
+    instead of stepping an iterator that wraps around.
+
+    They accept any buffer that provides is_empty(), array_one() and array_two().
+*/
+
+namespace detail
+{
+
+template<typename Buffer>
+using enable_if_segmented_t = decltype(std::declval<Buffer&>().array_two(), void());
+
+// Calls f(first, last) for each non-empty segment in order, until f returns true.
+template<typename Buffer, typename F>
+inline void visit_segments(Buffer& cb, F f)
+{
+    if(cb.is_empty())
+        return;
+    const auto one = cb.array_one();
+    if(f(one.first, one.first + one.second))
+        return;
+    const auto two = cb.array_two();
+    if(two.second > 0)
+        f(two.first, two.first + two.second);
+}
+
+}   // namespace detail
+
+template<typename Buffer, typename UnaryFunction, typename = detail::enable_if_segmented_t<Buffer>>
+inline UnaryFunction for_each(Buffer& cb, UnaryFunction f)
+{
+    detail::visit_segments(cb, [&f](auto first, auto last)
+    {
+        for(; first != last; ++first)
+            f(*first);
+        return false;
+    });
+    return f;
+}
+
+template<typename Buffer, typename OutputIt, typename UnaryOperation, typename = detail::enable_if_segmented_t<Buffer>>
+inline OutputIt transform(const Buffer& cb, OutputIt dest, UnaryOperation op)
+{
+    detail::visit_segments(cb, [&dest, &op](auto first, auto last)
+    {
+        dest = std::transform(first, last, dest, op);
+        return false;
+    });
+    return dest;
+}
+
+template<typename Buffer, typename T, typename BinaryOperation, typename = detail::enable_if_segmented_t<Buffer>>
+inline T accumulate(const Buffer& cb, T init, BinaryOperation op)
+{
+    detail::visit_segments(cb, [&init, &op](auto first, auto last)
+    {
+        init = std::accumulate(first, last, std::move(init), op);
+        return false;
+    });
+    return init;
+}
+
+template<typename Buffer, typename T, typename = detail::enable_if_segmented_t<Buffer>>
+inline T accumulate(const Buffer& cb, T init)
+{
+    return container::accumulate(cb, std::move(init), std::plus<>());
+}
+
+// Returns an iterator of cb to the first element equal to value, or cb.end().
+template<typename Buffer, typename T, typename = detail::enable_if_segmented_t<Buffer>>
+inline auto find(Buffer& cb, const T& value) -> decltype(cb.begin())
+{
+    using difference_type = typename std::iterator_traits<decltype(cb.begin())>::difference_type;
+
+    auto result = cb.end();
+    difference_type offset = 0;
+    detail::visit_segments(cb, [&](auto first, auto last)
+    {
+        const auto found = std::find(first, last, value);
+        if(found == last)
+        {
+            offset += last - first;
+            return false;
+        }
+        result = cb.begin() + (offset + (found - first));
+        return true;
+    });
+    return result;
+}
+
+}   // namespace container
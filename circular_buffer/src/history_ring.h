@@ -0,0 +1,179 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <algorithm>
+#if defined(__has_include) && __has_include(<memory_resource>)
+#include <memory_resource>
+#endif
+#include "circular_buffer.h"
+
+namespace container
+{
+
+enum class history_status
+{
+    found,
+    evicted,            // Older than first_sequence().
+    not_yet_written     // next_sequence() or later.
+};
+
+/*
+    Ring that numbers its elements with a monotonically increasing sequence, e.g. for replaying message #N.
+
+    Each pushed element gets the next sequence. The ring keeps the newest capacity() elements,
+    so the retained sequences are always [first_sequence(), next_sequence()),
+    and the element of a sequence is found by its offset from first_sequence() in O(1), without a side map.
+
+    get() tells an evicted sequence from one not yet written; range() returns the retained part
+    of a sequence range as two contiguous runs.
+*/
+template<typename T, typename Allocator = std::allocator<T>>
+class history_ring final
+{
+public:
+    using value_type        = T;
+    using const_pointer     = const value_type*;
+    using const_reference   = const value_type&;
+    using size_type         = std::size_t;
+    using sequence_type     = std::uint64_t;
+    using allocator_type    = Allocator;
+    using buffer_type       = circular_buffer<T, Allocator>;
+
+    using const_array_ranges_t = typename buffer_type::const_array_ranges_t;
+
+    // The element is only set when the status is found.
+    using lookup_t = std::pair<history_status, const_pointer>;
+
+public:
+    history_ring() = delete;
+
+    // The first element pushed gets first_sequence.
+    explicit history_ring(size_type capacity, sequence_type first_sequence = 0, const Allocator& alloc = Allocator())
+        : buffer_(capacity, alloc)
+        , first_sequence_(first_sequence)
+    {}
+
+    // These evict the oldest element when full, and return the sequence of the new one.
+    template<typename... Args>
+    sequence_type emplace_back(Args&&... args);
+
+    sequence_type push_back(const_reference item) { return emplace_back(item); }
+    sequence_type push_back(value_type&& item) { return emplace_back(std::move(item)); }
+
+    history_status status(sequence_type sequence) const noexcept;
+
+    lookup_t get(sequence_type sequence) const;
+
+    // The retained elements of [first, last), which start at (std::max)(first, first_sequence()).
+    const_array_ranges_t range(sequence_type first, sequence_type last) const;
+
+    // Removes the elements older than sequence; later pushes continue from next_sequence().
+    void evict_before(sequence_type sequence);
+
+    // Removes every element; the sequences are not reused.
+    void clear() { evict_before(next_sequence()); }
+
+    // The oldest retained sequence, or next_sequence() when empty.
+    sequence_type first_sequence() const noexcept { return first_sequence_; }
+
+    // The sequence the next pushed element gets.
+    sequence_type next_sequence() const noexcept { return first_sequence_ + buffer_.size(); }
+
+    // The elements, oldest first.
+    const buffer_type& values() const noexcept { return buffer_; }
+
+    size_type size() const noexcept { return buffer_.size(); }
+    size_type capacity() const noexcept { return buffer_.capacity(); }
+
+    bool is_empty() const noexcept { return buffer_.is_empty(); }
+    bool is_full() const noexcept { return buffer_.is_full(); }
+
+    allocator_type get_allocator() const noexcept { return buffer_.get_allocator(); }
+
+private:
+    buffer_type buffer_;
+    sequence_type first_sequence_;
+};
+
+template<typename T, typename Allocator>
+template<typename... Args>
+typename history_ring<T, Allocator>::sequence_type
+history_ring<T, Allocator>::emplace_back(Args&&... args)
+{
+    const auto evicts = buffer_.is_full();
+    buffer_.emplace_back(std::forward<Args>(args)...);
+    if(evicts)
+        ++first_sequence_;
+    return next_sequence() - 1;
+}
+
+template<typename T, typename Allocator>
+history_status history_ring<T, Allocator>::status(sequence_type sequence) const noexcept
+{
+    if(sequence < first_sequence_)
+        return history_status::evicted;
+    if(sequence >= next_sequence())
+        return history_status::not_yet_written;
+    return history_status::found;
+}
+
+template<typename T, typename Allocator>
+typename history_ring<T, Allocator>::lookup_t
+history_ring<T, Allocator>::get(sequence_type sequence) const
+{
+    const auto result = status(sequence);
+    if(result != history_status::found)
+        return std::make_pair(result, const_pointer(nullptr));
+    return std::make_pair(result, &buffer_[static_cast<size_type>(sequence - first_sequence_)]);
+}
+
+template<typename T, typename Allocator>
+typename history_ring<T, Allocator>::const_array_ranges_t
+history_ring<T, Allocator>::range(sequence_type first, sequence_type last) const
+{
+    first = (std::max)(first, first_sequence_);
+    last = (std::min)(last, next_sequence());
+    if(first >= last)
+        return buffer_.peek_front(0);
+
+    // The runs of the elements up to last, without the offset of first.
+    const auto offset = static_cast<size_type>(first - first_sequence_);
+    auto ranges = buffer_.peek_front(static_cast<size_type>(last - first_sequence_));
+    if(offset < ranges.first.second)
+    {
+        ranges.first.first += offset;
+        ranges.first.second -= offset;
+    }
+    else
+    {
+        ranges.second.first += offset - ranges.first.second;
+        ranges.second.second -= offset - ranges.first.second;
+        ranges.first = ranges.second;
+        ranges.second.second = 0;
+    }
+    return ranges;
+}
+
+template<typename T, typename Allocator>
+void history_ring<T, Allocator>::evict_before(sequence_type sequence)
+{
+    if(sequence <= first_sequence_)
+        return;
+    const auto count = static_cast<size_type>((std::min)(sequence, next_sequence()) - first_sequence_);
+    buffer_.pop_front(count);
+    first_sequence_ += count;
+}
+
+#if defined(__has_include) && __has_include(<memory_resource>)
+namespace pmr
+{
+
+template<typename T>
+using history_ring = container::history_ring<T, std::pmr::polymorphic_allocator<T>>;
+
+}   // namespace pmr
+#endif
+
+}   // namespace container
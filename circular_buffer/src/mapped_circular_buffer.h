@@ -0,0 +1,478 @@
+#pragma once
+#if defined(__unix__) || defined(__APPLE__)
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <utility>
+#include <iterator>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "circular_buffer.h"
+
+namespace container
+{
+
+// When mapped_circular_buffer writes its pages back to the file.
+enum class sync_policy
+{
+    none,       // Left to the kernel; survives a crash of the process, not of the machine.
+    async,      // Schedules the write-back after every change (msync MS_ASYNC).
+    sync        // Waits for the write-back after every change (msync MS_SYNC).
+};
+
+namespace detail
+{
+
+/*
+    One of the two header copies at the start of the file.
+    head and tail are counters that never wrap; the slot of counter c is c % capacity.
+*/
+struct mapped_header
+{
+    std::uint64_t magic;
+    std::uint64_t generation;   // The valid copy with the larger generation is current.
+    std::uint64_t element_size;
+    std::uint64_t capacity;
+    std::uint64_t head;
+    std::uint64_t tail;
+    std::uint64_t checksum;     // Of the fields above.
+    std::uint64_t reserved;
+};
+
+static_assert(sizeof(mapped_header) == 64, "The file format expects a 64-byte header.");
+
+constexpr std::uint64_t mapped_magic = 0x3146425543455243ull;   // "CRECUBF1"
+
+// FNV-1a over 64-bit words, which is cheap enough to run on every push.
+inline std::uint64_t checksum_of(const mapped_header& header) noexcept
+{
+    const std::uint64_t words[] = {
+        header.magic, header.generation, header.element_size, header.capacity, header.head, header.tail
+    };
+    std::uint64_t hash = 0xcbf29ce484222325ull;
+    for(const auto word : words)
+    {
+        hash ^= word;
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+// A shared, writable mapping of a whole file.
+class mapped_file final
+{
+public:
+    mapped_file() noexcept
+        : address_(nullptr), size_(0)
+    {}
+
+    // Creates the file with initial_size bytes of zeros when it is missing or empty.
+    // Returns through created whether that happened.
+    mapped_file(const char* path, std::size_t initial_size, bool& created)
+        : address_(nullptr), size_(0)
+    {
+        const int fd = ::open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if(fd < 0)
+            throw std::system_error(errno, std::generic_category(), "open");
+
+        struct stat status;
+        bool ok = (::fstat(fd, &status) == 0);
+        created = ok && (status.st_size == 0);
+        if(created)
+            ok = (::ftruncate(fd, static_cast<off_t>(initial_size)) == 0);
+        const auto size = created? initial_size : static_cast<std::size_t>(status.st_size);
+
+        void* address = MAP_FAILED;
+        if(ok && (size > 0))
+            address = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        const int error = errno;
+
+        // The mapping keeps the file open.
+        ::close(fd);
+        if(address == MAP_FAILED)
+            throw std::system_error(error, std::generic_category(), "mmap");
+        address_ = address;
+        size_ = size;
+    }
+
+    ~mapped_file()
+    {
+        if(address_ != nullptr)
+            ::munmap(address_, size_);
+    }
+
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator = (const mapped_file&) = delete;
+
+    mapped_file(mapped_file&& other) noexcept
+        : address_(std::exchange(other.address_, nullptr))
+        , size_(std::exchange(other.size_, 0))
+    {}
+
+    mapped_file& operator = (mapped_file&& other) noexcept
+    {
+        std::swap(address_, other.address_);
+        std::swap(size_, other.size_);
+        return *this;
+    }
+
+    unsigned char* data() const noexcept { return static_cast<unsigned char*>(address_); }
+    std::size_t size() const noexcept { return size_; }
+
+    // Writes back the pages that hold [first, first + count).
+    void sync(const void* first, std::size_t count, int flags) const noexcept
+    {
+        static const auto page_size = static_cast<std::uintptr_t>(::sysconf(_SC_PAGESIZE));
+        const auto begin = reinterpret_cast<std::uintptr_t>(first) & ~(page_size - 1);
+        const auto end = reinterpret_cast<std::uintptr_t>(first) + count;
+        ::msync(reinterpret_cast<void*>(begin), end - begin, flags);
+    }
+
+private:
+    void* address_;
+    std::size_t size_;
+};
+
+}   // namespace detail
+
+/*
+    Circular buffer whose slots live in a memory-mapped file, so that the contents outlive the process.
+
+    Opening an existing file maps it and validates the header; nothing is read or replayed.
+    The file starts with two copies of the header, written alternately, so that a process that dies
+    in the middle of an update leaves the previous copy intact. A full push first publishes the
+    eviction, then overwrites the slot, then publishes the new tail, so the published state never
+    covers a slot that is being written.
+
+    Elements must be trivially copyable. When full, pushing overwrites the oldest element.
+*/
+template<typename T>
+class mapped_circular_buffer final
+{
+    static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable.");
+
+public:
+    using self_type         = mapped_circular_buffer<T>;
+    using value_type        = T;
+    using pointer           = value_type*;
+    using const_pointer     = const value_type*;
+    using reference         = value_type&;
+    using const_reference   = const value_type&;
+    using difference_type   = std::ptrdiff_t;
+    using size_type         = std::size_t;
+
+    using iterator = detail::circular_buffer_iterator<self_type, std::iterator_traits<pointer>>;
+    using const_iterator = detail::circular_buffer_iterator<self_type, std::iterator_traits<const_pointer>>;
+
+    using array_range_t = std::pair<pointer, size_type>;
+    using const_array_range_t = std::pair<const_pointer, size_type>;
+
+public:
+    mapped_circular_buffer() = delete;
+
+    // Opens the file, or creates it with the given capacity.
+    // Throws std::runtime_error when an existing file is damaged or was created for another capacity or element size.
+    mapped_circular_buffer(const std::string& path, size_type capacity, sync_policy policy = sync_policy::none);
+
+    ~mapped_circular_buffer() = default;
+
+    mapped_circular_buffer(const mapped_circular_buffer&) = delete;
+    mapped_circular_buffer& operator = (const mapped_circular_buffer&) = delete;
+
+    mapped_circular_buffer(mapped_circular_buffer&& other) noexcept;
+    mapped_circular_buffer& operator = (mapped_circular_buffer&& other) noexcept;
+
+    reference operator[](size_type index) { return const_cast<reference>(std::as_const(*this)[index]); }
+    const_reference operator[](size_type index) const { assert(index < size()); return slots_[slot(head_ + index)]; }
+
+    reference at(size_type index);
+    const_reference at(size_type index) const;
+
+    reference front() { assert(!is_empty()); return (*this)[0]; }
+    const_reference front() const { assert(!is_empty()); return (*this)[0]; }
+
+    reference back() { assert(!is_empty()); return (*this)[size() - 1]; }
+    const_reference back() const { assert(!is_empty()); return (*this)[size() - 1]; }
+
+    void clear();
+
+    void push_back(const_reference item);
+
+    void pop_front();
+    void pop_front(size_type count);
+
+    // Writes the whole mapping back and waits for it, whatever the policy.
+    void flush() const noexcept;
+
+    size_type size() const noexcept { return static_cast<size_type>(tail_ - head_); }
+
+    bool is_empty() const noexcept { return head_ == tail_; }
+    bool is_full() const noexcept { return size() == capacity_; }
+
+    size_type capacity() const noexcept { return capacity_; }
+
+    sync_policy policy() const noexcept { return policy_; }
+
+    array_range_t array_one();
+    const_array_range_t array_one() const;
+
+    array_range_t array_two();
+    const_array_range_t array_two() const;
+
+    iterator begin() { return iterator(this, 0); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+
+    iterator end() { return iterator(this, static_cast<difference_type>(size())); }
+    const_iterator end() const { return const_iterator(this, static_cast<difference_type>(size())); }
+
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+private:
+    using counter_type = std::uint64_t;
+
+    // The slots start after both header copies, aligned for T.
+    static constexpr std::size_t data_offset =
+        (2 * sizeof(detail::mapped_header) + alignof(T) - 1) / alignof(T) * alignof(T);
+
+    detail::mapped_header* headers() const noexcept
+    {
+        return reinterpret_cast<detail::mapped_header*>(file_.data());
+    }
+
+    size_type slot(counter_type counter) const noexcept { return static_cast<size_type>(counter % capacity_); }
+
+    // Adopts the current header copy of an existing file.
+    void load();
+
+    // Writes head_ and tail_ into the older header copy, which then becomes the current one.
+    void publish() noexcept;
+
+    void sync(const void* first, std::size_t count) const noexcept;
+
+private:
+    detail::mapped_file file_;
+    pointer slots_;
+    size_type capacity_;
+    sync_policy policy_;
+    counter_type head_;
+    counter_type tail_;
+    counter_type generation_;
+    std::size_t current_;   // Index of the current header copy.
+};
+
+template<typename T>
+mapped_circular_buffer<T>::mapped_circular_buffer(const std::string& path, size_type capacity, sync_policy policy)
+    : slots_(nullptr)
+    , capacity_(capacity)
+    , policy_(policy)
+    , head_(0)
+    , tail_(0)
+    , generation_(0)
+    , current_(1)
+{
+    assert(capacity > 0);
+    bool created = false;
+    file_ = detail::mapped_file(path.c_str(), data_offset + capacity * sizeof(value_type), created);
+    if(created)
+    {
+        publish();
+        flush();
+    }
+    else
+    {
+        load();
+    }
+    slots_ = reinterpret_cast<pointer>(file_.data() + data_offset);
+}
+
+template<typename T>
+mapped_circular_buffer<T>::mapped_circular_buffer(mapped_circular_buffer&& other) noexcept
+    : file_(std::move(other.file_))
+    , slots_(std::exchange(other.slots_, nullptr))
+    , capacity_(std::exchange(other.capacity_, 0))
+    , policy_(other.policy_)
+    , head_(std::exchange(other.head_, 0))
+    , tail_(std::exchange(other.tail_, 0))
+    , generation_(std::exchange(other.generation_, 0))
+    , current_(other.current_)
+{}
+
+template<typename T>
+mapped_circular_buffer<T>& mapped_circular_buffer<T>::operator = (mapped_circular_buffer&& other) noexcept
+{
+    file_ = std::move(other.file_);
+    std::swap(slots_, other.slots_);
+    std::swap(capacity_, other.capacity_);
+    std::swap(policy_, other.policy_);
+    std::swap(head_, other.head_);
+    std::swap(tail_, other.tail_);
+    std::swap(generation_, other.generation_);
+    std::swap(current_, other.current_);
+    return *this;
+}
+
+template<typename T>
+void mapped_circular_buffer<T>::load()
+{
+    if(file_.size() < data_offset)
+        throw std::runtime_error("mapped_circular_buffer: the file is too small.");
+
+    const detail::mapped_header* found = nullptr;
+    for(std::size_t i = 0; i < 2; i++)
+    {
+        const auto& header = headers()[i];
+        if((header.magic != detail::mapped_magic) || (header.checksum != detail::checksum_of(header)))
+            continue;
+        if((found == nullptr) || (header.generation > found->generation))
+        {
+            found = &header;
+            current_ = i;
+        }
+    }
+    if(found == nullptr)
+        throw std::runtime_error("mapped_circular_buffer: no valid header.");
+    if((found->element_size != sizeof(value_type)) || (found->capacity != capacity_)
+        || (file_.size() != data_offset + capacity_ * sizeof(value_type)))
+        throw std::runtime_error("mapped_circular_buffer: the file has another element size or capacity.");
+    if((found->tail < found->head) || (found->tail - found->head > capacity_))
+        throw std::runtime_error("mapped_circular_buffer: the header is inconsistent.");
+
+    head_ = found->head;
+    tail_ = found->tail;
+    generation_ = found->generation;
+}
+
+template<typename T>
+void mapped_circular_buffer<T>::publish() noexcept
+{
+    // Keeps the compiler from moving the element stores past the header, and the checksum before the fields.
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+
+    const auto next = current_ ^ 1;
+    auto& header = headers()[next];
+    header.magic = detail::mapped_magic;
+    header.generation = ++generation_;
+    header.element_size = sizeof(value_type);
+    header.capacity = capacity_;
+    header.head = head_;
+    header.tail = tail_;
+    header.reserved = 0;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    header.checksum = detail::checksum_of(header);
+    current_ = next;
+
+    sync(&header, sizeof(header));
+}
+
+template<typename T>
+void mapped_circular_buffer<T>::sync(const void* first, std::size_t count) const noexcept
+{
+    if(policy_ == sync_policy::async)
+        file_.sync(first, count, MS_ASYNC);
+    else if(policy_ == sync_policy::sync)
+        file_.sync(first, count, MS_SYNC);
+}
+
+template<typename T>
+void mapped_circular_buffer<T>::flush() const noexcept
+{
+    if(file_.data() != nullptr)
+        file_.sync(file_.data(), file_.size(), MS_SYNC);
+}
+
+template<typename T>
+typename mapped_circular_buffer<T>::reference
+mapped_circular_buffer<T>::at(size_type index)
+{
+    return const_cast<reference>(std::as_const(*this).at(index));
+}
+
+template<typename T>
+typename mapped_circular_buffer<T>::const_reference
+mapped_circular_buffer<T>::at(size_type index) const
+{
+    if(index >= size())
+        throw std::out_of_range("Index out of bounds.");
+    return (*this)[index];
+}
+
+template<typename T>
+void mapped_circular_buffer<T>::clear()
+{
+    head_ = tail_;
+    publish();
+}
+
+template<typename T>
+void mapped_circular_buffer<T>::push_back(const_reference item)
+{
+    if(is_full())
+    {   // The oldest element leaves before its slot is reused.
+        ++head_;
+        publish();
+    }
+    auto& target = slots_[slot(tail_)];
+    std::memcpy(&target, &item, sizeof(value_type));
+    sync(&target, sizeof(value_type));
+    ++tail_;
+    publish();
+}
+
+template<typename T>
+void mapped_circular_buffer<T>::pop_front()
+{
+    pop_front(1);
+}
+
+template<typename T>
+void mapped_circular_buffer<T>::pop_front(size_type count)
+{
+    assert(count <= size());
+    head_ += count;
+    publish();
+}
+
+template<typename T>
+typename mapped_circular_buffer<T>::array_range_t
+mapped_circular_buffer<T>::array_one()
+{
+    const auto range = std::as_const(*this).array_one();
+    return std::make_pair(const_cast<pointer>(range.first), range.second);
+}
+
+template<typename T>
+typename mapped_circular_buffer<T>::const_array_range_t
+mapped_circular_buffer<T>::array_one() const
+{
+    const auto first = slot(head_);
+    return std::make_pair(slots_ + first, (std::min)(size(), capacity_ - first));
+}
+
+template<typename T>
+typename mapped_circular_buffer<T>::array_range_t
+mapped_circular_buffer<T>::array_two()
+{
+    const auto range = std::as_const(*this).array_two();
+    return std::make_pair(const_cast<pointer>(range.first), range.second);
+}
+
+template<typename T>
+typename mapped_circular_buffer<T>::const_array_range_t
+mapped_circular_buffer<T>::array_two() const
+{
+    return std::make_pair(slots_, size() - (std::min)(size(), capacity_ - slot(head_)));
+}
+
+}   // namespace container
+#endif
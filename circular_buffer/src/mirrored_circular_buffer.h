@@ -0,0 +1,302 @@
+#pragma once
+#if defined(__linux__)
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+#include <numeric>
+#include <utility>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include <cerrno>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace container
+{
+
+namespace detail
+{
+
+// Maps the same pages twice, back to back, so that address + size() aliases address.
+class mirrored_mapping final
+{
+public:
+    mirrored_mapping() noexcept
+        : address_(nullptr), size_(0)
+    {}
+
+    // size must be a multiple of the page size.
+    explicit mirrored_mapping(std::size_t size)
+        : address_(nullptr), size_(size)
+    {
+        assert((size > 0) && (size % page_size() == 0));
+
+        const int fd = ::memfd_create("mirrored_circular_buffer", MFD_CLOEXEC);
+        if(fd < 0)
+            throw std::system_error(errno, std::generic_category(), "memfd_create");
+
+        // Reserve both halves first so that nothing else can be mapped in between.
+        void* reserved = MAP_FAILED;
+        if(::ftruncate(fd, static_cast<off_t>(size)) == 0)
+            reserved = ::mmap(nullptr, 2 * size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+        auto first = static_cast<unsigned char*>(reserved);
+        const bool mapped = (reserved != MAP_FAILED)
+            && (::mmap(first, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED)
+            && (::mmap(first + size, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED);
+        const int error = errno;
+
+        // The mappings keep the memory alive.
+        ::close(fd);
+        if(!mapped)
+        {
+            if(reserved != MAP_FAILED)
+                ::munmap(reserved, 2 * size);
+            throw std::system_error(error, std::generic_category(), "mmap");
+        }
+        address_ = reserved;
+    }
+
+    ~mirrored_mapping()
+    {
+        if(address_ != nullptr)
+            ::munmap(address_, 2 * size_);
+    }
+
+    mirrored_mapping(const mirrored_mapping&) = delete;
+    mirrored_mapping& operator = (const mirrored_mapping&) = delete;
+
+    mirrored_mapping(mirrored_mapping&& other) noexcept
+        : address_(std::exchange(other.address_, nullptr))
+        , size_(std::exchange(other.size_, 0))
+    {}
+
+    mirrored_mapping& operator = (mirrored_mapping&& other) noexcept
+    {
+        std::swap(address_, other.address_);
+        std::swap(size_, other.size_);
+        return *this;
+    }
+
+    void* address() const noexcept { return address_; }
+
+    // Of one half.
+    std::size_t size() const noexcept { return size_; }
+
+    static std::size_t page_size() noexcept
+    {
+        static const auto size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+        return size;
+    }
+
+private:
+    void* address_;
+    std::size_t size_;
+};
+
+}   // namespace detail
+
+/*
+    Circular buffer backed by two adjacent mappings of the same memory.
+
+    Slot i and slot i + capacity() share their storage, so the elements
+    are always one contiguous span [data(), data() + size()) starting at the head,
+    which can be handed to a decoder or to write(2) without linearizing.
+    Writes never have to wrap either.
+
+    The capacity is rounded up so that the storage fills whole pages.
+    Elements must be trivially copyable because every object is reachable through two addresses.
+    Linux only.
+*/
+template<typename T>
+class mirrored_circular_buffer final
+{
+    static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable.");
+
+public:
+    using value_type        = T;
+    using pointer           = value_type*;
+    using const_pointer     = const value_type*;
+    using reference         = value_type&;
+    using const_reference   = const value_type&;
+    using difference_type   = std::ptrdiff_t;
+    using size_type         = std::size_t;
+
+    // The elements are contiguous, so plain pointers serve as iterators.
+    using iterator          = pointer;
+    using const_iterator    = const_pointer;
+
+public:
+    mirrored_circular_buffer() = delete;
+
+    explicit mirrored_circular_buffer(size_type capacity)
+        : mapping_(round_up_capacity(capacity) * sizeof(value_type))
+        , array_(static_cast<pointer>(mapping_.address()))
+        , capacity_(mapping_.size() / sizeof(value_type))
+        , head_(0)
+        , contents_size_(0)
+    {
+        assert(capacity > 0);
+    }
+
+    ~mirrored_circular_buffer() = default;
+
+    mirrored_circular_buffer(const mirrored_circular_buffer&) = delete;
+    mirrored_circular_buffer& operator = (const mirrored_circular_buffer&) = delete;
+
+    mirrored_circular_buffer(mirrored_circular_buffer&& other) noexcept
+        : mapping_(std::move(other.mapping_))
+        , array_(std::exchange(other.array_, nullptr))
+        , capacity_(std::exchange(other.capacity_, 0))
+        , head_(std::exchange(other.head_, 0))
+        , contents_size_(std::exchange(other.contents_size_, 0))
+    {}
+
+    mirrored_circular_buffer& operator = (mirrored_circular_buffer&& other) noexcept
+    {
+        mapping_ = std::move(other.mapping_);
+        std::swap(array_, other.array_);
+        std::swap(capacity_, other.capacity_);
+        std::swap(head_, other.head_);
+        std::swap(contents_size_, other.contents_size_);
+        return *this;
+    }
+
+    reference operator[](size_type index) { assert(index < size()); return data()[index]; }
+    const_reference operator[](size_type index) const { assert(index < size()); return data()[index]; }
+
+    reference at(size_type index);
+    const_reference at(size_type index) const;
+
+    reference front() { assert(!is_empty()); return data()[0]; }
+    const_reference front() const { assert(!is_empty()); return data()[0]; }
+
+    reference back() { assert(!is_empty()); return data()[contents_size_ - 1]; }
+    const_reference back() const { assert(!is_empty()); return data()[contents_size_ - 1]; }
+
+    void clear() noexcept;
+
+    // Overwrites the oldest element when full.
+    void push_back(const_reference item);
+
+    // Appends only what fits into the free space and returns the number of elements appended.
+    size_type insert_back(const_pointer items, size_type count);
+
+    void pop_front();
+    void pop_front(size_type count);
+    void pop_back();
+
+    size_type head() const noexcept { return head_; }
+
+    size_type size() const noexcept { return contents_size_; }
+
+    bool is_empty() const noexcept { return contents_size_ == 0; }
+    bool is_full() const noexcept { return contents_size_ == capacity_; }
+
+    size_type capacity() const noexcept { return capacity_; }
+
+    // [data(), data() + size()) holds the elements in order.
+    pointer data() noexcept { return array_ + head_; }
+    const_pointer data() const noexcept { return array_ + head_; }
+
+    iterator begin() noexcept { return data(); }
+    const_iterator begin() const noexcept { return data(); }
+
+    iterator end() noexcept { return data() + contents_size_; }
+    const_iterator end() const noexcept { return data() + contents_size_; }
+
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+
+private:
+    static size_type round_up_capacity(size_type capacity);
+
+private:
+    detail::mirrored_mapping mapping_;
+    pointer array_;     // Valid for 2 * capacity_ elements.
+    size_type capacity_;
+    size_type head_;
+    size_type contents_size_;
+};
+
+// The smallest capacity >= the requested one whose storage is a whole number of pages.
+template<typename T>
+typename mirrored_circular_buffer<T>::size_type
+mirrored_circular_buffer<T>::round_up_capacity(size_type capacity)
+{
+    const auto page_size = detail::mirrored_mapping::page_size();
+    const auto granularity = page_size / std::gcd(page_size, sizeof(value_type));
+    return ((std::max<size_type>(capacity, 1) + granularity - 1) / granularity) * granularity;
+}
+
+template<typename T>
+typename mirrored_circular_buffer<T>::reference
+mirrored_circular_buffer<T>::at(size_type index)
+{
+    return const_cast<reference>(std::as_const(*this).at(index));
+}
+
+template<typename T>
+typename mirrored_circular_buffer<T>::const_reference
+mirrored_circular_buffer<T>::at(size_type index) const
+{
+    if(index >= size())
+        throw std::out_of_range("Index out of bounds.");
+    return (*this)[index];
+}
+
+template<typename T>
+void mirrored_circular_buffer<T>::clear() noexcept
+{
+    head_ = 0;
+    contents_size_ = 0;
+}
+
+template<typename T>
+void mirrored_circular_buffer<T>::push_back(const_reference item)
+{
+    // Never past the second half, so no wrap is needed.
+    data()[contents_size_] = item;
+    if(is_full())
+        pop_front();
+    ++contents_size_;
+}
+
+template<typename T>
+typename mirrored_circular_buffer<T>::size_type
+mirrored_circular_buffer<T>::insert_back(const_pointer items, size_type count)
+{
+    count = (std::min)(count, capacity_ - contents_size_);
+    if(count > 0)
+        std::memcpy(end(), items, count * sizeof(value_type));
+    contents_size_ += count;
+    return count;
+}
+
+template<typename T>
+void mirrored_circular_buffer<T>::pop_front()
+{
+    pop_front(1);
+}
+
+template<typename T>
+void mirrored_circular_buffer<T>::pop_front(size_type count)
+{
+    assert(count <= size());
+    head_ += count;
+    if(head_ >= capacity_)
+        head_ -= capacity_;
+    contents_size_ -= count;
+}
+
+template<typename T>
+void mirrored_circular_buffer<T>::pop_back()
+{
+    assert(!is_empty());
+    --contents_size_;
+}
+
+}   // namespace container
+#endif
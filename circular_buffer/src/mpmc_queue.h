@@ -0,0 +1,328 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <iterator>
+#include <new>
+#include <utility>
+#include <type_traits>
+#if defined(__has_include) && __has_include(<memory_resource>)
+#include <memory_resource>
+#endif
+#include "cache_line.h"
+#include "power_of_2.h"
+
+namespace container
+{
+
+/*
+    Bounded multi-producer/multi-consumer queue.
+
+    Every slot carries a sequence number that tells producers and consumers
+    whose turn it is, so there is no global lock and no shared size counter:
+    a thread contends only on the position it claims.
+
+    seq == pos                : free, the producer claiming pos may write it.
+    seq == pos + 1            : full, the consumer claiming pos may read it.
+    seq == pos + capacity()   : free again for the next lap.
+
+    The capacity is rounded up to a power of two.
+    Constructing or moving an element into or out of a claimed slot must not throw.
+
+    See: Dmitry Vyukov, "Bounded MPMC queue".
+*/
+template<typename T, typename Allocator = std::allocator<T>>
+class mpmc_queue final
+{
+public:
+    using value_type        = typename std::allocator_traits<Allocator>::value_type;
+    using pointer           = typename std::allocator_traits<Allocator>::pointer;
+    using const_pointer     = typename std::allocator_traits<Allocator>::const_pointer;
+    using reference         = value_type&;
+    using const_reference   = const value_type&;
+    using difference_type   = typename std::allocator_traits<Allocator>::difference_type;
+    using size_type         = typename std::allocator_traits<Allocator>::size_type;
+    using allocator_type    = Allocator;
+
+private:
+    struct cell
+    {
+        explicit cell(size_type seq) : sequence(seq) {}
+
+        value_type* data() noexcept { return std::launder(reinterpret_cast<value_type*>(&storage)); }
+
+        std::atomic<size_type> sequence;
+        alignas(value_type) unsigned char storage[sizeof(value_type)];
+    };
+
+    using allocator_traits = std::allocator_traits<Allocator>;
+    using cell_allocator_type = typename allocator_traits::template rebind_alloc<cell>;
+    using cell_allocator_traits = std::allocator_traits<cell_allocator_type>;
+    using signed_size_type = std::make_signed_t<size_type>;
+
+public:
+    mpmc_queue() = delete;
+
+    explicit mpmc_queue(size_type capacity, const Allocator& alloc = Allocator());
+    ~mpmc_queue();
+
+    mpmc_queue(const mpmc_queue&) = delete;
+    mpmc_queue& operator = (const mpmc_queue&) = delete;
+
+    mpmc_queue(mpmc_queue&&) = delete;
+    mpmc_queue& operator = (mpmc_queue&&) = delete;
+
+    template<typename U = T>
+    std::enable_if_t<std::is_copy_constructible<U>::value, bool>
+    try_push(const_reference item);
+
+    template<typename U = T>
+    std::enable_if_t<std::is_move_constructible<U>::value, bool>
+    try_push(value_type&& item);
+
+    template<typename... Args>
+    bool try_emplace(Args&&... args);
+
+    bool try_pop(reference item);
+
+    // Claims as many consecutive slots as are available, up to the given range,
+    // with a single compare-and-swap. Returns the number of elements pushed.
+    template<typename ForwardIt>
+    size_type try_push_bulk(ForwardIt first, ForwardIt last);
+
+    // Returns the number of elements written to out.
+    template<typename OutputIt>
+    size_type try_pop_bulk(OutputIt out, size_type max_count);
+
+    // Exact only when no other thread is pushing or popping.
+    size_type size() const noexcept;
+
+    bool is_empty() const noexcept { return size() == 0; }
+
+    size_type capacity() const noexcept { return mask_ + 1; }
+
+    allocator_type get_allocator() const noexcept { return alloc_; }
+
+private:
+    static signed_size_type distance(size_type from, size_type to) noexcept
+    {
+        return static_cast<signed_size_type>(to - from);
+    }
+
+    cell& cell_at(size_type pos) noexcept { return cells_[pos & mask_]; }
+
+private:
+    allocator_type alloc_;
+    cell* cells_;
+    size_type mask_;
+    alignas(detail::cache_line_size) std::atomic<size_type> enqueue_pos_;
+    alignas(detail::cache_line_size) std::atomic<size_type> dequeue_pos_;
+};
+
+template<typename T, typename Allocator>
+mpmc_queue<T, Allocator>::mpmc_queue(size_type capacity, const Allocator& alloc)
+    : alloc_(alloc)
+    , cells_(nullptr)
+    , mask_(detail::round_up_to_power_of_2(capacity) - 1)
+    , enqueue_pos_(0)
+    , dequeue_pos_(0)
+{
+    assert(capacity > 0);
+    cell_allocator_type cell_alloc(alloc_);
+    cells_ = cell_allocator_traits::allocate(cell_alloc, mask_ + 1);
+    for(size_type i = 0; i <= mask_; i++)
+        ::new(static_cast<void*>(cells_ + i)) cell(i);
+}
+
+template<typename T, typename Allocator>
+mpmc_queue<T, Allocator>::~mpmc_queue()
+{
+    const auto last = enqueue_pos_.load(std::memory_order_relaxed);
+    for(auto pos = dequeue_pos_.load(std::memory_order_relaxed); pos != last; pos++)
+        allocator_traits::destroy(alloc_, cell_at(pos).data());
+    for(size_type i = 0; i <= mask_; i++)
+        cells_[i].~cell();
+    cell_allocator_type cell_alloc(alloc_);
+    cell_allocator_traits::deallocate(cell_alloc, cells_, mask_ + 1);
+}
+
+template<typename T, typename Allocator>
+template<typename U>
+std::enable_if_t<std::is_copy_constructible<U>::value, bool>
+mpmc_queue<T, Allocator>::try_push(const_reference item)
+{
+    return try_emplace(item);
+}
+
+template<typename T, typename Allocator>
+template<typename U>
+std::enable_if_t<std::is_move_constructible<U>::value, bool>
+mpmc_queue<T, Allocator>::try_push(value_type&& item)
+{
+    return try_emplace(std::move(item));
+}
+
+template<typename T, typename Allocator>
+template<typename... Args>
+bool mpmc_queue<T, Allocator>::try_emplace(Args&&... args)
+{
+    auto pos = enqueue_pos_.load(std::memory_order_relaxed);
+    cell* target;
+    for(;;)
+    {
+        target = &cell_at(pos);
+        const auto diff = distance(pos, target->sequence.load(std::memory_order_acquire));
+        if(diff == 0)
+        {
+            if(enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if(diff < 0)
+        {   // The slot still holds an element from the previous lap.
+            return false;
+        }
+        else
+        {   // Another producer claimed pos.
+            pos = enqueue_pos_.load(std::memory_order_relaxed);
+        }
+    }
+    allocator_traits::construct(alloc_, target->data(), std::forward<Args>(args)...);
+    target->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+template<typename T, typename Allocator>
+bool mpmc_queue<T, Allocator>::try_pop(reference item)
+{
+    auto pos = dequeue_pos_.load(std::memory_order_relaxed);
+    cell* target;
+    for(;;)
+    {
+        target = &cell_at(pos);
+        const auto diff = distance(pos + 1, target->sequence.load(std::memory_order_acquire));
+        if(diff == 0)
+        {
+            if(dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if(diff < 0)
+        {   // Not written yet.
+            return false;
+        }
+        else
+        {   // Another consumer claimed pos.
+            pos = dequeue_pos_.load(std::memory_order_relaxed);
+        }
+    }
+    item = std::move(*target->data());
+    allocator_traits::destroy(alloc_, target->data());
+    target->sequence.store(pos + mask_ + 1, std::memory_order_release);
+    return true;
+}
+
+/*
+    Slots may be released out of order by other threads, so each slot of the run is checked.
+    Once the compare-and-swap succeeds the checked slots cannot change,
+    because any other thread would have to claim the same positions first.
+*/
+template<typename T, typename Allocator>
+template<typename ForwardIt>
+typename mpmc_queue<T, Allocator>::size_type
+mpmc_queue<T, Allocator>::try_push_bulk(ForwardIt first, ForwardIt last)
+{
+    const auto requested = static_cast<size_type>(std::distance(first, last));
+    if(requested == 0)
+        return 0;
+
+    auto pos = enqueue_pos_.load(std::memory_order_relaxed);
+    size_type count;
+    for(;;)
+    {
+        count = 0;
+        while(count < requested
+            && distance(pos + count, cell_at(pos + count).sequence.load(std::memory_order_acquire)) == 0)
+        {
+            count++;
+        }
+        if(count == 0)
+        {
+            if(distance(pos, cell_at(pos).sequence.load(std::memory_order_acquire)) < 0)
+                return 0;
+            pos = enqueue_pos_.load(std::memory_order_relaxed);
+            continue;
+        }
+        if(enqueue_pos_.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed))
+            break;
+    }
+
+    for(size_type i = 0; i < count; i++, ++first)
+    {
+        auto& target = cell_at(pos + i);
+        allocator_traits::construct(alloc_, target.data(), *first);
+        target.sequence.store(pos + i + 1, std::memory_order_release);
+    }
+    return count;
+}
+
+template<typename T, typename Allocator>
+template<typename OutputIt>
+typename mpmc_queue<T, Allocator>::size_type
+mpmc_queue<T, Allocator>::try_pop_bulk(OutputIt out, size_type max_count)
+{
+    if(max_count == 0)
+        return 0;
+
+    auto pos = dequeue_pos_.load(std::memory_order_relaxed);
+    size_type count;
+    for(;;)
+    {
+        count = 0;
+        while(count < max_count
+            && distance(pos + count + 1, cell_at(pos + count).sequence.load(std::memory_order_acquire)) == 0)
+        {
+            count++;
+        }
+        if(count == 0)
+        {
+            if(distance(pos + 1, cell_at(pos).sequence.load(std::memory_order_acquire)) < 0)
+                return 0;
+            pos = dequeue_pos_.load(std::memory_order_relaxed);
+            continue;
+        }
+        if(dequeue_pos_.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed))
+            break;
+    }
+
+    for(size_type i = 0; i < count; i++, ++out)
+    {
+        auto& target = cell_at(pos + i);
+        *out = std::move(*target.data());
+        allocator_traits::destroy(alloc_, target.data());
+        target.sequence.store(pos + i + mask_ + 1, std::memory_order_release);
+    }
+    return count;
+}
+
+template<typename T, typename Allocator>
+typename mpmc_queue<T, Allocator>::size_type
+mpmc_queue<T, Allocator>::size() const noexcept
+{
+    const auto dequeue_pos = dequeue_pos_.load(std::memory_order_acquire);
+    const auto enqueue_pos = enqueue_pos_.load(std::memory_order_acquire);
+    const auto diff = distance(dequeue_pos, enqueue_pos);
+    return (diff > 0)? static_cast<size_type>(diff) : 0;
+}
+
+#if defined(__has_include) && __has_include(<memory_resource>)
+namespace pmr
+{
+
+template<typename T>
+using mpmc_queue = container::mpmc_queue<T, std::pmr::polymorphic_allocator<T>>;
+
+}   // namespace pmr
+#endif
+
+}   // namespace container
@@ -0,0 +1,678 @@
+#pragma once
+#include <cassert>
+#include <cstdint>
+#include <algorithm>
+#include <memory>
+#include <iterator>
+#include <utility>
+#include <stdexcept>
+#include <type_traits>
+#if defined(__has_include) && __has_include(<memory_resource>)
+#include <memory_resource>
+#endif
+#include "power_of_2.h"
+
+namespace container
+{
+
+namespace detail
+{
+
+// Holds a free-running counter instead of a pointer, so stepping is an add and dereferencing a mask.
+template<typename CB, typename Traits>
+class pow2_circular_buffer_iterator
+{
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type        = typename Traits::value_type;
+    using pointer           = typename Traits::pointer;
+    using reference         = typename Traits::reference;
+    using difference_type   = typename Traits::difference_type;
+
+    pow2_circular_buffer_iterator()
+        : cb_(nullptr), pos_(0)
+    {}
+
+    pow2_circular_buffer_iterator(const CB* cb, std::uint64_t pos)
+        : cb_(cb), pos_(pos)
+    {}
+
+    reference operator * () const { return *operator -> (); }
+    pointer operator -> () const { return const_cast<pointer>(cb_->element_at(pos_)); }
+
+    pow2_circular_buffer_iterator& operator ++ () { ++pos_; return *this; }
+    pow2_circular_buffer_iterator operator ++ (int) { auto temp = *this; ++pos_; return temp; }
+
+    pow2_circular_buffer_iterator& operator -- () { --pos_; return *this; }
+    pow2_circular_buffer_iterator operator -- (int) { auto temp = *this; --pos_; return temp; }
+
+    difference_type operator - (const pow2_circular_buffer_iterator& rhs) const
+    {
+        return static_cast<difference_type>(pos_ - rhs.pos_);
+    }
+
+    reference operator [] (difference_type n) const { return *(*this + n); }
+
+    pow2_circular_buffer_iterator& operator += (difference_type n)
+    {
+        pos_ += static_cast<std::uint64_t>(n);
+        return *this;
+    }
+
+    pow2_circular_buffer_iterator operator + (difference_type n) const
+    {
+        return pow2_circular_buffer_iterator(*this) += n;
+    }
+
+    pow2_circular_buffer_iterator& operator -= (difference_type n)
+    {
+        pos_ -= static_cast<std::uint64_t>(n);
+        return *this;
+    }
+
+    pow2_circular_buffer_iterator operator - (difference_type n) const
+    {
+        return pow2_circular_buffer_iterator(*this) -= n;
+    }
+
+    bool operator == (const pow2_circular_buffer_iterator& rhs) const { return pos_ == rhs.pos_; }
+    bool operator != (const pow2_circular_buffer_iterator& rhs) const { return pos_ != rhs.pos_; }
+
+    // The counters may have wrapped, so they are compared by their distance.
+    bool operator < (const pow2_circular_buffer_iterator& rhs) const { return (*this - rhs) < 0; }
+    bool operator > (const pow2_circular_buffer_iterator& rhs) const { return rhs < *this; }
+    bool operator <= (const pow2_circular_buffer_iterator& rhs) const { return !(rhs < *this); }
+    bool operator >= (const pow2_circular_buffer_iterator& rhs) const { return !(*this < rhs); }
+
+private:
+    const CB* cb_;
+    std::uint64_t pos_;
+};
+
+template<typename CB, typename Traits>
+inline pow2_circular_buffer_iterator<CB, Traits>
+operator + (typename Traits::difference_type n, const pow2_circular_buffer_iterator<CB, Traits>& rhs)
+{
+    return rhs + n;
+}
+
+}   // namespace detail
+
+/*
+    Circular buffer whose capacity is rounded up to a power of two.
+
+    head_ and tail_ are free-running 64-bit counters that are never wrapped;
+    a slot is found by masking the counter, and the size is simply tail_ - head_.
+    This replaces the compare-and-branch wrap of circular_buffer with a bitwise and,
+    and makes an empty and a full buffer distinguishable without a size counter.
+
+    Otherwise it behaves like circular_buffer: pushing to a full buffer overwrites
+    the element at the opposite end.
+*/
+template<typename T, typename Allocator = std::allocator<T>>
+class pow2_circular_buffer final
+{
+public:
+    using self_type         = pow2_circular_buffer<T, Allocator>;
+    using value_type        = typename std::allocator_traits<Allocator>::value_type;
+    using pointer           = typename std::allocator_traits<Allocator>::pointer;
+    using const_pointer     = typename std::allocator_traits<Allocator>::const_pointer;
+    using reference         = value_type&;
+    using const_reference   = const value_type&;
+    using difference_type   = typename std::allocator_traits<Allocator>::difference_type;
+    using size_type         = typename std::allocator_traits<Allocator>::size_type;
+    using allocator_type    = Allocator;
+
+    using iterator = detail::pow2_circular_buffer_iterator<self_type, std::iterator_traits<pointer>>;
+    using const_iterator = detail::pow2_circular_buffer_iterator<self_type, std::iterator_traits<const_pointer>>;
+
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    using array_range_t = std::pair<pointer, size_type>;
+    using const_array_range_t = std::pair<const_pointer, size_type>;
+
+    friend iterator;
+    friend const_iterator;
+
+private:
+    using allocator_traits = std::allocator_traits<Allocator>;
+    using counter_type = std::uint64_t;
+
+public:
+    pow2_circular_buffer() = delete;
+
+    ~pow2_circular_buffer()
+    {
+        destroy_and_deallocate();
+    }
+
+    // The capacity is rounded up to a power of two.
+    explicit pow2_circular_buffer(size_type capacity, const Allocator& alloc = Allocator())
+        : alloc_(alloc)
+        , array_(nullptr)
+        , capacity_(detail::round_up_to_power_of_2(capacity))
+        , mask_(capacity_ - 1)
+        , head_(0)
+        , tail_(0)
+    {
+        assert(capacity > 0);
+        array_ = allocator_traits::allocate(alloc_, capacity_);
+    }
+
+    pow2_circular_buffer(const pow2_circular_buffer& other)
+        : pow2_circular_buffer(other, allocator_traits::select_on_container_copy_construction(other.alloc_))
+    {}
+
+    pow2_circular_buffer(const pow2_circular_buffer& other, const Allocator& alloc)
+        : alloc_(alloc)
+        , array_(nullptr)
+        , capacity_(0)
+        , mask_(0)
+        , head_(0)
+        , tail_(0)
+    {
+        copy_elements(other);
+    }
+
+    pow2_circular_buffer(pow2_circular_buffer&& other) noexcept
+        : alloc_(std::move(other.alloc_))
+        , array_(nullptr)
+        , capacity_(0)
+        , mask_(0)
+        , head_(0)
+        , tail_(0)
+    {
+        take_storage(other);
+    }
+
+    pow2_circular_buffer& operator = (const pow2_circular_buffer& other)
+    {
+        if(this != &other)
+        {
+            constexpr bool propagate = allocator_traits::propagate_on_container_copy_assignment::value;
+            pow2_circular_buffer temp(other, propagate? other.alloc_ : alloc_);
+            destroy_and_deallocate();
+            move_assign(temp, std::integral_constant<bool, propagate>());
+        }
+        return *this;
+    }
+
+    pow2_circular_buffer& operator = (pow2_circular_buffer&& other)
+        noexcept(allocator_traits::propagate_on_container_move_assignment::value
+            || allocator_traits::is_always_equal::value)
+    {
+        if(this != &other)
+        {
+            destroy_and_deallocate();
+            move_assign(other, typename allocator_traits::propagate_on_container_move_assignment());
+        }
+        return *this;
+    }
+
+    reference operator[](size_type index);
+    const_reference operator[](size_type index) const;
+
+    reference at(size_type index);
+    const_reference at(size_type index) const;
+
+    reference front();
+    const_reference front() const;
+
+    reference back();
+    const_reference back() const;
+
+    void clear();
+
+    // When full, these overwrite the element at the opposite end.
+    template<typename... Args>
+    reference emplace_front(Args&&... args);
+
+    template<typename... Args>
+    reference emplace_back(Args&&... args);
+
+    template<typename U = T>
+    std::enable_if_t<std::is_copy_constructible<U>::value, void>
+    push_front(const_reference item);
+
+    template<typename U = T>
+    std::enable_if_t<std::is_move_constructible<U>::value, void>
+    push_front(value_type&& item);
+
+    template<typename U = T>
+    std::enable_if_t<std::is_copy_constructible<U>::value, void>
+    push_back(const_reference item);
+
+    template<typename U = T>
+    std::enable_if_t<std::is_move_constructible<U>::value, void>
+    push_back(value_type&& item);
+
+    void pop_front();
+    void pop_back();
+
+    size_type head() const noexcept { return slot(head_); }
+    size_type tail() const noexcept { return slot(tail_); }
+
+    size_type size() const noexcept { return static_cast<size_type>(tail_ - head_); }
+    size_type max_size() const noexcept { return allocator_traits::max_size(alloc_); }
+
+    bool is_empty() const noexcept { return tail_ == head_; }
+    bool is_full() const noexcept { return size() == capacity(); }
+
+    size_type capacity() const noexcept { return capacity_; }
+
+    pointer data() noexcept { return array_; }
+    const_pointer data() const noexcept { return array_; }
+
+    array_range_t array_one();
+    const_array_range_t array_one() const;
+
+    array_range_t array_two();
+    const_array_range_t array_two() const;
+
+    iterator begin(){ return iterator(this, head_); }
+    const_iterator begin() const { return const_iterator(this, head_); }
+
+    iterator end(){ return iterator(this, tail_); }
+    const_iterator end() const { return const_iterator(this, tail_); }
+
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    reverse_iterator rbegin(){ return reverse_iterator(end()); }
+    const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+
+    reverse_iterator rend(){ return reverse_iterator(begin()); }
+    const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+    const_reverse_iterator crbegin() const { return rbegin(); }
+    const_reverse_iterator crend() const { return rend(); }
+
+    allocator_type get_allocator() const noexcept { return alloc_; }
+
+private:
+    size_type slot(counter_type counter) const noexcept { return static_cast<size_type>(counter) & mask_; }
+
+    void destroy_and_deallocate() noexcept;
+    void take_storage(pow2_circular_buffer& other) noexcept;
+    void move_assign(pow2_circular_buffer& other, std::true_type) noexcept;
+    void move_assign(pow2_circular_buffer& other, std::false_type);
+    void copy_elements(const pow2_circular_buffer& other);
+
+    // The slot must be free.
+    template<typename... Args>
+    void construct_front(Args&&... args);
+
+    template<typename... Args>
+    void construct_back(Args&&... args);
+
+    template<typename U>
+    void overwrite_front(U&& item, std::true_type);
+
+    template<typename U>
+    void overwrite_front(U&& item, std::false_type);
+
+    template<typename U>
+    void overwrite_back(U&& item, std::true_type);
+
+    template<typename U>
+    void overwrite_back(U&& item, std::false_type);
+
+    template<typename U>
+    void push_front_fwd(U&& item);
+
+    template<typename U>
+    void push_back_fwd(U&& item);
+
+    const_pointer element_at(counter_type counter) const noexcept { return array_ + slot(counter); }
+
+private:
+    allocator_type alloc_;
+    pointer array_;     // Uninitialized storage; only [head_, tail_) is alive.
+    size_type capacity_;
+    size_type mask_;
+    counter_type head_;
+    counter_type tail_;
+};
+
+template<typename T, typename Allocator>
+void pow2_circular_buffer<T, Allocator>::destroy_and_deallocate() noexcept
+{
+    clear();
+    if(array_ != nullptr)
+        allocator_traits::deallocate(alloc_, array_, capacity_);
+    array_ = nullptr;
+    capacity_ = 0;
+    mask_ = 0;
+    head_ = 0;
+    tail_ = 0;
+}
+
+template<typename T, typename Allocator>
+void pow2_circular_buffer<T, Allocator>::take_storage(pow2_circular_buffer& other) noexcept
+{
+    array_ = other.array_;
+    capacity_ = other.capacity_;
+    mask_ = other.mask_;
+    head_ = other.head_;
+    tail_ = other.tail_;
+
+    other.array_ = nullptr;
+    other.capacity_ = 0;
+    other.mask_ = 0;
+    other.head_ = 0;
+    other.tail_ = 0;
+}
+
+template<typename T, typename Allocator>
+void pow2_circular_buffer<T, Allocator>::move_assign(pow2_circular_buffer& other, std::true_type) noexcept
+{
+    alloc_ = std::move(other.alloc_);
+    take_storage(other);
+}
+
+template<typename T, typename Allocator>
+void pow2_circular_buffer<T, Allocator>::move_assign(pow2_circular_buffer& other, std::false_type)
+{
+    if(alloc_ == other.alloc_)
+    {
+        take_storage(other);
+    }
+    else if(other.capacity_ > 0)
+    {   // When both allocators are different; a moved-from buffer leaves this one without storage.
+        pow2_circular_buffer temp(other.capacity(), alloc_);
+        for(auto& item : other)
+            temp.construct_back(std::move_if_noexcept(item));
+        other.destroy_and_deallocate();
+        take_storage(temp);
+    }
+}
+
+// Keeps the elements at the same slots as in other.
+template<typename T, typename Allocator>
+void pow2_circular_buffer<T, Allocator>::copy_elements(const pow2_circular_buffer& other)
+{
+    if(other.array_ == nullptr)
+        return;
+    array_ = allocator_traits::allocate(alloc_, other.capacity_);
+    capacity_ = other.capacity_;
+    mask_ = other.mask_;
+    head_ = other.slot(other.head_);
+    tail_ = head_;
+    try
+    {
+        for(const auto& item : other)
+            construct_back(item);
+    }
+    catch(...)
+    {
+        destroy_and_deallocate();
+        throw;
+    }
+}
+
+template<typename T, typename Allocator>
+typename pow2_circular_buffer<T, Allocator>::reference
+pow2_circular_buffer<T, Allocator>::operator[](size_type index)
+{
+    return const_cast<reference>(std::as_const(*this).operator[](index));
+}
+
+template<typename T, typename Allocator>
+typename pow2_circular_buffer<T, Allocator>::const_reference
+pow2_circular_buffer<T, Allocator>::operator[](size_type index) const
+{
+    assert(!is_empty());
+    assert(index < size());
+    return array_[slot(head_ + index)];
+}
+
+template<typename T, typename Allocator>
+typename pow2_circular_buffer<T, Allocator>::reference
+pow2_circular_buffer<T, Allocator>::at(size_type index)
+{
+    return const_cast<reference>(std::as_const(*this).at(index));
+}
+
+template<typename T, typename Allocator>
+typename pow2_circular_buffer<T, Allocator>::const_reference
+pow2_circular_buffer<T, Allocator>::at(size_type index) const
+{
+    if(index >= size())
+        throw std::out_of_range("Index out of bounds.");
+    return (*this)[index];
+}
+
+template<typename T, typename Allocator>
+typename pow2_circular_buffer<T, Allocator>::reference
+pow2_circular_buffer<T, Allocator>::front()
+{
+    return const_cast<reference>(std::as_const(*this).front());
+}
+
+template<typename T, typename Allocator>
+typename pow2_circular_buffer<T, Allocator>::const_reference
+pow2_circular_buffer<T, Allocator>::front() const
+{
+    assert(!is_empty());
+    return array_[slot(head_)];
+}
+
+template<typename T, typename Allocator>
+typename pow2_circular_buffer<T, Allocator>::reference
+pow2_circular_buffer<T, Allocator>::back()
+{
+    return const_cast<reference>(std::as_const(*this).back());
+}
+
+template<typename T, typename Allocator>
+typename pow2_circular_buffer<T, Allocator>::const_reference
+pow2_circular_buffer<T, Allocator>::back() const
+{
+    assert(!is_empty());
+    return array_[slot(tail_ - 1)];
+}
+
+template<typename T, typename Allocator>
+void pow2_circular_buffer<T, Allocator>::clear()
+{
+    if(!std::is_trivially_destructible<value_type>::value)
+    {
+        for(auto counter = head_; counter != tail_; ++counter)
+            allocator_traits::destroy(alloc_, array_ + slot(counter));
+    }
+    head_ = tail_;
+}
+
+template<typename T, typename Allocator>
+template<typename... Args>
+void pow2_circular_buffer<T, Allocator>::construct_front(Args&&... args)
+{
+    assert(!is_full());
+    allocator_traits::construct(alloc_, array_ + slot(head_ - 1), std::forward<Args>(args)...);
+    --head_;
+}
+
+template<typename T, typename Allocator>
+template<typename... Args>
+void pow2_circular_buffer<T, Allocator>::construct_back(Args&&... args)
+{
+    assert(!is_full());
+    allocator_traits::construct(alloc_, array_ + slot(tail_), std::forward<Args>(args)...);
+    ++tail_;
+}
+
+// Full buffer, assignable element: the back element is reused in place.
+template<typename T, typename Allocator>
+template<typename U>
+void pow2_circular_buffer<T, Allocator>::overwrite_front(U&& item, std::true_type)
+{
+    array_[slot(head_ - 1)] = std::forward<U>(item);
+    --head_;
+    --tail_;
+}
+
+// Full buffer, non-assignable element: the item is built first because it may refer to the evicted element.
+template<typename T, typename Allocator>
+template<typename U>
+void pow2_circular_buffer<T, Allocator>::overwrite_front(U&& item, std::false_type)
+{
+    value_type temp(std::forward<U>(item));
+    pop_back();
+    construct_front(std::move(temp));
+}
+
+template<typename T, typename Allocator>
+template<typename U>
+void pow2_circular_buffer<T, Allocator>::overwrite_back(U&& item, std::true_type)
+{
+    array_[slot(tail_)] = std::forward<U>(item);
+    ++tail_;
+    ++head_;
+}
+
+template<typename T, typename Allocator>
+template<typename U>
+void pow2_circular_buffer<T, Allocator>::overwrite_back(U&& item, std::false_type)
+{
+    value_type temp(std::forward<U>(item));
+    pop_front();
+    construct_back(std::move(temp));
+}
+
+template<typename T, typename Allocator>
+template<typename... Args>
+typename pow2_circular_buffer<T, Allocator>::reference
+pow2_circular_buffer<T, Allocator>::emplace_front(Args&&... args)
+{
+    if(is_full())
+        overwrite_front(value_type(std::forward<Args>(args)...), std::is_move_assignable<value_type>());
+    else
+        construct_front(std::forward<Args>(args)...);
+    return front();
+}
+
+template<typename T, typename Allocator>
+template<typename... Args>
+typename pow2_circular_buffer<T, Allocator>::reference
+pow2_circular_buffer<T, Allocator>::emplace_back(Args&&... args)
+{
+    if(is_full())
+        overwrite_back(value_type(std::forward<Args>(args)...), std::is_move_assignable<value_type>());
+    else
+        construct_back(std::forward<Args>(args)...);
+    return back();
+}
+
+template<typename T, typename Allocator>
+template<typename U>
+std::enable_if_t<std::is_copy_constructible<U>::value, void>
+pow2_circular_buffer<T, Allocator>::push_front(const_reference item)
+{
+    push_front_fwd(item);
+}
+
+template<typename T, typename Allocator>
+template<typename U>
+std::enable_if_t<std::is_move_constructible<U>::value, void>
+pow2_circular_buffer<T, Allocator>::push_front(value_type&& item)
+{
+    push_front_fwd(std::move(item));
+}
+
+template<typename T, typename Allocator>
+template<typename U>
+std::enable_if_t<std::is_copy_constructible<U>::value, void>
+pow2_circular_buffer<T, Allocator>::push_back(const_reference item)
+{
+    push_back_fwd(item);
+}
+
+template<typename T, typename Allocator>
+template<typename U>
+std::enable_if_t<std::is_move_constructible<U>::value, void>
+pow2_circular_buffer<T, Allocator>::push_back(value_type&& item)
+{
+    push_back_fwd(std::move(item));
+}
+
+template<typename T, typename Allocator>
+template<typename U>
+void pow2_circular_buffer<T, Allocator>::push_front_fwd(U&& item)
+{
+    if(is_full())
+        overwrite_front(std::forward<U>(item), std::is_assignable<reference, U&&>());
+    else
+        construct_front(std::forward<U>(item));
+}
+
+template<typename T, typename Allocator>
+template<typename U>
+void pow2_circular_buffer<T, Allocator>::push_back_fwd(U&& item)
+{
+    if(is_full())
+        overwrite_back(std::forward<U>(item), std::is_assignable<reference, U&&>());
+    else
+        construct_back(std::forward<U>(item));
+}
+
+template<typename T, typename Allocator>
+void pow2_circular_buffer<T, Allocator>::pop_front()
+{
+    assert(!is_empty());
+    allocator_traits::destroy(alloc_, array_ + slot(head_));
+    ++head_;
+}
+
+template<typename T, typename Allocator>
+void pow2_circular_buffer<T, Allocator>::pop_back()
+{
+    assert(!is_empty());
+    --tail_;
+    allocator_traits::destroy(alloc_, array_ + slot(tail_));
+}
+
+template<typename T, typename Allocator>
+typename pow2_circular_buffer<T, Allocator>::array_range_t
+pow2_circular_buffer<T, Allocator>::array_one()
+{
+    const auto range = std::as_const(*this).array_one();
+    return std::make_pair(const_cast<pointer>(range.first), range.second);
+}
+
+template<typename T, typename Allocator>
+typename pow2_circular_buffer<T, Allocator>::const_array_range_t
+pow2_circular_buffer<T, Allocator>::array_one() const
+{
+    assert(!is_empty());
+    const auto head = slot(head_);
+    return std::make_pair(array_ + head, (std::min)(size(), capacity() - head));
+}
+
+template<typename T, typename Allocator>
+typename pow2_circular_buffer<T, Allocator>::array_range_t
+pow2_circular_buffer<T, Allocator>::array_two()
+{
+    const auto range = std::as_const(*this).array_two();
+    return std::make_pair(const_cast<pointer>(range.first), range.second);
+}
+
+template<typename T, typename Allocator>
+typename pow2_circular_buffer<T, Allocator>::const_array_range_t
+pow2_circular_buffer<T, Allocator>::array_two() const
+{
+    assert(!is_empty());
+    return std::make_pair(array_, size() - array_one().second);
+}
+
+#if defined(__has_include) && __has_include(<memory_resource>)
+namespace pmr
+{
+
+template<typename T>
+using pow2_circular_buffer = container::pow2_circular_buffer<T, std::pmr::polymorphic_allocator<T>>;
+
+}   // namespace pmr
+#endif
+
+}   // namespace container
@@ -0,0 +1,30 @@
+#pragma once
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+namespace container
+{
+
+namespace detail
+{
+
+// The smallest power of 2 that is not less than x, and 1 for 0.
+// Throws std::length_error when that power does not fit into Size.
+template<typename Size>
+Size round_up_to_power_of_2(Size x)
+{
+    static_assert(std::is_unsigned<Size>::value, "Size must be an unsigned type.");
+    constexpr auto largest = Size(1) << (std::numeric_limits<Size>::digits - 1);
+    if(x > largest)
+        throw std::length_error("The capacity does not fit into a power of 2.");
+
+    Size result = 1;
+    while(result < x)
+        result <<= 1;
+    return result;
+}
+
+}   // namespace detail
+
+}   // namespace container
@@ -0,0 +1,444 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <utility>
+#include <type_traits>
+#if defined(__has_include) && __has_include(<memory_resource>)
+#include <memory_resource>
+#endif
+#include "alignment.h"
+
+namespace container
+{
+
+namespace detail
+{
+
+// The unit of storage; every record header starts on a block boundary.
+struct alignas(std::max_align_t) record_block
+{
+    unsigned char bytes[alignof(std::max_align_t)];
+};
+
+}   // namespace detail
+
+/*
+    Ring of variable-length byte records, stored inline.
+
+    Each record is a header holding its length, followed by the payload,
+    both aligned to record_alignment, so records of any size share one byte array
+    and a payload can hold any object that needs no more than max_align_t alignment.
+
+    A record never wraps: when it does not fit between the tail and the end of the storage,
+    the rest of the storage is marked as skipped and the record starts over at the beginning.
+    Pushing and popping are O(1) and never allocate. A full ring rejects the record.
+
+    reserve_back() / commit_back() let the producer write the payload in place.
+*/
+template<typename Allocator = std::allocator<unsigned char>>
+class basic_record_ring final
+{
+public:
+    using size_type         = std::size_t;
+    using allocator_type    = Allocator;
+
+    // Payload and its length.
+    using record_type = std::pair<const unsigned char*, size_type>;
+
+    class const_iterator;
+
+    static constexpr size_type record_alignment = alignof(std::max_align_t);
+
+private:
+    struct header
+    {
+        std::uint32_t size;     // The payload, or the skipped bytes for a skip marker.
+        std::uint32_t skip;
+    };
+
+    static_assert(alignment::is_power_of_2(record_alignment), "record_alignment must be a power of 2.");
+    static_assert(sizeof(header) <= record_alignment, "The header must fit into one block.");
+
+    // The payload starts one block after its header.
+    static constexpr size_type header_size = record_alignment;
+
+    using block_type = detail::record_block;
+    using block_allocator_type = typename std::allocator_traits<Allocator>::template rebind_alloc<block_type>;
+    using block_allocator_traits = std::allocator_traits<block_allocator_type>;
+    using allocator_traits = std::allocator_traits<Allocator>;
+
+public:
+    basic_record_ring() = delete;
+
+    // capacity is in bytes and is rounded up to a multiple of record_alignment,
+    // with room for at least one header and one block of payload.
+    explicit basic_record_ring(size_type capacity, const Allocator& alloc = Allocator());
+    ~basic_record_ring();
+
+    basic_record_ring(const basic_record_ring&) = delete;
+    basic_record_ring& operator = (const basic_record_ring&) = delete;
+
+    basic_record_ring(basic_record_ring&& other) noexcept;
+
+    // The storage is taken over when the allocator propagates or compares equal; otherwise the bytes are copied.
+    // Either way, other is left without storage.
+    basic_record_ring& operator = (basic_record_ring&& other)
+        noexcept(allocator_traits::propagate_on_container_move_assignment::value
+            || allocator_traits::is_always_equal::value);
+
+    // Space for a payload of up to size bytes, aligned to record_alignment, or nullptr when it does not fit.
+    // Nothing changes until commit_back().
+    void* reserve_back(size_type size);
+
+    // Appends the record written by the last reserve_back(), whose payload is size bytes long.
+    void commit_back(size_type size);
+
+    // Returns false when the record does not fit.
+    bool try_push_back(const void* data, size_type size);
+
+    record_type front() const;
+    void pop_front();
+
+    void clear() noexcept;
+
+    const_iterator begin() const noexcept { return const_iterator(this, head_, used_); }
+    const_iterator end() const noexcept { return const_iterator(this, tail_, 0); }
+
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+
+    // The number of records.
+    size_type size() const noexcept { return count_; }
+
+    // The bytes taken by headers, payloads, alignment and skipped space.
+    size_type used_bytes() const noexcept { return used_; }
+
+    bool is_empty() const noexcept { return count_ == 0; }
+
+    // In bytes.
+    size_type capacity() const noexcept { return capacity_; }
+
+    // The largest payload that fits into an empty ring.
+    size_type max_record_size() const noexcept { return capacity_ - header_size; }
+
+    // The bytes a record with a payload of size bytes takes.
+    static size_type footprint(size_type size) noexcept
+    {
+        return header_size + alignment::align_up(size, record_alignment);
+    }
+
+    allocator_type get_allocator() const noexcept { return alloc_; }
+
+private:
+    unsigned char* bytes() const noexcept { return reinterpret_cast<unsigned char*>(blocks_); }
+
+    const header& header_at(size_type offset) const noexcept
+    {
+        return *std::launder(reinterpret_cast<const header*>(bytes() + offset));
+    }
+
+    void write_header(size_type offset, size_type size, bool skip) noexcept
+    {
+        ::new(static_cast<void*>(bytes() + offset)) header{ static_cast<std::uint32_t>(size), skip? 1u : 0u };
+    }
+
+    size_type next_offset(size_type offset, size_type size) const noexcept
+    {
+        offset += footprint(size);
+        return (offset < capacity_)? offset : 0;
+    }
+
+    void deallocate() noexcept;
+    void take_storage(basic_record_ring& other) noexcept;
+    void move_assign(basic_record_ring& other, std::true_type) noexcept;
+    void move_assign(basic_record_ring& other, std::false_type);
+
+private:
+    allocator_type alloc_;
+    block_type* blocks_;
+    size_type capacity_;
+    size_type head_;
+    size_type tail_;
+    size_type used_;
+    size_type count_;
+    size_type reserved_offset_;     // Where the last reserve_back() put the header.
+    size_type reserved_size_;
+};
+
+using record_ring = basic_record_ring<>;
+
+// Visits the records from the oldest, stepping over the skipped space.
+template<typename Allocator>
+class basic_record_ring<Allocator>::const_iterator final
+{
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = record_type;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = const record_type*;
+    using reference         = record_type;
+
+    const_iterator() noexcept
+        : ring_(nullptr), offset_(0), remaining_(0)
+    {}
+
+    reference operator*() const
+    {
+        assert(remaining_ > 0);
+        return std::make_pair(ring_->bytes() + offset_ + header_size, ring_->header_at(offset_).size);
+    }
+
+    const_iterator& operator++()
+    {
+        assert(remaining_ > 0);
+        const auto size = ring_->header_at(offset_).size;
+        remaining_ -= footprint(size);
+        offset_ = ring_->next_offset(offset_, size);
+        if((remaining_ > 0) && ring_->header_at(offset_).skip)
+        {
+            remaining_ -= ring_->capacity_ - offset_;
+            offset_ = 0;
+        }
+        return *this;
+    }
+
+    const_iterator operator++(int)
+    {
+        auto temp = *this;
+        ++*this;
+        return temp;
+    }
+
+    bool operator == (const const_iterator& other) const noexcept { return remaining_ == other.remaining_; }
+    bool operator != (const const_iterator& other) const noexcept { return !(*this == other); }
+
+private:
+    friend class basic_record_ring;
+
+    const_iterator(const basic_record_ring* ring, size_type offset, size_type remaining) noexcept
+        : ring_(ring), offset_(offset), remaining_(remaining)
+    {}
+
+private:
+    const basic_record_ring* ring_;
+    size_type offset_;
+    size_type remaining_;   // Bytes from offset_ to the tail.
+};
+
+template<typename Allocator>
+basic_record_ring<Allocator>::basic_record_ring(size_type capacity, const Allocator& alloc)
+    : alloc_(alloc)
+    , blocks_(nullptr)
+    , capacity_(alignment::align_up((std::max)(capacity, 2 * header_size), record_alignment))
+    , head_(0)
+    , tail_(0)
+    , used_(0)
+    , count_(0)
+    , reserved_offset_(0)
+    , reserved_size_(0)
+{
+    assert(capacity > 0);
+    block_allocator_type block_alloc(alloc_);
+    blocks_ = block_allocator_traits::allocate(block_alloc, capacity_ / record_alignment);
+}
+
+template<typename Allocator>
+basic_record_ring<Allocator>::~basic_record_ring()
+{
+    deallocate();
+}
+
+template<typename Allocator>
+basic_record_ring<Allocator>::basic_record_ring(basic_record_ring&& other) noexcept
+    : alloc_(std::move(other.alloc_))
+    , blocks_(std::exchange(other.blocks_, nullptr))
+    , capacity_(std::exchange(other.capacity_, 0))
+    , head_(std::exchange(other.head_, 0))
+    , tail_(std::exchange(other.tail_, 0))
+    , used_(std::exchange(other.used_, 0))
+    , count_(std::exchange(other.count_, 0))
+    , reserved_offset_(std::exchange(other.reserved_offset_, 0))
+    , reserved_size_(std::exchange(other.reserved_size_, 0))
+{}
+
+template<typename Allocator>
+basic_record_ring<Allocator>& basic_record_ring<Allocator>::operator = (basic_record_ring&& other)
+    noexcept(allocator_traits::propagate_on_container_move_assignment::value
+        || allocator_traits::is_always_equal::value)
+{
+    if(this != &other)
+    {
+        deallocate();
+        move_assign(other, typename allocator_traits::propagate_on_container_move_assignment());
+    }
+    return *this;
+}
+
+// Leaves the ring without storage.
+template<typename Allocator>
+void basic_record_ring<Allocator>::deallocate() noexcept
+{
+    if(blocks_ != nullptr)
+    {
+        block_allocator_type block_alloc(alloc_);
+        block_allocator_traits::deallocate(block_alloc, blocks_, capacity_ / record_alignment);
+    }
+    blocks_ = nullptr;
+    capacity_ = 0;
+    clear();
+    reserved_offset_ = 0;
+    reserved_size_ = 0;
+}
+
+template<typename Allocator>
+void basic_record_ring<Allocator>::take_storage(basic_record_ring& other) noexcept
+{
+    blocks_ = std::exchange(other.blocks_, nullptr);
+    capacity_ = std::exchange(other.capacity_, 0);
+    head_ = std::exchange(other.head_, 0);
+    tail_ = std::exchange(other.tail_, 0);
+    used_ = std::exchange(other.used_, 0);
+    count_ = std::exchange(other.count_, 0);
+    reserved_offset_ = std::exchange(other.reserved_offset_, 0);
+    reserved_size_ = std::exchange(other.reserved_size_, 0);
+}
+
+template<typename Allocator>
+void basic_record_ring<Allocator>::move_assign(basic_record_ring& other, std::true_type) noexcept
+{
+    alloc_ = std::move(other.alloc_);
+    take_storage(other);
+}
+
+template<typename Allocator>
+void basic_record_ring<Allocator>::move_assign(basic_record_ring& other, std::false_type)
+{
+    if(alloc_ == other.alloc_)
+    {
+        take_storage(other);
+    }
+    else if(other.capacity_ > 0)
+    {   // When both allocators are different, the blocks are copied as they are, so the offsets stay valid.
+        block_allocator_type block_alloc(alloc_);
+        blocks_ = block_allocator_traits::allocate(block_alloc, other.capacity_ / record_alignment);
+        std::memcpy(bytes(), other.bytes(), other.capacity_);
+        capacity_ = other.capacity_;
+        head_ = other.head_;
+        tail_ = other.tail_;
+        used_ = other.used_;
+        count_ = other.count_;
+        other.deallocate();
+    }
+}
+
+template<typename Allocator>
+void* basic_record_ring<Allocator>::reserve_back(size_type size)
+{
+    if(size > max_record_size() || size > (std::numeric_limits<std::uint32_t>::max)())
+        return nullptr;
+    if(used_ == 0)
+        head_ = tail_ = 0;
+
+    const auto bytes_needed = footprint(size);
+    const auto free_bytes = capacity_ - used_;
+    const auto to_end = capacity_ - tail_;
+    if((bytes_needed <= free_bytes) && (bytes_needed <= to_end))
+    {
+        reserved_offset_ = tail_;
+    }
+    else if((tail_ >= head_) && (to_end + bytes_needed <= free_bytes))
+    {   // When the free space continues at the beginning and the record fits there.
+        reserved_offset_ = 0;
+    }
+    else
+    {
+        return nullptr;
+    }
+    reserved_size_ = size;
+
+    auto payload = bytes() + reserved_offset_ + header_size;
+    assert(alignment::is_aligned(payload, record_alignment));
+    return payload;
+}
+
+template<typename Allocator>
+void basic_record_ring<Allocator>::commit_back(size_type size)
+{
+    assert(size <= reserved_size_);
+    if(reserved_offset_ != tail_)
+    {   // The record starts over at the beginning.
+        assert(reserved_offset_ == 0);
+        write_header(tail_, capacity_ - tail_, true);
+        used_ += capacity_ - tail_;
+        tail_ = 0;
+    }
+    write_header(tail_, size, false);
+    used_ += footprint(size);
+    tail_ = next_offset(tail_, size);
+    ++count_;
+    reserved_size_ = 0;
+}
+
+template<typename Allocator>
+bool basic_record_ring<Allocator>::try_push_back(const void* data, size_type size)
+{
+    auto payload = reserve_back(size);
+    if(payload == nullptr)
+        return false;
+    if(size > 0)
+        std::memcpy(payload, data, size);
+    commit_back(size);
+    return true;
+}
+
+template<typename Allocator>
+typename basic_record_ring<Allocator>::record_type
+basic_record_ring<Allocator>::front() const
+{
+    assert(!is_empty());
+    return *begin();
+}
+
+template<typename Allocator>
+void basic_record_ring<Allocator>::pop_front()
+{
+    assert(!is_empty());
+    const auto size = header_at(head_).size;
+    used_ -= footprint(size);
+    head_ = next_offset(head_, size);
+    --count_;
+    if((used_ > 0) && header_at(head_).skip)
+    {
+        used_ -= capacity_ - head_;
+        head_ = 0;
+    }
+    if(used_ == 0)
+        head_ = tail_ = 0;
+}
+
+template<typename Allocator>
+void basic_record_ring<Allocator>::clear() noexcept
+{
+    head_ = 0;
+    tail_ = 0;
+    used_ = 0;
+    count_ = 0;
+}
+
+#if defined(__has_include) && __has_include(<memory_resource>)
+namespace pmr
+{
+
+using record_ring = container::basic_record_ring<std::pmr::polymorphic_allocator<unsigned char>>;
+
+}   // namespace pmr
+#endif
+
+}   // namespace container
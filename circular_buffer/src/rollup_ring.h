@@ -0,0 +1,204 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <utility>
+#include <iterator>
+#include <optional>
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+#if defined(__has_include) && __has_include(<memory_resource>)
+#include <memory_resource>
+#endif
+#include "circular_buffer.h"
+
+namespace container
+{
+
+/*
+    Time series kept at several resolutions in bounded memory.
+
+    Each tier is a circular_buffer of buckets of a fixed width. A value is folded into the
+    newest bucket of the finest tier, or starts a new bucket there. When a full tier has to
+    start a bucket, it evicts its oldest bucket and folds it into the next coarser tier the same way;
+    the coarsest tier drops it. Every push therefore costs O(number of tiers).
+
+    A coarser tier only ever holds data older than a finer one, so visiting the tiers from the
+    coarsest to the finest yields the buckets in time order, which is how queries merge them.
+
+    Times must not decrease, and each resolution must be a multiple of the previous one.
+    Aggregate combines two values: value_type(const value_type&, const value_type&).
+*/
+template<typename T, typename Aggregate = std::plus<T>, typename Allocator = std::allocator<T>>
+class rollup_ring final
+{
+public:
+    using value_type        = T;
+    using size_type         = std::size_t;
+    using time_type         = std::int64_t;
+    using aggregate_type    = Aggregate;
+    using allocator_type    = Allocator;
+
+    struct tier_spec
+    {
+        time_type resolution;   // Width of a bucket.
+        size_type capacity;     // Number of buckets.
+    };
+
+    struct bucket
+    {
+        time_type start;        // A multiple of the tier's resolution.
+        value_type value;
+    };
+
+private:
+    using bucket_allocator_type = typename std::allocator_traits<Allocator>::template rebind_alloc<bucket>;
+
+public:
+    using tier_type = circular_buffer<bucket, bucket_allocator_type>;
+
+public:
+    rollup_ring() = delete;
+
+    explicit rollup_ring(std::initializer_list<tier_spec> tiers, const Aggregate& aggregate = Aggregate(), const Allocator& alloc = Allocator());
+
+    void push(time_type time, const value_type& value);
+
+    // Calls f(bucket, tier index) for every bucket that overlaps [from, to), oldest first.
+    template<typename F>
+    void for_each(time_type from, time_type to, F f) const;
+
+    // The aggregate of the buckets that overlap [from, to), or nothing when there are none.
+    // A bucket counts as a whole, so the range is widened to bucket boundaries at both ends.
+    std::optional<value_type> query(time_type from, time_type to) const;
+
+    void clear();
+
+    size_type tier_count() const noexcept { return tiers_.size(); }
+
+    // Index 0 is the finest tier.
+    const tier_type& tier(size_type index) const { return tiers_[index].buckets; }
+    time_type resolution(size_type index) const { return tiers_[index].resolution; }
+
+private:
+    struct tier_entry
+    {
+        time_type resolution;
+        tier_type buckets;
+    };
+
+    using tier_allocator_type = typename std::allocator_traits<Allocator>::template rebind_alloc<tier_entry>;
+
+    static time_type floor_to(time_type time, time_type resolution) noexcept;
+
+private:
+    std::vector<tier_entry, tier_allocator_type> tiers_;
+    Aggregate aggregate_;
+};
+
+template<typename T, typename Aggregate, typename Allocator>
+rollup_ring<T, Aggregate, Allocator>::rollup_ring(std::initializer_list<tier_spec> tiers, const Aggregate& aggregate, const Allocator& alloc)
+    : tiers_(tier_allocator_type(alloc))
+    , aggregate_(aggregate)
+{
+    assert(tiers.size() > 0);
+    tiers_.reserve(tiers.size());
+    for(const auto& spec : tiers)
+    {
+        assert(spec.resolution > 0);
+        assert(tiers_.empty() || (spec.resolution % tiers_.back().resolution == 0));
+        tiers_.push_back(tier_entry{ spec.resolution, tier_type(spec.capacity, bucket_allocator_type(alloc)) });
+    }
+}
+
+template<typename T, typename Aggregate, typename Allocator>
+typename rollup_ring<T, Aggregate, Allocator>::time_type
+rollup_ring<T, Aggregate, Allocator>::floor_to(time_type time, time_type resolution) noexcept
+{
+    const auto remainder = time % resolution;
+    return time - ((remainder < 0)? remainder + resolution : remainder);
+}
+
+template<typename T, typename Aggregate, typename Allocator>
+void rollup_ring<T, Aggregate, Allocator>::push(time_type time, const value_type& value)
+{
+    bucket item{ time, value };
+    for(auto& entry : tiers_)
+    {
+        auto& buckets = entry.buckets;
+        const auto start = floor_to(item.start, entry.resolution);
+        if(!buckets.is_empty() && (buckets.back().start == start))
+        {
+            buckets.back().value = aggregate_(buckets.back().value, item.value);
+            return;
+        }
+        assert(buckets.is_empty() || (buckets.back().start < start));
+
+        if(!buckets.is_full())
+        {
+            buckets.push_back(bucket{ start, std::move(item.value) });
+            return;
+        }
+
+        // Make room, then carry the evicted bucket on to the next tier.
+        bucket evicted = std::move(buckets.front());
+        buckets.pop_front();
+        buckets.push_back(bucket{ start, std::move(item.value) });
+        item = std::move(evicted);
+    }
+}
+
+template<typename T, typename Aggregate, typename Allocator>
+template<typename F>
+void rollup_ring<T, Aggregate, Allocator>::for_each(time_type from, time_type to, F f) const
+{
+    const auto by_start = [](const bucket& b, time_type time) { return b.start < time; };
+    for(auto index = tiers_.size(); index-- > 0;)
+    {
+        const auto& buckets = tiers_[index].buckets;
+        auto first = std::lower_bound(buckets.begin(), buckets.end(), from, by_start);
+        // Only the bucket just before from can reach into the range.
+        if((first != buckets.begin()) && (from - std::prev(first)->start < tiers_[index].resolution))
+            --first;
+        const auto last = std::lower_bound(first, buckets.end(), to, by_start);
+        for(; first != last; ++first)
+            f(*first, index);
+    }
+}
+
+template<typename T, typename Aggregate, typename Allocator>
+std::optional<typename rollup_ring<T, Aggregate, Allocator>::value_type>
+rollup_ring<T, Aggregate, Allocator>::query(time_type from, time_type to) const
+{
+    std::optional<value_type> result;
+    for_each(from, to, [this, &result](const bucket& b, size_type)
+    {
+        if(result)
+            result = aggregate_(*result, b.value);
+        else
+            result = b.value;
+    });
+    return result;
+}
+
+template<typename T, typename Aggregate, typename Allocator>
+void rollup_ring<T, Aggregate, Allocator>::clear()
+{
+    for(auto& entry : tiers_)
+        entry.buckets.clear();
+}
+
+#if defined(__has_include) && __has_include(<memory_resource>)
+namespace pmr
+{
+
+template<typename T, typename Aggregate = std::plus<T>>
+using rollup_ring = container::rollup_ring<T, Aggregate, std::pmr::polymorphic_allocator<T>>;
+
+}   // namespace pmr
+#endif
+
+}   // namespace container
@@ -0,0 +1,254 @@
+#pragma once
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <type_traits>
+#if defined(__has_include) && __has_include(<memory_resource>)
+#include <memory_resource>
+#endif
+#include "cache_line.h"
+
+namespace container
+{
+
+namespace detail
+{
+
+// The widest word the slots of T can be split into, so they are copied with aligned word accesses.
+template<typename T>
+using seqlock_word_t =
+    typename std::conditional<alignof(T) % alignof(std::uint64_t) == 0 && sizeof(T) % sizeof(std::uint64_t) == 0, std::uint64_t,
+    typename std::conditional<alignof(T) % alignof(std::uint32_t) == 0 && sizeof(T) % sizeof(std::uint32_t) == 0, std::uint32_t,
+    typename std::conditional<alignof(T) % alignof(std::uint16_t) == 0 && sizeof(T) % sizeof(std::uint16_t) == 0, std::uint16_t,
+    unsigned char>::type>::type>::type;
+
+// The slots are only ever accessed a word at a time with relaxed atomic operations,
+// so the reader racing with the writer is not a data race; elements go in and out through memcpy.
+template<typename Word>
+inline void seqlock_store_words(const unsigned char* src, std::size_t n, Word* slots) noexcept
+{
+    for(std::size_t i = 0; i < n; i++, src += sizeof(Word))
+    {
+        Word word;
+        std::memcpy(&word, src, sizeof(Word));
+#if defined(__GNUC__)
+        __atomic_store_n(slots + i, word, __ATOMIC_RELAXED);
+#else
+        slots[i] = word;
+#endif
+    }
+}
+
+template<typename Word>
+inline void seqlock_load_words(const Word* slots, std::size_t n, unsigned char* dest) noexcept
+{
+    for(std::size_t i = 0; i < n; i++, dest += sizeof(Word))
+    {
+#if defined(__GNUC__)
+        const Word word = __atomic_load_n(slots + i, __ATOMIC_RELAXED);
+#else
+        const Word word = slots[i];
+#endif
+        std::memcpy(dest, &word, sizeof(Word));
+    }
+}
+
+}   // namespace detail
+
+/*
+    Circular buffer for one writer thread and any number of reader threads,
+    where readers take copies of the latest elements without ever holding up the writer.
+
+    - The writer only calls push_back. When full, pushing overwrites the oldest element.
+    - Before touching a slot the writer advances claimed_, and after it advances published_.
+      Both count every element ever pushed, so slot i holds the element number i % capacity().
+    - A reader copies the latest elements below published_ in at most two contiguous segments,
+      then checks claimed_: if the writer has since claimed a slot inside the copied range,
+      the copy may be torn and is retried. Only the writer lapping the range causes a retry,
+      so reading fewer elements than the capacity leaves room for the writer to keep going.
+
+    As with any seqlock, the copy overlaps with the writer and is only used once validated,
+    so elements must be trivially copyable. The slots are copied word by word with relaxed atomic
+    loads and stores, so a torn copy is a retry rather than a data race (with GCC and Clang).
+*/
+template<typename T, typename Allocator = std::allocator<T>>
+class seqlock_circular_buffer final
+{
+    static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable.");
+
+public:
+    using value_type        = typename std::allocator_traits<Allocator>::value_type;
+    using pointer           = typename std::allocator_traits<Allocator>::pointer;
+    using const_pointer     = typename std::allocator_traits<Allocator>::const_pointer;
+    using reference         = value_type&;
+    using const_reference   = const value_type&;
+    using difference_type   = typename std::allocator_traits<Allocator>::difference_type;
+    using size_type         = typename std::allocator_traits<Allocator>::size_type;
+    using allocator_type    = Allocator;
+
+private:
+    using allocator_traits = std::allocator_traits<Allocator>;
+    using counter_type = std::uint64_t;
+
+public:
+    seqlock_circular_buffer() = delete;
+
+    explicit seqlock_circular_buffer(size_type capacity, const Allocator& alloc = Allocator())
+        : alloc_(alloc)
+        , array_(allocator_traits::allocate(alloc_, capacity))
+        , capacity_(capacity)
+        , claimed_(0)
+        , published_(0)
+    {
+        assert(capacity > 0);
+    }
+
+    ~seqlock_circular_buffer()
+    {
+        allocator_traits::deallocate(alloc_, array_, capacity_);
+    }
+
+    seqlock_circular_buffer(const seqlock_circular_buffer&) = delete;
+    seqlock_circular_buffer& operator = (const seqlock_circular_buffer&) = delete;
+
+    seqlock_circular_buffer(seqlock_circular_buffer&&) = delete;
+    seqlock_circular_buffer& operator = (seqlock_circular_buffer&&) = delete;
+
+// Writer.
+
+    void push_back(const_reference item);
+
+    // Publishes count elements at once; only the last capacity() of them are kept.
+    void push_back(const_pointer items, size_type count);
+
+// Readers.
+
+    // Copies the latest min(count, size()) elements into dest, oldest first, and returns how many.
+    // Retries while the writer overwrites the range being copied, which with count == capacity()
+    // means until the writer pauses.
+    size_type read_latest(pointer dest, size_type count) const;
+
+    // Makes a single attempt; returns false when it has to be retried.
+    bool try_read_latest(pointer dest, size_type count, size_type& copied) const;
+
+// Either side.
+
+    size_type size() const noexcept
+    {
+        const auto published = published_.load(std::memory_order_acquire);
+        return static_cast<size_type>((std::min)(published, static_cast<counter_type>(capacity_)));
+    }
+
+    bool is_empty() const noexcept { return published_.load(std::memory_order_acquire) == 0; }
+
+    size_type capacity() const noexcept { return capacity_; }
+
+    // The number of elements ever pushed.
+    counter_type pushed() const noexcept { return published_.load(std::memory_order_acquire); }
+
+    allocator_type get_allocator() const noexcept { return alloc_; }
+
+private:
+    size_type slot(counter_type counter) const noexcept { return static_cast<size_type>(counter % capacity_); }
+
+    using word_type = detail::seqlock_word_t<value_type>;
+    static constexpr size_type words_per_element = sizeof(value_type) / sizeof(word_type);
+
+    // The slots as words; no element object ever lives in them.
+    word_type* slot_words(size_type index) const noexcept
+    {
+        return reinterpret_cast<word_type*>(std::addressof(array_[index]));
+    }
+
+    void store_slots(const_pointer items, size_type count, size_type index) noexcept
+    {
+        detail::seqlock_store_words(reinterpret_cast<const unsigned char*>(items), count * words_per_element, slot_words(index));
+    }
+
+    void load_slots(size_type index, size_type count, pointer dest) const noexcept
+    {
+        detail::seqlock_load_words(slot_words(index), count * words_per_element, reinterpret_cast<unsigned char*>(dest));
+    }
+
+private:
+    // Shared, read-only after construction.
+    allocator_type alloc_;
+    pointer array_;
+    size_type capacity_;
+    // Written by the writer, read by everyone.
+    alignas(detail::cache_line_size) std::atomic<counter_type> claimed_;
+    std::atomic<counter_type> published_;
+};
+
+template<typename T, typename Allocator>
+void seqlock_circular_buffer<T, Allocator>::push_back(const_reference item)
+{
+    push_back(std::addressof(item), 1);
+}
+
+template<typename T, typename Allocator>
+void seqlock_circular_buffer<T, Allocator>::push_back(const_pointer items, size_type count)
+{
+    const auto first = published_.load(std::memory_order_relaxed);
+    const auto last = first + count;
+
+    // Readers that see any of the slot writes below also see the claim.
+    claimed_.store(last, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    const auto skipped = count - (std::min)(count, capacity_);
+    count -= skipped;
+    items += skipped;
+    const auto head = slot(first + skipped);
+    const auto first_count = (std::min)(count, capacity_ - head);
+    store_slots(items, first_count, head);
+    store_slots(items + first_count, count - first_count, 0);
+
+    published_.store(last, std::memory_order_release);
+}
+
+template<typename T, typename Allocator>
+bool seqlock_circular_buffer<T, Allocator>::try_read_latest(pointer dest, size_type count, size_type& copied) const
+{
+    const auto published = published_.load(std::memory_order_acquire);
+    count = static_cast<size_type>((std::min)({ static_cast<counter_type>(count), published, static_cast<counter_type>(capacity_) }));
+
+    const auto head = slot(published - count);
+    const auto first_count = (std::min)(count, capacity_ - head);
+    load_slots(head, first_count, dest);
+    load_slots(0, count - first_count, dest + first_count);
+
+    // The slot of element number c was last the slot of c - capacity(), so the copy
+    // [published - count, published) is intact as long as nothing at or past
+    // published - count + capacity() has been claimed.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const auto claimed = claimed_.load(std::memory_order_relaxed);
+    copied = count;
+    return claimed + count <= published + capacity_;
+}
+
+template<typename T, typename Allocator>
+typename seqlock_circular_buffer<T, Allocator>::size_type
+seqlock_circular_buffer<T, Allocator>::read_latest(pointer dest, size_type count) const
+{
+    size_type copied = 0;
+    while(!try_read_latest(dest, count, copied))
+        ;
+    return copied;
+}
+
+#if defined(__has_include) && __has_include(<memory_resource>)
+namespace pmr
+{
+
+template<typename T>
+using seqlock_circular_buffer = container::seqlock_circular_buffer<T, std::pmr::polymorphic_allocator<T>>;
+
+}   // namespace pmr
+#endif
+
+}   // namespace container
@@ -0,0 +1,423 @@
+#pragma once
+#if defined(__linux__)
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <climits>
+#include <algorithm>
+#include <atomic>
+#include <new>
+#include <string>
+#include <thread>
+#include <utility>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include <cerrno>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "cache_line.h"
+#include "power_of_2.h"
+
+namespace container
+{
+
+namespace detail
+{
+
+/*
+    The start of the shared memory object, followed by the slots.
+    head and tail are counters that never wrap; the slot of counter c is c & (capacity - 1).
+*/
+struct shm_ring_header
+{
+    std::uint64_t magic;
+    std::uint64_t element_size;
+    std::uint64_t capacity;
+    std::atomic<std::uint32_t> ready;       // Set by the creator once the fields above are written.
+    std::atomic<std::uint32_t> closed;
+    alignas(cache_line_size) std::atomic<std::uint64_t> tail;   // Written by the producer.
+    alignas(cache_line_size) std::atomic<std::uint64_t> head;   // Written by the consumer.
+    alignas(cache_line_size) std::atomic<std::uint32_t> wake;   // Futex word, bumped to wake the consumer.
+    std::atomic<std::uint32_t> sleeping;
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "The cursors must be lock-free to be shared between processes.");
+static_assert(std::atomic<std::uint32_t>::is_always_lock_free, "The futex word must be lock-free to be shared between processes.");
+
+constexpr std::uint64_t shm_ring_magic = 0x31474e4952534d48ull;    // "HMSRING1"
+
+// Without FUTEX_PRIVATE_FLAG, so that the word may be shared between processes.
+inline void futex_wait(std::atomic<std::uint32_t>& word, std::uint32_t expected) noexcept
+{
+    ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAIT, expected, nullptr, nullptr, 0);
+}
+
+inline void futex_wake(std::atomic<std::uint32_t>& word) noexcept
+{
+    ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+// A shared, writable mapping of a POSIX shared memory object.
+class shm_mapping final
+{
+public:
+    shm_mapping() noexcept
+        : address_(nullptr), size_(0)
+    {}
+
+    // Creates the object with size bytes of zeros, or opens the existing one.
+    // Returns through created whether this call created it.
+    shm_mapping(const char* name, std::size_t size, bool& created)
+        : address_(nullptr), size_(0)
+    {
+        int fd = ::shm_open(name, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+        created = (fd >= 0);
+        if(!created && (errno == EEXIST))
+            fd = ::shm_open(name, O_RDWR | O_CLOEXEC, 0600);
+        if(fd < 0)
+            throw std::system_error(errno, std::generic_category(), "shm_open");
+
+        bool ok = true;
+        if(created)
+        {
+            ok = (::ftruncate(fd, static_cast<off_t>(size)) == 0);
+        }
+        else
+        {   // The creator may not have sized it yet.
+            struct stat status;
+            for(int attempt = 0; ok && (attempt < 1000); attempt++)
+            {
+                ok = (::fstat(fd, &status) == 0);
+                if(ok && (status.st_size > 0))
+                    break;
+                std::this_thread::yield();
+            }
+            size = ok? static_cast<std::size_t>(status.st_size) : 0;
+        }
+
+        void* address = MAP_FAILED;
+        if(ok && (size > 0))
+            address = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        const int error = (size > 0)? errno : EINVAL;
+
+        // The mapping keeps the object alive.
+        ::close(fd);
+        if(address == MAP_FAILED)
+            throw std::system_error(error, std::generic_category(), "mmap");
+        address_ = address;
+        size_ = size;
+    }
+
+    ~shm_mapping()
+    {
+        if(address_ != nullptr)
+            ::munmap(address_, size_);
+    }
+
+    shm_mapping(const shm_mapping&) = delete;
+    shm_mapping& operator = (const shm_mapping&) = delete;
+
+    shm_mapping(shm_mapping&& other) noexcept
+        : address_(std::exchange(other.address_, nullptr))
+        , size_(std::exchange(other.size_, 0))
+    {}
+
+    shm_mapping& operator = (shm_mapping&& other) noexcept
+    {
+        std::swap(address_, other.address_);
+        std::swap(size_, other.size_);
+        return *this;
+    }
+
+    unsigned char* data() const noexcept { return static_cast<unsigned char*>(address_); }
+    std::size_t size() const noexcept { return size_; }
+
+private:
+    void* address_;
+    std::size_t size_;
+};
+
+}   // namespace detail
+
+/*
+    Single-producer/single-consumer ring in POSIX shared memory, for streaming between processes.
+
+    The first process to construct it with a given name creates the shared memory object;
+    the other attaches by the same name. One of them only pushes, the other only pops.
+    The cursors live in a fixed header, each on its own cache line, next to the slots.
+
+    A consumer that finds the ring empty yields for a while and then sleeps on a futex in the header.
+    The producer only makes the wake-up call when the consumer has announced that it sleeps.
+
+    Elements must be trivially copyable. The capacity is rounded up to a power of two.
+    Pushing never overwrites: a full ring rejects the element. Linux only.
+*/
+template<typename T>
+class shm_spsc_ring final
+{
+    static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable.");
+
+public:
+    using value_type        = T;
+    using pointer           = value_type*;
+    using const_pointer     = const value_type*;
+    using reference         = value_type&;
+    using const_reference   = const value_type&;
+    using size_type         = std::size_t;
+
+public:
+    shm_spsc_ring() = delete;
+
+    // Creates the shared memory object named name (e.g. "/samples"), or attaches to it.
+    // Throws std::system_error when it cannot be opened or mapped,
+    // and std::runtime_error when it was created for another capacity or element size.
+    shm_spsc_ring(const std::string& name, size_type capacity);
+
+    // Detaches; the object lives on until it is unlinked and every process has detached.
+    ~shm_spsc_ring() = default;
+
+    shm_spsc_ring(const shm_spsc_ring&) = delete;
+    shm_spsc_ring& operator = (const shm_spsc_ring&) = delete;
+
+    shm_spsc_ring(shm_spsc_ring&& other) noexcept;
+    shm_spsc_ring& operator = (shm_spsc_ring&& other) noexcept;
+
+    // Removes the name. Returns false when there was no such object.
+    static bool unlink(const std::string& name) noexcept { return ::shm_unlink(name.c_str()) == 0; }
+
+// Producer.
+    bool try_push(const_reference item) { return try_push(&item, 1) == 1; }
+
+    // Pushes as many as fit and returns the number pushed.
+    size_type try_push(const_pointer items, size_type count);
+
+    // Tells the consumer that nothing more will come.
+    void close() noexcept;
+
+// Consumer.
+    bool try_pop(reference item) { return try_pop(&item, 1) == 1; }
+
+    // Pops up to max_count elements and returns the number popped.
+    size_type try_pop(pointer dest, size_type max_count);
+
+    // Waits while the ring is empty. Returns false once it is closed and drained.
+    bool pop(reference item);
+
+// Either side.
+    // Exact only when the other side is idle.
+    size_type size() const noexcept;
+
+    bool is_empty() const noexcept { return size() == 0; }
+    bool is_closed() const noexcept { return header_->closed.load(std::memory_order_acquire) != 0; }
+
+    size_type capacity() const noexcept { return mask_ + 1; }
+
+private:
+    static size_type slots_offset() noexcept;
+
+    // Copies count elements between the slots starting at counter position and the array.
+    void copy_to_slots(std::uint64_t position, const_pointer items, size_type count) noexcept;
+    void copy_from_slots(std::uint64_t position, pointer dest, size_type count) const noexcept;
+
+    void wait_for_data();
+
+private:
+    detail::shm_mapping mapping_;
+    detail::shm_ring_header* header_;
+    pointer slots_;
+    size_type mask_;
+    std::uint64_t cached_head_;     // The producer's view of the consumer.
+    std::uint64_t cached_tail_;     // The consumer's view of the producer.
+};
+
+template<typename T>
+typename shm_spsc_ring<T>::size_type
+shm_spsc_ring<T>::slots_offset() noexcept
+{
+    constexpr auto alignment = (std::max)(detail::cache_line_size, alignof(value_type));
+    return (sizeof(detail::shm_ring_header) + alignment - 1) / alignment * alignment;
+}
+
+template<typename T>
+shm_spsc_ring<T>::shm_spsc_ring(const std::string& name, size_type capacity)
+    : header_(nullptr)
+    , slots_(nullptr)
+    , mask_(detail::round_up_to_power_of_2(capacity) - 1)
+    , cached_head_(0)
+    , cached_tail_(0)
+{
+    assert(capacity > 0);
+    bool created = false;
+    mapping_ = detail::shm_mapping(name.c_str(), slots_offset() + (mask_ + 1) * sizeof(value_type), created);
+
+    if(created)
+    {
+        header_ = ::new(static_cast<void*>(mapping_.data())) detail::shm_ring_header();
+        header_->magic = detail::shm_ring_magic;
+        header_->element_size = sizeof(value_type);
+        header_->capacity = mask_ + 1;
+        header_->ready.store(1, std::memory_order_release);
+    }
+    else
+    {
+        header_ = std::launder(reinterpret_cast<detail::shm_ring_header*>(mapping_.data()));
+        for(int attempt = 0; (header_->ready.load(std::memory_order_acquire) == 0) && (attempt < 1000); attempt++)
+            std::this_thread::yield();
+        if(header_->ready.load(std::memory_order_acquire) == 0 || header_->magic != detail::shm_ring_magic)
+            throw std::runtime_error("Not a ring: " + name);
+        if(header_->element_size != sizeof(value_type) || header_->capacity != mask_ + 1
+            || mapping_.size() < slots_offset() + (mask_ + 1) * sizeof(value_type))
+        {
+            throw std::runtime_error("The ring was created with another element size or capacity: " + name);
+        }
+        cached_head_ = header_->head.load(std::memory_order_acquire);
+        cached_tail_ = header_->tail.load(std::memory_order_acquire);
+    }
+    slots_ = reinterpret_cast<pointer>(mapping_.data() + slots_offset());
+}
+
+template<typename T>
+shm_spsc_ring<T>::shm_spsc_ring(shm_spsc_ring&& other) noexcept
+    : mapping_(std::move(other.mapping_))
+    , header_(std::exchange(other.header_, nullptr))
+    , slots_(std::exchange(other.slots_, nullptr))
+    , mask_(std::exchange(other.mask_, 0))
+    , cached_head_(std::exchange(other.cached_head_, 0))
+    , cached_tail_(std::exchange(other.cached_tail_, 0))
+{}
+
+template<typename T>
+shm_spsc_ring<T>& shm_spsc_ring<T>::operator = (shm_spsc_ring&& other) noexcept
+{
+    mapping_ = std::move(other.mapping_);
+    std::swap(header_, other.header_);
+    std::swap(slots_, other.slots_);
+    std::swap(mask_, other.mask_);
+    std::swap(cached_head_, other.cached_head_);
+    std::swap(cached_tail_, other.cached_tail_);
+    return *this;
+}
+
+template<typename T>
+void shm_spsc_ring<T>::copy_to_slots(std::uint64_t position, const_pointer items, size_type count) noexcept
+{
+    const auto index = static_cast<size_type>(position) & mask_;
+    const auto first_count = (std::min)(count, mask_ + 1 - index);
+    std::memcpy(slots_ + index, items, first_count * sizeof(value_type));
+    std::memcpy(slots_, items + first_count, (count - first_count) * sizeof(value_type));
+}
+
+template<typename T>
+void shm_spsc_ring<T>::copy_from_slots(std::uint64_t position, pointer dest, size_type count) const noexcept
+{
+    const auto index = static_cast<size_type>(position) & mask_;
+    const auto first_count = (std::min)(count, mask_ + 1 - index);
+    std::memcpy(dest, slots_ + index, first_count * sizeof(value_type));
+    std::memcpy(dest + first_count, slots_, (count - first_count) * sizeof(value_type));
+}
+
+template<typename T>
+typename shm_spsc_ring<T>::size_type
+shm_spsc_ring<T>::try_push(const_pointer items, size_type count)
+{
+    const auto tail = header_->tail.load(std::memory_order_relaxed);
+    if(tail - cached_head_ + count > capacity())
+    {   // Only touch the consumer's cache line when the ring looks full.
+        cached_head_ = header_->head.load(std::memory_order_acquire);
+    }
+    count = (std::min)(count, static_cast<size_type>(capacity() - (tail - cached_head_)));
+    if(count == 0)
+        return 0;
+
+    copy_to_slots(tail, items, count);
+    header_->tail.store(tail + count, std::memory_order_release);
+
+    // Pairs with the fence in wait_for_data(): either the consumer sees the new tail,
+    // or this sees that the consumer sleeps.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if(header_->sleeping.load(std::memory_order_relaxed) != 0)
+    {
+        header_->wake.fetch_add(1, std::memory_order_release);
+        detail::futex_wake(header_->wake);
+    }
+    return count;
+}
+
+template<typename T>
+void shm_spsc_ring<T>::close() noexcept
+{
+    header_->closed.store(1, std::memory_order_release);
+    header_->wake.fetch_add(1, std::memory_order_release);
+    detail::futex_wake(header_->wake);
+}
+
+template<typename T>
+typename shm_spsc_ring<T>::size_type
+shm_spsc_ring<T>::try_pop(pointer dest, size_type max_count)
+{
+    const auto head = header_->head.load(std::memory_order_relaxed);
+    if(cached_tail_ - head < max_count)
+    {   // Only touch the producer's cache line when the ring looks short.
+        cached_tail_ = header_->tail.load(std::memory_order_acquire);
+    }
+    const auto count = (std::min)(max_count, static_cast<size_type>(cached_tail_ - head));
+    if(count == 0)
+        return 0;
+
+    copy_from_slots(head, dest, count);
+    header_->head.store(head + count, std::memory_order_release);
+    return count;
+}
+
+template<typename T>
+bool shm_spsc_ring<T>::pop(reference item)
+{
+    for(;;)
+    {
+        if(try_pop(item))
+            return true;
+        if(is_closed())
+        {   // The producer may have pushed right before closing.
+            return try_pop(item);
+        }
+        wait_for_data();
+    }
+}
+
+// Yields for a while before sleeping, as a wake-up costs a system call on both sides.
+template<typename T>
+void shm_spsc_ring<T>::wait_for_data()
+{
+    const auto head = header_->head.load(std::memory_order_relaxed);
+    for(int i = 0; i < 64; i++)
+    {
+        if(header_->tail.load(std::memory_order_acquire) != head || is_closed())
+            return;
+        std::this_thread::yield();
+    }
+
+    const auto wake = header_->wake.load(std::memory_order_acquire);
+    header_->sleeping.store(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if(header_->tail.load(std::memory_order_acquire) == head && !is_closed())
+        detail::futex_wait(header_->wake, wake);
+    header_->sleeping.store(0, std::memory_order_relaxed);
+}
+
+template<typename T>
+typename shm_spsc_ring<T>::size_type
+shm_spsc_ring<T>::size() const noexcept
+{
+    const auto head = header_->head.load(std::memory_order_acquire);
+    const auto tail = header_->tail.load(std::memory_order_acquire);
+    return (tail > head)? static_cast<size_type>(tail - head) : 0;
+}
+
+}   // namespace container
+#endif
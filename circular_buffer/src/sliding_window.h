@@ -0,0 +1,311 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+#if defined(__has_include) && __has_include(<memory_resource>)
+#include <memory_resource>
+#endif
+#include "circular_buffer.h"
+
+namespace container
+{
+
+namespace detail
+{
+
+// Count, mean and sum of squared deviations of a set of values.
+struct moments
+{
+    double count = 0.0;
+    double mean = 0.0;
+    double m2 = 0.0;
+};
+
+// Chan et al.: the moments of the union of two disjoint sets.
+inline moments merge(const moments& a, const moments& b) noexcept
+{
+    if(a.count == 0.0)
+        return b;
+    if(b.count == 0.0)
+        return a;
+    moments result;
+    result.count = a.count + b.count;
+    const auto delta = b.mean - a.mean;
+    result.mean = a.mean + delta * (b.count / result.count);
+    result.m2 = a.m2 + b.m2 + delta * delta * (a.count * b.count / result.count);
+    return result;
+}
+
+// The inverse of merge: the moments of a without its subset b.
+inline moments remove(const moments& a, const moments& b) noexcept
+{
+    if(b.count >= a.count)
+        return moments();
+    moments result;
+    result.count = a.count - b.count;
+    result.mean = (a.count * a.mean - b.count * b.mean) / result.count;
+    const auto delta = b.mean - result.mean;
+    result.m2 = a.m2 - b.m2 - delta * delta * (result.count * b.count / a.count);
+    return result;
+}
+
+// The loops keep `lanes` independent partial sums, so that the compiler can vectorize them
+// without reassociating floating-point additions on its own.
+constexpr std::size_t lanes = 8;
+
+template<typename T>
+inline double sum_of(const T* values, std::size_t count) noexcept
+{
+    double partial[lanes] = {};
+    std::size_t i = 0;
+    for(; i + lanes <= count; i += lanes)
+    {
+        for(std::size_t j = 0; j < lanes; j++)
+            partial[j] += static_cast<double>(values[i + j]);
+    }
+    for(; i < count; i++)
+        partial[0] += static_cast<double>(values[i]);
+
+    double sum = 0.0;
+    for(std::size_t j = 0; j < lanes; j++)
+        sum += partial[j];
+    return sum;
+}
+
+template<typename T>
+inline double squared_deviations_of(const T* values, std::size_t count, double mean) noexcept
+{
+    double partial[lanes] = {};
+    std::size_t i = 0;
+    for(; i + lanes <= count; i += lanes)
+    {
+        for(std::size_t j = 0; j < lanes; j++)
+        {
+            const auto d = static_cast<double>(values[i + j]) - mean;
+            partial[j] += d * d;
+        }
+    }
+    for(; i < count; i++)
+    {
+        const auto d = static_cast<double>(values[i]) - mean;
+        partial[0] += d * d;
+    }
+
+    double sum = 0.0;
+    for(std::size_t j = 0; j < lanes; j++)
+        sum += partial[j];
+    return sum;
+}
+
+// Two passes over contiguous values.
+template<typename T>
+inline moments moments_of(const T* values, std::size_t count) noexcept
+{
+    moments result;
+    if(count == 0)
+        return result;
+    result.count = static_cast<double>(count);
+    result.mean = sum_of(values, count) / result.count;
+    result.m2 = squared_deviations_of(values, count, result.mean);
+    return result;
+}
+
+}   // namespace detail
+
+/*
+    Rolling statistics over the last window_size() values pushed.
+
+    Pushing updates the sum, the mean and the variance in O(1) with Welford's method,
+    including the removal of the value that falls out of the window.
+    The minimum and the maximum are the fronts of two monotonic queues, which is amortized O(1) per push.
+
+    push_back(items, count) processes a batch: the moments of the new values and of the evicted ones
+    are computed over contiguous arrays in loops that the compiler vectorizes, and are merged in one step.
+
+    The statistics are kept in double.
+*/
+template<typename T, typename Allocator = std::allocator<T>>
+class sliding_window final
+{
+    static_assert(std::is_arithmetic<T>::value, "T must be an arithmetic type.");
+
+public:
+    using value_type        = T;
+    using const_pointer     = const value_type*;
+    using size_type         = std::size_t;
+    using allocator_type    = Allocator;
+    using buffer_type       = circular_buffer<T, Allocator>;
+
+private:
+    using counter_type = std::uint64_t;
+    using entry_type = std::pair<counter_type, value_type>;
+    using entry_allocator_type = typename std::allocator_traits<Allocator>::template rebind_alloc<entry_type>;
+
+public:
+    sliding_window() = delete;
+
+    explicit sliding_window(size_type window_size, const Allocator& alloc = Allocator())
+        : values_(window_size, alloc)
+        , min_queue_(window_size, entry_allocator_type(alloc))
+        , max_queue_(window_size, entry_allocator_type(alloc))
+        , counter_(0)
+    {}
+
+    // Evicts the oldest value when the window is full.
+    void push_back(value_type value);
+
+    // Same as pushing the values one by one.
+    void push_back(const_pointer items, size_type count);
+
+    void clear();
+
+    // The values in the window, oldest first.
+    const buffer_type& values() const noexcept { return values_; }
+
+    size_type size() const noexcept { return values_.size(); }
+    size_type window_size() const noexcept { return values_.capacity(); }
+
+    bool is_empty() const noexcept { return values_.is_empty(); }
+    bool is_full() const noexcept { return values_.is_full(); }
+
+    double sum() const noexcept { return moments_.mean * moments_.count; }
+    double mean() const noexcept { return moments_.mean; }
+
+    // Population variance; rounding may leave a tiny negative m2, which is clamped.
+    double variance() const noexcept;
+    double sample_variance() const noexcept;
+
+    // The window must not be empty.
+    value_type min() const { assert(!is_empty()); return min_queue_.front().second; }
+    value_type max() const { assert(!is_empty()); return max_queue_.front().second; }
+
+private:
+    template<typename Compare>
+    void update_queue(circular_buffer<entry_type, entry_allocator_type>& queue, value_type value, Compare compare);
+
+    void update_queues(value_type value);
+
+    // The moments of the count oldest values.
+    detail::moments oldest_moments(size_type count) const;
+
+private:
+    buffer_type values_;
+    circular_buffer<entry_type, entry_allocator_type> min_queue_;   // Increasing values.
+    circular_buffer<entry_type, entry_allocator_type> max_queue_;   // Decreasing values.
+    counter_type counter_;  // Number of values pushed so far.
+    detail::moments moments_;
+};
+
+template<typename T, typename Allocator>
+void sliding_window<T, Allocator>::push_back(value_type value)
+{
+    const auto x = static_cast<double>(value);
+    if(is_full())
+    {   // The count stays the same: replace the oldest value.
+        const auto oldest = static_cast<double>(values_.front());
+        const auto mean = moments_.mean + (x - oldest) / moments_.count;
+        moments_.m2 += (x - oldest) * (x - mean + oldest - moments_.mean);
+        moments_.mean = mean;
+    }
+    else
+    {
+        moments_.count += 1.0;
+        const auto delta = x - moments_.mean;
+        moments_.mean += delta / moments_.count;
+        moments_.m2 += delta * (x - moments_.mean);
+    }
+    values_.push_back(value);
+    update_queues(value);
+}
+
+template<typename T, typename Allocator>
+void sliding_window<T, Allocator>::push_back(const_pointer items, size_type count)
+{
+    const auto capacity = window_size();
+    if(count >= capacity)
+    {   // Only the last window_size() values survive.
+        items += count - capacity;
+        counter_ += count - capacity;
+        count = capacity;
+        clear();
+    }
+    else if(count > capacity - size())
+    {
+        moments_ = detail::remove(moments_, oldest_moments(count - (capacity - size())));
+    }
+
+    values_.push_back(items, items + count);
+    moments_ = detail::merge(moments_, detail::moments_of(items, count));
+    for(size_type i = 0; i < count; i++)
+        update_queues(items[i]);
+}
+
+template<typename T, typename Allocator>
+void sliding_window<T, Allocator>::clear()
+{
+    values_.clear();
+    min_queue_.clear();
+    max_queue_.clear();
+    moments_ = detail::moments();
+}
+
+template<typename T, typename Allocator>
+double sliding_window<T, Allocator>::variance() const noexcept
+{
+    return (moments_.count > 0.0)? (std::max)(moments_.m2, 0.0) / moments_.count : 0.0;
+}
+
+template<typename T, typename Allocator>
+double sliding_window<T, Allocator>::sample_variance() const noexcept
+{
+    return (moments_.count > 1.0)? (std::max)(moments_.m2, 0.0) / (moments_.count - 1.0) : 0.0;
+}
+
+// Drops the entries that left the window and those that can no longer be the extremum.
+template<typename T, typename Allocator>
+template<typename Compare>
+void sliding_window<T, Allocator>::update_queue(circular_buffer<entry_type, entry_allocator_type>& queue, value_type value, Compare compare)
+{
+    const auto oldest = (counter_ >= window_size())? counter_ - window_size() + 1 : 0;
+    while(!queue.is_empty() && (queue.front().first < oldest))
+        queue.pop_front();
+    while(!queue.is_empty() && !compare(queue.back().second, value))
+        queue.pop_back();
+    queue.push_back(entry_type(counter_, value));
+}
+
+template<typename T, typename Allocator>
+void sliding_window<T, Allocator>::update_queues(value_type value)
+{
+    update_queue(min_queue_, value, [](value_type a, value_type b) { return a < b; });
+    update_queue(max_queue_, value, [](value_type a, value_type b) { return a > b; });
+    ++counter_;
+}
+
+template<typename T, typename Allocator>
+detail::moments sliding_window<T, Allocator>::oldest_moments(size_type count) const
+{
+    assert(count <= size());
+    if(count == 0)
+        return detail::moments();
+    const auto one = values_.array_one();
+    const auto two = values_.array_two();
+    const auto first_count = (std::min)(count, one.second);
+    return detail::merge(detail::moments_of(one.first, first_count), detail::moments_of(two.first, count - first_count));
+}
+
+#if defined(__has_include) && __has_include(<memory_resource>)
+namespace pmr
+{
+
+template<typename T>
+using sliding_window = container::sliding_window<T, std::pmr::polymorphic_allocator<T>>;
+
+}   // namespace pmr
+#endif
+
+}   // namespace container
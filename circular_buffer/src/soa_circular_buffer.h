@@ -0,0 +1,570 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <tuple>
+#include <iterator>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include "cache_line.h"
+
+namespace container
+{
+
+namespace detail
+{
+
+/*
+    Row iterator of soa_circular_buffer.
+    Dereferencing yields a tuple of references into the columns, so this is a proxy iterator
+    in the same way as the iterator of std::vector<bool>.
+*/
+template<typename Buffer, typename Reference>
+class soa_circular_buffer_iterator
+{
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type        = typename std::remove_const_t<Buffer>::row_type;
+    using pointer           = void;
+    using reference         = Reference;
+    using difference_type   = std::ptrdiff_t;
+
+    soa_circular_buffer_iterator()
+        : cb_(nullptr), index_(0)
+    {}
+
+    soa_circular_buffer_iterator(Buffer* cb, difference_type index)
+        : cb_(cb), index_(index)
+    {}
+
+    // Indirection operator.
+    reference operator * () const
+    {
+        return (*cb_)[static_cast<std::size_t>(index_)];
+    }
+
+    // Increment operator (prefix).
+    soa_circular_buffer_iterator& operator ++ ()
+    {
+        assert(index_ < static_cast<difference_type>(cb_->size()));
+        ++index_;
+        return *this;
+    }
+
+    // Increment operator (postfix).
+    soa_circular_buffer_iterator operator ++ (int)
+    {
+        soa_circular_buffer_iterator temp = *this;
+        ++(*this);
+        return temp;
+    }
+
+    // Decrement operator (prefix).
+    soa_circular_buffer_iterator& operator -- ()
+    {
+        assert(index_ > 0);
+        --index_;
+        return *this;
+    }
+
+    // Decrement operator (postfix).
+    soa_circular_buffer_iterator operator -- (int)
+    {
+        soa_circular_buffer_iterator temp = *this;
+        --(*this);
+        return temp;
+    }
+
+    // Subtraction operator.
+    difference_type operator - (const soa_circular_buffer_iterator& rhs) const
+    {
+        return index_ - rhs.index_;
+    }
+
+    // Subscript operator.
+    reference operator [] (difference_type n) const
+    {
+        return *(*this + n);
+    }
+
+    // Addition assignment operator.
+    soa_circular_buffer_iterator& operator += (difference_type n)
+    {
+        assert(index_ + n >= 0);
+        assert(index_ + n <= static_cast<difference_type>(cb_->size()));
+        index_ += n;
+        return *this;
+    }
+
+    // Addition operator.
+    soa_circular_buffer_iterator operator + (difference_type n) const
+    {
+        return soa_circular_buffer_iterator(*this) += n;
+    }
+
+    // Subtraction assignment operator.
+    soa_circular_buffer_iterator& operator -= (difference_type n)
+    {
+        return *this += -n;
+    }
+
+    // Subtraction operator.
+    soa_circular_buffer_iterator operator - (difference_type n) const
+    {
+        return soa_circular_buffer_iterator(*this) -= n;
+    }
+
+// Comparison operators.
+
+    bool operator == (const soa_circular_buffer_iterator& rhs) const { return index_ == rhs.index_; }
+    bool operator != (const soa_circular_buffer_iterator& rhs) const { return index_ != rhs.index_; }
+    bool operator < (const soa_circular_buffer_iterator& rhs) const { return index_ < rhs.index_; }
+    bool operator > (const soa_circular_buffer_iterator& rhs) const { return rhs < *this; }
+    bool operator <= (const soa_circular_buffer_iterator& rhs) const { return !(rhs < *this); }
+    bool operator >= (const soa_circular_buffer_iterator& rhs) const { return !(*this < rhs); }
+
+private:
+    Buffer* cb_;
+    difference_type index_;
+};
+
+/*
+    One column of a soa_circular_buffer, seen as a buffer of its own.
+    It provides is_empty(), array_one() and array_two(), so the segmented algorithms accept it.
+*/
+template<typename Buffer, std::size_t I>
+class soa_column
+{
+public:
+    using value_type = typename std::remove_const_t<Buffer>::template column_type<I>;
+    using array_range_t = decltype(std::declval<Buffer&>().template array_one<I>());
+
+    explicit soa_column(Buffer& cb) noexcept
+        : cb_(&cb)
+    {}
+
+    decltype(auto) operator[](std::size_t index) const { return cb_->template get<I>(index); }
+
+    std::size_t size() const noexcept { return cb_->size(); }
+    bool is_empty() const noexcept { return cb_->is_empty(); }
+
+    array_range_t array_one() const { return cb_->template array_one<I>(); }
+    array_range_t array_two() const { return cb_->template array_two<I>(); }
+
+private:
+    Buffer* cb_;
+};
+
+}   // namespace detail
+
+/*
+    Circular buffer of rows {Ts...} stored as one contiguous array per column.
+
+    All columns share the head and the tail, so row i of the buffer is element i of every column.
+    A scan over one column only touches that column's bytes and runs over plain arrays,
+    through array_one<I>() / array_two<I>() or column<I>() with the segmented algorithms.
+
+    The columns live in one allocation, each starting on its own cache line.
+    The column types must be trivially copyable.
+    When full, pushing overwrites the oldest row.
+*/
+template<typename... Ts>
+class soa_circular_buffer final
+{
+    static_assert(sizeof...(Ts) > 0, "At least one column is required.");
+    static_assert(std::conjunction<std::is_trivially_copyable<Ts>...>::value, "Ts must be trivially copyable.");
+
+public:
+    using row_type          = std::tuple<Ts...>;
+    using reference         = std::tuple<Ts&...>;
+    using const_reference   = std::tuple<const Ts&...>;
+    using difference_type   = std::ptrdiff_t;
+    using size_type         = std::size_t;
+
+    template<std::size_t I>
+    using column_type = std::tuple_element_t<I, row_type>;
+
+    template<std::size_t I>
+    using array_range_t = std::pair<column_type<I>*, size_type>;
+
+    template<std::size_t I>
+    using const_array_range_t = std::pair<const column_type<I>*, size_type>;
+
+    using iterator = detail::soa_circular_buffer_iterator<soa_circular_buffer, reference>;
+    using const_iterator = detail::soa_circular_buffer_iterator<const soa_circular_buffer, const_reference>;
+
+    static constexpr size_type column_count = sizeof...(Ts);
+
+public:
+    soa_circular_buffer() = delete;
+
+    explicit soa_circular_buffer(size_type capacity);
+
+    ~soa_circular_buffer();
+
+    soa_circular_buffer(const soa_circular_buffer& other);
+    soa_circular_buffer& operator = (const soa_circular_buffer& other);
+
+    soa_circular_buffer(soa_circular_buffer&& other) noexcept;
+    soa_circular_buffer& operator = (soa_circular_buffer&& other) noexcept;
+
+    reference operator[](size_type index) { return row(physical_index(index), std::index_sequence_for<Ts...>()); }
+    const_reference operator[](size_type index) const { return row(physical_index(index), std::index_sequence_for<Ts...>()); }
+
+    reference at(size_type index);
+    const_reference at(size_type index) const;
+
+    reference front() { assert(!is_empty()); return (*this)[0]; }
+    const_reference front() const { assert(!is_empty()); return (*this)[0]; }
+
+    reference back() { assert(!is_empty()); return (*this)[contents_size_ - 1]; }
+    const_reference back() const { assert(!is_empty()); return (*this)[contents_size_ - 1]; }
+
+    // A single cell.
+    template<std::size_t I>
+    column_type<I>& get(size_type index) { return column_begin<I>()[physical_index(index)]; }
+
+    template<std::size_t I>
+    const column_type<I>& get(size_type index) const { return column_begin<I>()[physical_index(index)]; }
+
+    void clear() noexcept;
+
+    void push_back(const Ts&... values);
+    void push_back(const row_type& values);
+
+    void pop_front();
+    void pop_front(size_type count);
+    void pop_back();
+
+    size_type head() const noexcept { return head_; }
+    size_type tail() const noexcept { return tail_; }
+
+    size_type size() const noexcept { return contents_size_; }
+
+    bool is_empty() const noexcept { return contents_size_ == 0; }
+    bool is_full() const noexcept { return contents_size_ == capacity_; }
+
+    size_type capacity() const noexcept { return capacity_; }
+
+    // The cells of column I, in the same two segments for every column.
+    template<std::size_t I>
+    array_range_t<I> array_one();
+
+    template<std::size_t I>
+    const_array_range_t<I> array_one() const;
+
+    template<std::size_t I>
+    array_range_t<I> array_two();
+
+    template<std::size_t I>
+    const_array_range_t<I> array_two() const;
+
+    template<std::size_t I>
+    detail::soa_column<soa_circular_buffer, I> column() { return detail::soa_column<soa_circular_buffer, I>(*this); }
+
+    template<std::size_t I>
+    detail::soa_column<const soa_circular_buffer, I> column() const { return detail::soa_column<const soa_circular_buffer, I>(*this); }
+
+    iterator begin() { return iterator(this, 0); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+
+    iterator end() { return iterator(this, static_cast<difference_type>(size())); }
+    const_iterator end() const { return const_iterator(this, static_cast<difference_type>(size())); }
+
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+private:
+    static constexpr std::size_t column_alignment = (std::max)({ detail::cache_line_size, alignof(Ts)... });
+
+    // Byte offset of each column in the storage; the last entry is the total size.
+    static void layout(size_type capacity, std::size_t (&offsets)[column_count + 1]) noexcept;
+
+    static unsigned char* allocate(std::size_t bytes);
+    static void deallocate(unsigned char* storage) noexcept;
+
+    template<std::size_t I>
+    column_type<I>* column_begin() noexcept;
+
+    template<std::size_t I>
+    const column_type<I>* column_begin() const noexcept;
+
+    template<std::size_t... Is>
+    reference row(size_type slot, std::index_sequence<Is...>) noexcept;
+
+    template<std::size_t... Is>
+    const_reference row(size_type slot, std::index_sequence<Is...>) const noexcept;
+
+    template<std::size_t... Is>
+    void store(size_type slot, const row_type& values, std::index_sequence<Is...>) noexcept;
+
+    size_type physical_index(size_type index) const noexcept;
+    size_type next_index(size_type index) const noexcept { return (index < (capacity_ - 1))? index + 1 : 0; }
+
+private:
+    unsigned char* storage_;
+    std::size_t storage_size_;
+    std::size_t offsets_[column_count];
+    size_type capacity_;
+    size_type head_;
+    size_type tail_;
+    size_type contents_size_;
+};
+
+template<typename... Ts>
+soa_circular_buffer<Ts...>::soa_circular_buffer(size_type capacity)
+    : storage_(nullptr)
+    , storage_size_(0)
+    , offsets_()
+    , capacity_(capacity)
+    , head_(0)
+    , tail_(0)
+    , contents_size_(0)
+{
+    assert(capacity > 0);
+    std::size_t offsets[column_count + 1];
+    layout(capacity, offsets);
+    std::copy(offsets, offsets + column_count, offsets_);
+    storage_size_ = offsets[column_count];
+    storage_ = allocate(storage_size_);
+}
+
+template<typename... Ts>
+soa_circular_buffer<Ts...>::~soa_circular_buffer()
+{
+    deallocate(storage_);
+}
+
+template<typename... Ts>
+soa_circular_buffer<Ts...>::soa_circular_buffer(const soa_circular_buffer& other)
+    : storage_(allocate(other.storage_size_))
+    , storage_size_(other.storage_size_)
+    , capacity_(other.capacity_)
+    , head_(other.head_)
+    , tail_(other.tail_)
+    , contents_size_(other.contents_size_)
+{
+    std::copy(other.offsets_, other.offsets_ + column_count, offsets_);
+    if(storage_size_ > 0)
+        std::memcpy(storage_, other.storage_, storage_size_);
+}
+
+template<typename... Ts>
+soa_circular_buffer<Ts...>& soa_circular_buffer<Ts...>::operator = (const soa_circular_buffer& other)
+{
+    if(this != &other)
+        *this = soa_circular_buffer(other);
+    return *this;
+}
+
+template<typename... Ts>
+soa_circular_buffer<Ts...>::soa_circular_buffer(soa_circular_buffer&& other) noexcept
+    : storage_(std::exchange(other.storage_, nullptr))
+    , storage_size_(std::exchange(other.storage_size_, 0))
+    , capacity_(std::exchange(other.capacity_, 0))
+    , head_(std::exchange(other.head_, 0))
+    , tail_(std::exchange(other.tail_, 0))
+    , contents_size_(std::exchange(other.contents_size_, 0))
+{
+    std::copy(other.offsets_, other.offsets_ + column_count, offsets_);
+}
+
+template<typename... Ts>
+soa_circular_buffer<Ts...>& soa_circular_buffer<Ts...>::operator = (soa_circular_buffer&& other) noexcept
+{
+    std::swap(storage_, other.storage_);
+    std::swap(storage_size_, other.storage_size_);
+    std::swap(offsets_, other.offsets_);
+    std::swap(capacity_, other.capacity_);
+    std::swap(head_, other.head_);
+    std::swap(tail_, other.tail_);
+    std::swap(contents_size_, other.contents_size_);
+    return *this;
+}
+
+template<typename... Ts>
+void soa_circular_buffer<Ts...>::layout(size_type capacity, std::size_t (&offsets)[column_count + 1]) noexcept
+{
+    const std::size_t sizes[] = { sizeof(Ts)... };
+    std::size_t offset = 0;
+    for(std::size_t i = 0; i < column_count; i++)
+    {
+        offsets[i] = offset;
+        const auto bytes = sizes[i] * capacity;
+        offset += (bytes + column_alignment - 1) / column_alignment * column_alignment;
+    }
+    offsets[column_count] = offset;
+}
+
+template<typename... Ts>
+unsigned char* soa_circular_buffer<Ts...>::allocate(std::size_t bytes)
+{
+    if(bytes == 0)
+        return nullptr;
+    return static_cast<unsigned char*>(::operator new(bytes, std::align_val_t(column_alignment)));
+}
+
+template<typename... Ts>
+void soa_circular_buffer<Ts...>::deallocate(unsigned char* storage) noexcept
+{
+    if(storage != nullptr)
+        ::operator delete(storage, std::align_val_t(column_alignment));
+}
+
+template<typename... Ts>
+template<std::size_t I>
+typename soa_circular_buffer<Ts...>::template column_type<I>*
+soa_circular_buffer<Ts...>::column_begin() noexcept
+{
+    return reinterpret_cast<column_type<I>*>(storage_ + offsets_[I]);
+}
+
+template<typename... Ts>
+template<std::size_t I>
+const typename soa_circular_buffer<Ts...>::template column_type<I>*
+soa_circular_buffer<Ts...>::column_begin() const noexcept
+{
+    return reinterpret_cast<const column_type<I>*>(storage_ + offsets_[I]);
+}
+
+template<typename... Ts>
+template<std::size_t... Is>
+typename soa_circular_buffer<Ts...>::reference
+soa_circular_buffer<Ts...>::row(size_type slot, std::index_sequence<Is...>) noexcept
+{
+    return reference(column_begin<Is>()[slot]...);
+}
+
+template<typename... Ts>
+template<std::size_t... Is>
+typename soa_circular_buffer<Ts...>::const_reference
+soa_circular_buffer<Ts...>::row(size_type slot, std::index_sequence<Is...>) const noexcept
+{
+    return const_reference(column_begin<Is>()[slot]...);
+}
+
+template<typename... Ts>
+template<std::size_t... Is>
+void soa_circular_buffer<Ts...>::store(size_type slot, const row_type& values, std::index_sequence<Is...>) noexcept
+{
+    ((column_begin<Is>()[slot] = std::get<Is>(values)), ...);
+}
+
+template<typename... Ts>
+typename soa_circular_buffer<Ts...>::size_type
+soa_circular_buffer<Ts...>::physical_index(size_type index) const noexcept
+{
+    assert(index < size());
+    const auto mid = capacity_ - head_;
+    return (index < mid)? index + head_ : index - mid;
+}
+
+template<typename... Ts>
+typename soa_circular_buffer<Ts...>::reference
+soa_circular_buffer<Ts...>::at(size_type index)
+{
+    if(index >= size())
+        throw std::out_of_range("Index out of bounds.");
+    return (*this)[index];
+}
+
+template<typename... Ts>
+typename soa_circular_buffer<Ts...>::const_reference
+soa_circular_buffer<Ts...>::at(size_type index) const
+{
+    if(index >= size())
+        throw std::out_of_range("Index out of bounds.");
+    return (*this)[index];
+}
+
+template<typename... Ts>
+void soa_circular_buffer<Ts...>::clear() noexcept
+{
+    head_ = 0;
+    tail_ = 0;
+    contents_size_ = 0;
+}
+
+template<typename... Ts>
+void soa_circular_buffer<Ts...>::push_back(const Ts&... values)
+{
+    push_back(row_type(values...));
+}
+
+template<typename... Ts>
+void soa_circular_buffer<Ts...>::push_back(const row_type& values)
+{
+    store(tail_, values, std::index_sequence_for<Ts...>());
+    tail_ = next_index(tail_);
+    if(is_full())
+        head_ = tail_;
+    else
+        ++contents_size_;
+}
+
+template<typename... Ts>
+void soa_circular_buffer<Ts...>::pop_front()
+{
+    assert(!is_empty());
+    head_ = next_index(head_);
+    --contents_size_;
+}
+
+template<typename... Ts>
+void soa_circular_buffer<Ts...>::pop_front(size_type count)
+{
+    assert(count <= size());
+    head_ += count;
+    if(head_ >= capacity_)
+        head_ -= capacity_;
+    contents_size_ -= count;
+}
+
+template<typename... Ts>
+void soa_circular_buffer<Ts...>::pop_back()
+{
+    assert(!is_empty());
+    tail_ = (tail_ > 0)? tail_ - 1 : capacity_ - 1;
+    --contents_size_;
+}
+
+template<typename... Ts>
+template<std::size_t I>
+typename soa_circular_buffer<Ts...>::template array_range_t<I>
+soa_circular_buffer<Ts...>::array_one()
+{
+    const auto range = std::as_const(*this).template array_one<I>();
+    return std::make_pair(const_cast<column_type<I>*>(range.first), range.second);
+}
+
+template<typename... Ts>
+template<std::size_t I>
+typename soa_circular_buffer<Ts...>::template const_array_range_t<I>
+soa_circular_buffer<Ts...>::array_one() const
+{
+    const auto size = (std::min)(contents_size_, capacity_ - head_);
+    return std::make_pair(column_begin<I>() + head_, size);
+}
+
+template<typename... Ts>
+template<std::size_t I>
+typename soa_circular_buffer<Ts...>::template array_range_t<I>
+soa_circular_buffer<Ts...>::array_two()
+{
+    const auto range = std::as_const(*this).template array_two<I>();
+    return std::make_pair(const_cast<column_type<I>*>(range.first), range.second);
+}
+
+template<typename... Ts>
+template<std::size_t I>
+typename soa_circular_buffer<Ts...>::template const_array_range_t<I>
+soa_circular_buffer<Ts...>::array_two() const
+{
+    const auto size = contents_size_ - (std::min)(contents_size_, capacity_ - head_);
+    return std::make_pair(column_begin<I>(), size);
+}
+
+}   // namespace container
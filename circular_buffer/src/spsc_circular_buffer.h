@@ -0,0 +1,447 @@
+#pragma once
+#include <cassert>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <iterator>
+#include <utility>
+#include <type_traits>
+#if defined(__has_include) && __has_include(<memory_resource>)
+#include <memory_resource>
+#endif
+#include "cache_line.h"
+#include "circular_buffer.h"
+
+namespace container
+{
+
+/*
+    Lock-free circular buffer for exactly one producer thread and one consumer thread.
+
+    - The producer owns tail_ and only calls try_push_back / try_emplace_back.
+    - The consumer owns head_ and calls everything else that observes or removes elements.
+    - One slot is kept free so that head_ == tail_ always means empty,
+      which removes the need for a shared size counter.
+
+    Unlike circular_buffer, pushing never overwrites: a full buffer rejects the element.
+*/
+template<typename T, typename Allocator = std::allocator<T>>
+class spsc_circular_buffer final
+{
+public:
+    using self_type         = spsc_circular_buffer<T, Allocator>;
+    using value_type        = typename std::allocator_traits<Allocator>::value_type;
+    using pointer           = typename std::allocator_traits<Allocator>::pointer;
+    using const_pointer     = typename std::allocator_traits<Allocator>::const_pointer;
+    using reference         = value_type&;
+    using const_reference   = const value_type&;
+    using difference_type   = typename std::allocator_traits<Allocator>::difference_type;
+    using size_type         = typename std::allocator_traits<Allocator>::size_type;
+    using allocator_type    = Allocator;
+
+    using iterator = detail::circular_buffer_iterator<self_type, std::iterator_traits<pointer>>;
+    using const_iterator = detail::circular_buffer_iterator<self_type, std::iterator_traits<const_pointer>>;
+
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    using array_range_t = std::pair<pointer, size_type>;
+    using const_array_range_t = std::pair<const_pointer, size_type>;
+
+    // A run of slots that may wrap around: the part up to the end of the storage, then the rest.
+    using array_ranges_t = std::pair<array_range_t, array_range_t>;
+
+private:
+    using allocator_traits = std::allocator_traits<Allocator>;
+
+public:
+    spsc_circular_buffer() = delete;
+
+    explicit spsc_circular_buffer(size_type capacity, const Allocator& alloc = Allocator())
+        : alloc_(alloc)
+        , array_(allocator_traits::allocate(alloc_, capacity + 1))
+        , array_size_(capacity + 1)
+        , head_(0)
+        , cached_tail_(0)
+        , tail_(0)
+        , cached_head_(0)
+    {
+        assert(capacity > 0);
+    }
+
+    ~spsc_circular_buffer()
+    {
+        clear();
+        allocator_traits::deallocate(alloc_, array_, array_size_);
+    }
+
+    spsc_circular_buffer(const spsc_circular_buffer&) = delete;
+    spsc_circular_buffer& operator = (const spsc_circular_buffer&) = delete;
+
+    spsc_circular_buffer(spsc_circular_buffer&&) = delete;
+    spsc_circular_buffer& operator = (spsc_circular_buffer&&) = delete;
+
+// Producer.
+
+    template<typename U = T>
+    std::enable_if_t<std::is_copy_constructible<U>::value, bool>
+    try_push_back(const_reference item);
+
+    template<typename U = T>
+    std::enable_if_t<std::is_move_constructible<U>::value, bool>
+    try_push_back(value_type&& item);
+
+    template<typename... Args>
+    bool try_emplace_back(Args&&... args);
+
+    // Up to count uninitialized free slots, for constructing elements in place.
+    // The consumer sees nothing until commit_back().
+    array_ranges_t reserve_back(size_type count);
+
+    // Publishes the elements constructed in the first count slots of the last reserve_back().
+    void commit_back(size_type count);
+
+// Consumer.
+
+    reference operator[](size_type index);
+    const_reference operator[](size_type index) const;
+
+    reference front();
+    const_reference front() const;
+
+    bool try_pop_front(reference item);
+    void pop_front();
+
+    // The first count elements, or all of them when there are fewer, to read in place.
+    array_ranges_t peek_front(size_type count);
+
+    // Destroys the first count elements and hands their slots back to the producer.
+    void release_front(size_type count);
+
+    void clear();
+
+    array_range_t array_one();
+    const_array_range_t array_one() const;
+
+    array_range_t array_two();
+    const_array_range_t array_two() const;
+
+    iterator begin(){ return iterator(this, 0); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+
+    iterator end(){ return iterator(this, observed_size()); }
+    const_iterator end() const { return const_iterator(this, observed_size()); }
+
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    reverse_iterator rbegin(){ return reverse_iterator(end()); }
+    const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+
+    reverse_iterator rend(){ return reverse_iterator(begin()); }
+    const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+    const_reverse_iterator crbegin() const { return rbegin(); }
+    const_reverse_iterator crend() const { return rend(); }
+
+// Either side.
+
+    // Exact only when the other side is idle.
+    size_type size() const noexcept;
+
+    bool is_empty() const noexcept;
+    bool is_full() const noexcept;
+
+    size_type capacity() const noexcept { return array_size_ - 1; }
+
+    allocator_type get_allocator() const noexcept { return alloc_; }
+
+private:
+    template<typename... Args>
+    bool push_back_fwd(Args&&... args);
+
+    size_type next_index(size_type index) const noexcept
+    {
+        return (index < (array_size_ - 1))? index + 1 : 0;
+    }
+
+    size_type advance_index(size_type index, size_type count) const noexcept
+    {
+        return (count < array_size_ - index)? index + count : index + count - array_size_;
+    }
+
+    size_type used_slots(size_type head, size_type tail) const noexcept
+    {
+        return (head <= tail)? tail - head : array_size_ - head + tail;
+    }
+
+    size_type free_slots(size_type head, size_type tail) const noexcept
+    {
+        return array_size_ - 1 - used_slots(head, tail);
+    }
+
+    array_ranges_t ranges_from(size_type index, size_type count) noexcept
+    {
+        const auto first_count = (std::min)(count, array_size_ - index);
+        return std::make_pair(std::make_pair(array_ + index, first_count), std::make_pair(array_, count - first_count));
+    }
+
+    size_type observe_tail() const noexcept;
+
+    // The number of elements up to a fresh snapshot of the tail.
+    difference_type observed_size() const noexcept;
+
+private:
+    // Shared, read-only after construction.
+    allocator_type alloc_;
+    pointer array_;
+    size_type array_size_;
+    // Written by the consumer.
+    alignas(detail::cache_line_size) std::atomic<size_type> head_;
+    mutable size_type cached_tail_;
+    // Written by the producer.
+    alignas(detail::cache_line_size) std::atomic<size_type> tail_;
+    size_type cached_head_;
+};
+
+template<typename T, typename Allocator>
+template<typename U>
+std::enable_if_t<std::is_copy_constructible<U>::value, bool>
+spsc_circular_buffer<T, Allocator>::try_push_back(const_reference item)
+{
+    return push_back_fwd(item);
+}
+
+template<typename T, typename Allocator>
+template<typename U>
+std::enable_if_t<std::is_move_constructible<U>::value, bool>
+spsc_circular_buffer<T, Allocator>::try_push_back(value_type&& item)
+{
+    return push_back_fwd(std::move(item));
+}
+
+template<typename T, typename Allocator>
+template<typename... Args>
+bool spsc_circular_buffer<T, Allocator>::try_emplace_back(Args&&... args)
+{
+    return push_back_fwd(std::forward<Args>(args)...);
+}
+
+template<typename T, typename Allocator>
+template<typename... Args>
+bool spsc_circular_buffer<T, Allocator>::push_back_fwd(Args&&... args)
+{
+    const auto tail = tail_.load(std::memory_order_relaxed);
+    const auto next = next_index(tail);
+    if(next == cached_head_)
+    {   // Only touch the consumer's cache line when the buffer looks full.
+        cached_head_ = head_.load(std::memory_order_acquire);
+        if(next == cached_head_)
+            return false;
+    }
+    allocator_traits::construct(alloc_, std::addressof(array_[tail]), std::forward<Args>(args)...);
+    tail_.store(next, std::memory_order_release);
+    return true;
+}
+
+template<typename T, typename Allocator>
+typename spsc_circular_buffer<T, Allocator>::array_ranges_t
+spsc_circular_buffer<T, Allocator>::reserve_back(size_type count)
+{
+    const auto tail = tail_.load(std::memory_order_relaxed);
+    if(free_slots(cached_head_, tail) < count)
+        cached_head_ = head_.load(std::memory_order_acquire);
+    return ranges_from(tail, (std::min)(count, free_slots(cached_head_, tail)));
+}
+
+template<typename T, typename Allocator>
+void spsc_circular_buffer<T, Allocator>::commit_back(size_type count)
+{
+    const auto tail = tail_.load(std::memory_order_relaxed);
+    assert(count <= free_slots(cached_head_, tail));
+    tail_.store(advance_index(tail, count), std::memory_order_release);
+}
+
+template<typename T, typename Allocator>
+typename spsc_circular_buffer<T, Allocator>::size_type
+spsc_circular_buffer<T, Allocator>::observe_tail() const noexcept
+{
+    cached_tail_ = tail_.load(std::memory_order_acquire);
+    return cached_tail_;
+}
+
+template<typename T, typename Allocator>
+typename spsc_circular_buffer<T, Allocator>::difference_type
+spsc_circular_buffer<T, Allocator>::observed_size() const noexcept
+{
+    const auto head = head_.load(std::memory_order_relaxed);
+    const auto tail = observe_tail();
+    return static_cast<difference_type>((head <= tail)? tail - head : array_size_ - head + tail);
+}
+
+template<typename T, typename Allocator>
+typename spsc_circular_buffer<T, Allocator>::reference
+spsc_circular_buffer<T, Allocator>::operator[](size_type index)
+{
+    return const_cast<reference>(std::as_const(*this).operator[](index));
+}
+
+template<typename T, typename Allocator>
+typename spsc_circular_buffer<T, Allocator>::const_reference
+spsc_circular_buffer<T, Allocator>::operator[](size_type index) const
+{
+    assert(index < size());
+    const auto head = head_.load(std::memory_order_relaxed);
+    const auto mid = array_size_ - head;
+    const auto actual_index = (index < mid)? index + head : index - mid;
+    return array_[actual_index];
+}
+
+template<typename T, typename Allocator>
+typename spsc_circular_buffer<T, Allocator>::reference
+spsc_circular_buffer<T, Allocator>::front()
+{
+    return const_cast<reference>(std::as_const(*this).front());
+}
+
+template<typename T, typename Allocator>
+typename spsc_circular_buffer<T, Allocator>::const_reference
+spsc_circular_buffer<T, Allocator>::front() const
+{
+    assert(!is_empty());
+    return array_[head_.load(std::memory_order_relaxed)];
+}
+
+template<typename T, typename Allocator>
+bool spsc_circular_buffer<T, Allocator>::try_pop_front(reference item)
+{
+    const auto head = head_.load(std::memory_order_relaxed);
+    if(head == cached_tail_)
+    {   // Only touch the producer's cache line when the buffer looks empty.
+        if(head == observe_tail())
+            return false;
+    }
+    item = std::move(array_[head]);
+    allocator_traits::destroy(alloc_, std::addressof(array_[head]));
+    head_.store(next_index(head), std::memory_order_release);
+    return true;
+}
+
+template<typename T, typename Allocator>
+void spsc_circular_buffer<T, Allocator>::pop_front()
+{
+    assert(!is_empty());
+    const auto head = head_.load(std::memory_order_relaxed);
+    allocator_traits::destroy(alloc_, std::addressof(array_[head]));
+    head_.store(next_index(head), std::memory_order_release);
+}
+
+template<typename T, typename Allocator>
+typename spsc_circular_buffer<T, Allocator>::array_ranges_t
+spsc_circular_buffer<T, Allocator>::peek_front(size_type count)
+{
+    const auto head = head_.load(std::memory_order_relaxed);
+    if(used_slots(head, cached_tail_) < count)
+        observe_tail();
+    return ranges_from(head, (std::min)(count, used_slots(head, cached_tail_)));
+}
+
+template<typename T, typename Allocator>
+void spsc_circular_buffer<T, Allocator>::release_front(size_type count)
+{
+    const auto head = head_.load(std::memory_order_relaxed);
+    assert(count <= used_slots(head, cached_tail_));
+    if(!std::is_trivially_destructible<value_type>::value)
+    {
+        auto index = head;
+        for(auto n = count; n > 0; --n, index = next_index(index))
+            allocator_traits::destroy(alloc_, std::addressof(array_[index]));
+    }
+    head_.store(advance_index(head, count), std::memory_order_release);
+}
+
+template<typename T, typename Allocator>
+void spsc_circular_buffer<T, Allocator>::clear()
+{
+    auto head = head_.load(std::memory_order_relaxed);
+    const auto tail = observe_tail();
+    while(head != tail)
+    {
+        allocator_traits::destroy(alloc_, std::addressof(array_[head]));
+        head = next_index(head);
+    }
+    head_.store(head, std::memory_order_release);
+}
+
+template<typename T, typename Allocator>
+typename spsc_circular_buffer<T, Allocator>::size_type
+spsc_circular_buffer<T, Allocator>::size() const noexcept
+{
+    const auto head = head_.load(std::memory_order_acquire);
+    const auto tail = tail_.load(std::memory_order_acquire);
+    return (head <= tail)? tail - head : array_size_ - head + tail;
+}
+
+template<typename T, typename Allocator>
+bool spsc_circular_buffer<T, Allocator>::is_empty() const noexcept
+{
+    return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+}
+
+template<typename T, typename Allocator>
+bool spsc_circular_buffer<T, Allocator>::is_full() const noexcept
+{
+    return next_index(tail_.load(std::memory_order_acquire)) == head_.load(std::memory_order_acquire);
+}
+
+/*
+    array_one() takes a fresh snapshot of the producer's tail and array_two() reuses it,
+    so that array_two() always continues exactly where the last array_one() stopped.
+    Likewise end() takes the snapshot that bounds an iteration.
+*/
+template<typename T, typename Allocator>
+typename spsc_circular_buffer<T, Allocator>::array_range_t
+spsc_circular_buffer<T, Allocator>::array_one()
+{
+    const auto range = std::as_const(*this).array_one();
+    return std::make_pair(const_cast<pointer>(range.first), range.second);
+}
+
+template<typename T, typename Allocator>
+typename spsc_circular_buffer<T, Allocator>::const_array_range_t
+spsc_circular_buffer<T, Allocator>::array_one() const
+{
+    const auto head = head_.load(std::memory_order_relaxed);
+    const auto tail = observe_tail();
+    auto size = (head <= tail)? tail - head : array_size_ - head;
+    return std::make_pair(array_ + head, size);
+}
+
+template<typename T, typename Allocator>
+typename spsc_circular_buffer<T, Allocator>::array_range_t
+spsc_circular_buffer<T, Allocator>::array_two()
+{
+    const auto range = std::as_const(*this).array_two();
+    return std::make_pair(const_cast<pointer>(range.first), range.second);
+}
+
+template<typename T, typename Allocator>
+typename spsc_circular_buffer<T, Allocator>::const_array_range_t
+spsc_circular_buffer<T, Allocator>::array_two() const
+{
+    const auto head = head_.load(std::memory_order_relaxed);
+    auto size = (cached_tail_ < head)? cached_tail_ : 0;
+    return std::make_pair(array_, size);
+}
+
+#if defined(__has_include) && __has_include(<memory_resource>)
+namespace pmr
+{
+
+template<typename T>
+using spsc_circular_buffer = container::spsc_circular_buffer<T, std::pmr::polymorphic_allocator<T>>;
+
+}   // namespace pmr
+#endif
+
+}   // namespace container
@@ -0,0 +1,711 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <algorithm>
+#include <memory>
+#include <new>
+#include <iterator>
+#include <utility>
+#include <stdexcept>
+#include <type_traits>
+#include "circular_buffer.h"
+
+namespace container
+{
+
+/*
+    Circular buffer with a compile-time capacity and its storage inside the object.
+
+    Nothing is allocated, so it can live on the stack or be embedded in another object.
+    The API and the iterators are those of circular_buffer, except that there is no allocator.
+    Since the capacity is a constant, the compiler can fold the index wrap for small N.
+
+    Moving moves the elements one by one and leaves the source empty.
+*/
+template<typename T, std::size_t N>
+class static_circular_buffer final
+{
+    static_assert(N > 0, "The capacity must be greater than zero.");
+
+public:
+    using self_type         = static_circular_buffer<T, N>;
+    using value_type        = T;
+    using pointer           = value_type*;
+    using const_pointer     = const value_type*;
+    using reference         = value_type&;
+    using const_reference   = const value_type&;
+    using difference_type   = std::ptrdiff_t;
+    using size_type         = std::size_t;
+
+    using iterator = detail::circular_buffer_iterator<self_type, std::iterator_traits<pointer>>;
+    using const_iterator = detail::circular_buffer_iterator<self_type, std::iterator_traits<const_pointer>>;
+
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    using array_range_t = std::pair<pointer, size_type>;
+    using const_array_range_t = std::pair<const_pointer, size_type>;
+
+public:
+    static_circular_buffer() noexcept
+        : head_(0), tail_(0), contents_size_(0)
+    {}
+
+    ~static_circular_buffer()
+    {
+        clear();
+    }
+
+    static_circular_buffer(const static_circular_buffer& other)
+        : head_(0), tail_(0), contents_size_(0)
+    {
+        copy_elements(other);
+    }
+
+    static_circular_buffer(static_circular_buffer&& other) noexcept(std::is_nothrow_move_constructible<value_type>::value)
+        : head_(0), tail_(0), contents_size_(0)
+    {
+        move_elements(other);
+    }
+
+    static_circular_buffer& operator = (const static_circular_buffer& other)
+    {
+        if(this != &other)
+        {
+            clear();
+            copy_elements(other);
+        }
+        return *this;
+    }
+
+    static_circular_buffer& operator = (static_circular_buffer&& other) noexcept(std::is_nothrow_move_constructible<value_type>::value)
+    {
+        if(this != &other)
+        {
+            clear();
+            move_elements(other);
+        }
+        return *this;
+    }
+
+    reference operator[](size_type index);
+    const_reference operator[](size_type index) const;
+
+    reference at(size_type index);
+    const_reference at(size_type index) const;
+
+    reference front();
+    const_reference front() const;
+
+    reference back();
+    const_reference back() const;
+
+    void clear() noexcept;
+
+    // When full, these overwrite the element at the opposite end.
+    template<typename... Args>
+    reference emplace_front(Args&&... args);
+
+    template<typename... Args>
+    reference emplace_back(Args&&... args);
+
+    template<typename U = T>
+    std::enable_if_t<std::is_copy_constructible<U>::value, void>
+    push_front(const_reference item);
+
+    template<typename U = T>
+    std::enable_if_t<std::is_move_constructible<U>::value, void>
+    push_front(value_type&& item);
+
+    template<typename U = T>
+    std::enable_if_t<std::is_copy_constructible<U>::value, void>
+    push_back(const_reference item);
+
+    template<typename U = T>
+    std::enable_if_t<std::is_move_constructible<U>::value, void>
+    push_back(value_type&& item);
+
+    // Overwrites the oldest elements when the range does not fit.
+    template<typename InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+    void push_back(InputIt first, InputIt last);
+
+    // Appends only what fits into the free space and returns the number of elements appended.
+    size_type insert_back(const_pointer items, size_type count);
+    size_type insert_back(const_array_range_t items);
+
+    void pop_front();
+    void pop_front(size_type count);
+    void pop_back();
+
+    // Copies the first count elements without removing them.
+    template<typename OutputIt>
+    OutputIt copy_out(OutputIt dest, size_type count) const;
+
+    size_type head() const noexcept { return head_; }
+    size_type tail() const noexcept { return tail_; }
+
+    size_type size() const noexcept { return contents_size_; }
+    static constexpr size_type max_size() noexcept { return N; }
+
+    bool is_empty() const noexcept { return contents_size_ == 0; }
+    bool is_full() const noexcept { return contents_size_ == N; }
+
+    static constexpr size_type capacity() noexcept { return N; }
+
+    pointer data() noexcept { return array_begin(); }
+    const_pointer data() const noexcept { return array_begin(); }
+
+    array_range_t array_one();
+    const_array_range_t array_one() const;
+
+    array_range_t array_two();
+    const_array_range_t array_two() const;
+
+    bool is_linearized() const;
+    void linearize();
+
+    iterator begin(){ return iterator(this, 0); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+
+    iterator end(){ return iterator(this, static_cast<difference_type>(size())); }
+    const_iterator end() const { return const_iterator(this, static_cast<difference_type>(size())); }
+
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    reverse_iterator rbegin(){ return reverse_iterator(end()); }
+    const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+
+    reverse_iterator rend(){ return reverse_iterator(begin()); }
+    const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+    const_reverse_iterator crbegin() const { return rbegin(); }
+    const_reverse_iterator crend() const { return rend(); }
+
+private:
+    void copy_elements(const static_circular_buffer& other);
+    void move_elements(static_circular_buffer& other);
+    void destroy_front(size_type count) noexcept;
+
+    static constexpr size_type next_index(size_type index) noexcept { return (index < (N - 1))? index + 1 : 0; }
+    static constexpr size_type prev_index(size_type index) noexcept { return (index > 0)? index - 1 : N - 1; }
+
+    static size_type advance_index(size_type index, size_type count) noexcept;
+
+    // The slot must be free.
+    template<typename... Args>
+    void construct_front(Args&&... args);
+
+    template<typename... Args>
+    void construct_back(Args&&... args);
+
+    template<typename U>
+    void overwrite_front(U&& item, std::true_type);
+
+    template<typename U>
+    void overwrite_front(U&& item, std::false_type);
+
+    template<typename U>
+    void overwrite_back(U&& item, std::true_type);
+
+    template<typename U>
+    void overwrite_back(U&& item, std::false_type);
+
+    template<typename U>
+    void push_front_fwd(U&& item);
+
+    template<typename U>
+    void push_back_fwd(U&& item);
+
+    template<typename InputIt>
+    void push_back_range(InputIt first, InputIt last, std::input_iterator_tag);
+
+    template<typename ForwardIt>
+    void push_back_range(ForwardIt first, ForwardIt last, std::forward_iterator_tag);
+
+    template<typename InputIt>
+    InputIt construct_back_n(InputIt first, size_type count, std::true_type);
+
+    template<typename InputIt>
+    InputIt construct_back_n(InputIt first, size_type count, std::false_type);
+
+    static void relocate(pointer dest, pointer src, size_type count);
+
+    pointer array_begin() noexcept { return std::launder(reinterpret_cast<pointer>(storage_)); }
+    const_pointer array_begin() const noexcept { return std::launder(reinterpret_cast<const_pointer>(storage_)); }
+
+    pointer array_end() noexcept { return array_begin() + N; }
+    const_pointer array_end() const noexcept { return array_begin() + N; }
+
+private:
+    // Uninitialized; only [head_, head_ + contents_size_) is alive.
+    alignas(value_type) unsigned char storage_[sizeof(value_type) * N];
+    size_type head_;
+    size_type tail_;
+    size_type contents_size_;
+};
+
+// Keeps the elements at the same positions as in other.
+// If a copy throws, the copies made so far are destroyed and the buffer is left empty.
+template<typename T, std::size_t N>
+void static_circular_buffer<T, N>::copy_elements(const static_circular_buffer& other)
+{
+    head_ = other.head_;
+    tail_ = other.head_;
+    try
+    {
+        for(const auto& item : other)
+            construct_back(item);
+    }
+    catch(...)
+    {
+        clear();
+        throw;
+    }
+}
+
+template<typename T, std::size_t N>
+void static_circular_buffer<T, N>::move_elements(static_circular_buffer& other)
+{
+    head_ = other.head_;
+    tail_ = other.head_;
+    for(auto& item : other)
+        construct_back(std::move_if_noexcept(item));
+    other.clear();
+}
+
+// Destroys the first count elements without moving the head.
+template<typename T, std::size_t N>
+void static_circular_buffer<T, N>::destroy_front(size_type count) noexcept
+{
+    if(std::is_trivially_destructible<value_type>::value)
+        return;
+    for(auto index = head_; count > 0; --count, index = next_index(index))
+        array_begin()[index].~value_type();
+}
+
+template<typename T, std::size_t N>
+typename static_circular_buffer<T, N>::size_type
+static_circular_buffer<T, N>::advance_index(size_type index, size_type count) noexcept
+{
+    assert(index < N);
+    assert(count <= N);
+    return (count < N - index)? index + count : index + count - N;
+}
+
+template<typename T, std::size_t N>
+typename static_circular_buffer<T, N>::reference
+static_circular_buffer<T, N>::operator[](size_type index)
+{
+    return const_cast<reference>(std::as_const(*this).operator[](index));
+}
+
+template<typename T, std::size_t N>
+typename static_circular_buffer<T, N>::const_reference
+static_circular_buffer<T, N>::operator[](size_type index) const
+{
+    assert(!is_empty());
+    assert(index < size());
+    const auto mid = N - head_;
+    const auto actual_index = (index < mid)? index + head_ : index - mid;
+    return array_begin()[actual_index];
+}
+
+template<typename T, std::size_t N>
+typename static_circular_buffer<T, N>::reference
+static_circular_buffer<T, N>::at(size_type index)
+{
+    return const_cast<reference>(std::as_const(*this).at(index));
+}
+
+template<typename T, std::size_t N>
+typename static_circular_buffer<T, N>::const_reference
+static_circular_buffer<T, N>::at(size_type index) const
+{
+    if(index >= size())
+        throw std::out_of_range("Index out of bounds.");
+    return (*this)[index];
+}
+
+template<typename T, std::size_t N>
+typename static_circular_buffer<T, N>::reference
+static_circular_buffer<T, N>::front()
+{
+    return const_cast<reference>(std::as_const(*this).front());
+}
+
+template<typename T, std::size_t N>
+typename static_circular_buffer<T, N>::const_reference
+static_circular_buffer<T, N>::front() const
+{
+    assert(!is_empty());
+    return array_begin()[head_];
+}
+
+template<typename T, std::size_t N>
+typename static_circular_buffer<T, N>::reference
+static_circular_buffer<T, N>::back()
+{
+    return const_cast<reference>(std::as_const(*this).back());
+}
+
+template<typename T, std::size_t N>
+typename static_circular_buffer<T, N>::const_reference
+static_circular_buffer<T, N>::back() const
+{
+    assert(!is_empty());
+    return array_begin()[prev_index(tail_)];
+}
+
+template<typename T, std::size_t N>
+void static_circular_buffer<T, N>::clear() noexcept
+{
+    destroy_front(contents_size_);
+    head_ = 0;
+    tail_ = 0;
+    contents_size_ = 0;
+}
+
+template<typename T, std::size_t N>
+template<typename... Args>
+void static_circular_buffer<T, N>::construct_front(Args&&... args)
+{
+    assert(!is_full());
+    const auto index = prev_index(head_);
+    ::new(static_cast<void*>(array_begin() + index)) value_type(std::forward<Args>(args)...);
+    head_ = index;
+    ++contents_size_;
+}
+
+template<typename T, std::size_t N>
+template<typename... Args>
+void static_circular_buffer<T, N>::construct_back(Args&&... args)
+{
+    assert(!is_full());
+    ::new(static_cast<void*>(array_begin() + tail_)) value_type(std::forward<Args>(args)...);
+    tail_ = next_index(tail_);
+    ++contents_size_;
+}
+
+// Full buffer, assignable element: the back element is reused in place.
+template<typename T, std::size_t N>
+template<typename U>
+void static_circular_buffer<T, N>::overwrite_front(U&& item, std::true_type)
+{
+    const auto index = prev_index(head_);
+    array_begin()[index] = std::forward<U>(item);
+    head_ = index;
+    tail_ = index;
+}
+
+// Full buffer, non-assignable element: the item is built first because it may refer to the evicted element.
+template<typename T, std::size_t N>
+template<typename U>
+void static_circular_buffer<T, N>::overwrite_front(U&& item, std::false_type)
+{
+    value_type temp(std::forward<U>(item));
+    pop_back();
+    construct_front(std::move(temp));
+}
+
+template<typename T, std::size_t N>
+template<typename U>
+void static_circular_buffer<T, N>::overwrite_back(U&& item, std::true_type)
+{
+    array_begin()[tail_] = std::forward<U>(item);
+    tail_ = next_index(tail_);
+    head_ = tail_;
+}
+
+template<typename T, std::size_t N>
+template<typename U>
+void static_circular_buffer<T, N>::overwrite_back(U&& item, std::false_type)
+{
+    value_type temp(std::forward<U>(item));
+    pop_front();
+    construct_back(std::move(temp));
+}
+
+template<typename T, std::size_t N>
+template<typename... Args>
+typename static_circular_buffer<T, N>::reference
+static_circular_buffer<T, N>::emplace_front(Args&&... args)
+{
+    if(is_full())
+        overwrite_front(value_type(std::forward<Args>(args)...), std::is_move_assignable<value_type>());
+    else
+        construct_front(std::forward<Args>(args)...);
+    return front();
+}
+
+template<typename T, std::size_t N>
+template<typename... Args>
+typename static_circular_buffer<T, N>::reference
+static_circular_buffer<T, N>::emplace_back(Args&&... args)
+{
+    if(is_full())
+        overwrite_back(value_type(std::forward<Args>(args)...), std::is_move_assignable<value_type>());
+    else
+        construct_back(std::forward<Args>(args)...);
+    return back();
+}
+
+template<typename T, std::size_t N>
+template<typename U>
+std::enable_if_t<std::is_copy_constructible<U>::value, void>
+static_circular_buffer<T, N>::push_front(const_reference item)
+{
+    push_front_fwd(item);
+}
+
+template<typename T, std::size_t N>
+template<typename U>
+std::enable_if_t<std::is_move_constructible<U>::value, void>
+static_circular_buffer<T, N>::push_front(value_type&& item)
+{
+    push_front_fwd(std::move(item));
+}
+
+template<typename T, std::size_t N>
+template<typename U>
+std::enable_if_t<std::is_copy_constructible<U>::value, void>
+static_circular_buffer<T, N>::push_back(const_reference item)
+{
+    push_back_fwd(item);
+}
+
+template<typename T, std::size_t N>
+template<typename U>
+std::enable_if_t<std::is_move_constructible<U>::value, void>
+static_circular_buffer<T, N>::push_back(value_type&& item)
+{
+    push_back_fwd(std::move(item));
+}
+
+template<typename T, std::size_t N>
+template<typename U>
+void static_circular_buffer<T, N>::push_front_fwd(U&& item)
+{
+    if(is_full())
+        overwrite_front(std::forward<U>(item), std::is_assignable<reference, U&&>());
+    else
+        construct_front(std::forward<U>(item));
+}
+
+template<typename T, std::size_t N>
+template<typename U>
+void static_circular_buffer<T, N>::push_back_fwd(U&& item)
+{
+    if(is_full())
+        overwrite_back(std::forward<U>(item), std::is_assignable<reference, U&&>());
+    else
+        construct_back(std::forward<U>(item));
+}
+
+template<typename T, std::size_t N>
+template<typename InputIt, typename>
+void static_circular_buffer<T, N>::push_back(InputIt first, InputIt last)
+{
+    push_back_range(first, last, typename std::iterator_traits<InputIt>::iterator_category());
+}
+
+template<typename T, std::size_t N>
+template<typename InputIt>
+void static_circular_buffer<T, N>::push_back_range(InputIt first, InputIt last, std::input_iterator_tag)
+{
+    for(; first != last; ++first)
+        push_back_fwd(*first);
+}
+
+template<typename T, std::size_t N>
+template<typename ForwardIt>
+void static_circular_buffer<T, N>::push_back_range(ForwardIt first, ForwardIt last, std::forward_iterator_tag)
+{
+    auto count = static_cast<size_type>(std::distance(first, last));
+    if(count >= N)
+    {   // Only the last N elements survive.
+        std::advance(first, static_cast<difference_type>(count - N));
+        clear();
+        count = N;
+    }
+    else if(count > N - contents_size_)
+    {   // Evict the oldest elements to make room.
+        pop_front(count - (N - contents_size_));
+    }
+
+    construct_back_n(first, count, detail::is_memcpy_copyable<ForwardIt, pointer>());
+}
+
+template<typename T, std::size_t N>
+typename static_circular_buffer<T, N>::size_type
+static_circular_buffer<T, N>::insert_back(const_pointer items, size_type count)
+{
+    count = (std::min)(count, N - contents_size_);
+    construct_back_n(items, count, detail::is_memcpy_copyable<const_pointer, pointer>());
+    return count;
+}
+
+template<typename T, std::size_t N>
+typename static_circular_buffer<T, N>::size_type
+static_circular_buffer<T, N>::insert_back(const_array_range_t items)
+{
+    return insert_back(items.first, items.second);
+}
+
+// Constructs count (<= free space) elements at the tail in at most two contiguous segments.
+template<typename T, std::size_t N>
+template<typename InputIt>
+InputIt static_circular_buffer<T, N>::construct_back_n(InputIt first, size_type count, std::true_type)
+{
+    assert(count <= N - contents_size_);
+    const auto first_count = (std::min)(count, N - tail_);
+    first = detail::copy_n_impl(first, first_count, array_begin() + tail_, std::true_type()).first;
+    first = detail::copy_n_impl(first, count - first_count, array_begin(), std::true_type()).first;
+    tail_ = advance_index(tail_, count);
+    contents_size_ += count;
+    return first;
+}
+
+template<typename T, std::size_t N>
+template<typename InputIt>
+InputIt static_circular_buffer<T, N>::construct_back_n(InputIt first, size_type count, std::false_type)
+{
+    for(; count > 0; --count, ++first)
+        construct_back(*first);
+    return first;
+}
+
+template<typename T, std::size_t N>
+void static_circular_buffer<T, N>::pop_front()
+{
+    assert(!is_empty());
+    array_begin()[head_].~value_type();
+    head_ = next_index(head_);
+    --contents_size_;
+}
+
+template<typename T, std::size_t N>
+void static_circular_buffer<T, N>::pop_front(size_type count)
+{
+    assert(count <= size());
+    destroy_front(count);
+    head_ = advance_index(head_, count);
+    contents_size_ -= count;
+}
+
+template<typename T, std::size_t N>
+void static_circular_buffer<T, N>::pop_back()
+{
+    assert(!is_empty());
+    tail_ = prev_index(tail_);
+    array_begin()[tail_].~value_type();
+    --contents_size_;
+}
+
+template<typename T, std::size_t N>
+template<typename OutputIt>
+OutputIt static_circular_buffer<T, N>::copy_out(OutputIt dest, size_type count) const
+{
+    assert(count <= size());
+    const auto first_count = (std::min)(count, N - head_);
+    dest = detail::copy_n(array_begin() + head_, first_count, dest).second;
+    dest = detail::copy_n(array_begin(), count - first_count, dest).second;
+    return dest;
+}
+
+template<typename T, std::size_t N>
+typename static_circular_buffer<T, N>::array_range_t
+static_circular_buffer<T, N>::array_one()
+{
+    const auto range = std::as_const(*this).array_one();
+    return std::make_pair(const_cast<pointer>(range.first), range.second);
+}
+
+template<typename T, std::size_t N>
+typename static_circular_buffer<T, N>::const_array_range_t
+static_circular_buffer<T, N>::array_one() const
+{
+    assert(!is_empty());
+    auto size = (head_ < tail_)? tail_ - head_ : N - head_;
+    return std::make_pair(array_begin() + head_, size);
+}
+
+template<typename T, std::size_t N>
+typename static_circular_buffer<T, N>::array_range_t
+static_circular_buffer<T, N>::array_two()
+{
+    const auto range = std::as_const(*this).array_two();
+    return std::make_pair(const_cast<pointer>(range.first), range.second);
+}
+
+template<typename T, std::size_t N>
+typename static_circular_buffer<T, N>::const_array_range_t
+static_circular_buffer<T, N>::array_two() const
+{
+    assert(!is_empty());
+    auto size = (tail_ > head_)? 0 : tail_;
+    return std::make_pair(array_begin(), size);
+}
+
+template<typename T, std::size_t N>
+bool static_circular_buffer<T, N>::is_linearized() const
+{
+    return head_ == 0;
+}
+
+/*
+    There is no spare storage to move the elements into, so when the buffer is not full
+    the first segment is moved down into the gap right behind the second one
+    and the now contiguous elements are rotated in place.
+
+        [B.. gap A..]  ->  [B.. A.. gap]  ->  [A.. B.. gap]
+
+    Moving into the gap destroys each source slot as it goes, which is only safe when the move cannot throw.
+    Otherwise the elements are copied into a temporary buffer and back. Nothing changes if the first copy throws;
+    if copying back throws, the buffer keeps the elements copied back so far.
+    A full buffer is rotated with swaps, which keep every slot alive even if one throws.
+*/
+template<typename T, std::size_t N>
+void static_circular_buffer<T, N>::linearize()
+{
+    if(is_linearized())
+        return;
+    if(is_full())
+    {   // Every slot is alive.
+        std::rotate(array_begin(), array_begin() + head_, array_end());
+    }
+    else if(!std::is_nothrow_move_constructible<value_type>::value)
+    {
+        static_circular_buffer temp;
+        for(const auto& item : *this)
+            temp.construct_back(item);
+        clear();
+        move_elements(temp);
+        return;
+    }
+    else if(head_ < tail_)
+    {
+        relocate(array_begin(), array_begin() + head_, contents_size_);
+    }
+    else if(!is_empty())
+    {
+        relocate(array_begin() + tail_, array_begin() + head_, N - head_);
+        std::rotate(array_begin(), array_begin() + tail_, array_begin() + contents_size_);
+    }
+    head_ = 0;
+    tail_ = (is_full())? 0 : contents_size_;
+}
+
+// Moves count elements to a lower address; the destination may overlap the source.
+template<typename T, std::size_t N>
+void static_circular_buffer<T, N>::relocate(pointer dest, pointer src, size_type count)
+{
+    assert(dest < src);
+    for(; count > 0; --count, ++src, ++dest)
+    {
+        ::new(static_cast<void*>(dest)) value_type(std::move_if_noexcept(*src));
+        src->~value_type();
+    }
+}
+
+}   // namespace container
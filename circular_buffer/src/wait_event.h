@@ -0,0 +1,155 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#if defined(__linux__)
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <mutex>
+#include <condition_variable>
+#endif
+
+namespace container
+{
+
+namespace detail
+{
+
+/*
+    Sleep/wake primitive for threads that check their condition under an external lock.
+
+    A waiter registers and reads the epoch while holding the lock, releases the lock and
+    sleeps until the epoch moves on, so a notification that arrives in between is not lost.
+    Notifying only bumps the epoch and asks for a wake-up when a registered waiter has not
+    been woken yet, so the common case costs no system call, and a burst of notifications
+    wakes a sleeper once instead of once per notification.
+
+    Linux sleeps in futex(2) on the epoch itself; elsewhere a condition_variable is used.
+*/
+class wait_event final
+{
+public:
+    using epoch_type = std::uint32_t;
+
+    wait_event() noexcept
+        : epoch_(0), waiters_(0), signals_(0)
+    {}
+
+    wait_event(const wait_event&) = delete;
+    wait_event& operator = (const wait_event&) = delete;
+
+// The external lock must be held.
+
+    epoch_type prepare_wait() noexcept
+    {
+        ++waiters_;
+        return epoch_.load(std::memory_order_relaxed);
+    }
+
+    // After waking up, whatever the reason.
+    void finish_wait() noexcept
+    {
+        --waiters_;
+        // Consuming a signal that was meant for another waiter only costs a redundant wake-up later.
+        if(signals_ > 0)
+            --signals_;
+    }
+
+    // These return whether wake_one / wake_all has to be called, preferably after the lock is released.
+    bool notify_one() noexcept
+    {
+        if(waiters_ <= signals_)
+            return false;
+        ++signals_;
+        epoch_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool notify_all() noexcept
+    {
+        if(waiters_ <= signals_)
+            return false;
+        signals_ = waiters_;
+        epoch_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+// The external lock must not be held.
+
+    // Returns when the epoch differs from the given one, or spuriously.
+    void wait(epoch_type epoch) noexcept;
+    void wait_for(epoch_type epoch, std::chrono::nanoseconds timeout) noexcept;
+
+    void wake_one() noexcept { wake(1); }
+    void wake_all() noexcept { wake((std::numeric_limits<int>::max)()); }
+
+private:
+    void wake(int count) noexcept;
+
+private:
+    std::atomic<epoch_type> epoch_;
+    std::size_t waiters_;   // Registered and not back under the lock yet.
+    std::size_t signals_;   // Wake-ups requested for them.
+#if !defined(__linux__)
+    std::mutex mutex_;
+    std::condition_variable cv_;
+#endif
+};
+
+#if defined(__linux__)
+
+inline void wait_event::wait(epoch_type epoch) noexcept
+{
+    ::syscall(SYS_futex, reinterpret_cast<epoch_type*>(&epoch_), FUTEX_WAIT_PRIVATE, epoch, nullptr, nullptr, 0);
+}
+
+inline void wait_event::wait_for(epoch_type epoch, std::chrono::nanoseconds timeout) noexcept
+{
+    if(timeout.count() <= 0)
+        return;
+    const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+    timespec relative;
+    relative.tv_sec = static_cast<std::time_t>(seconds.count());
+    relative.tv_nsec = static_cast<long>((timeout - seconds).count());
+    ::syscall(SYS_futex, reinterpret_cast<epoch_type*>(&epoch_), FUTEX_WAIT_PRIVATE, epoch, &relative, nullptr, 0);
+}
+
+inline void wait_event::wake(int count) noexcept
+{
+    ::syscall(SYS_futex, reinterpret_cast<epoch_type*>(&epoch_), FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+}
+
+#else
+
+inline void wait_event::wait(epoch_type epoch) noexcept
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this, epoch]() { return epoch_.load(std::memory_order_relaxed) != epoch; });
+}
+
+inline void wait_event::wait_for(epoch_type epoch, std::chrono::nanoseconds timeout) noexcept
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait_for(lock, timeout, [this, epoch]() { return epoch_.load(std::memory_order_relaxed) != epoch; });
+}
+
+inline void wait_event::wake(int count) noexcept
+{
+    // Taking the mutex orders the wake-up after a waiter that is about to sleep.
+    { std::lock_guard<std::mutex> lock(mutex_); }
+    if(count == 1)
+        cv_.notify_one();
+    else
+        cv_.notify_all();
+}
+
+#endif
+
+}   // namespace detail
+
+}   // namespace container
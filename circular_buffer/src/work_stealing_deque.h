@@ -0,0 +1,263 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <atomic>
+#include <memory>
+#include <new>
+#include <type_traits>
+#if defined(__has_include) && __has_include(<memory_resource>)
+#include <memory_resource>
+#endif
+#include "cache_line.h"
+#include "power_of_2.h"
+
+namespace container
+{
+
+/*
+    Lock-free work-stealing deque.
+
+    - The owner thread calls push_back / try_pop_back and works at the bottom, last in first out.
+    - Any other thread calls try_steal, which takes the oldest element from the top
+      with a compare-and-swap. Only the owner and thieves racing for the last element contend.
+
+    Unlike circular_buffer, pushing never overwrites: a full ring is replaced by one twice as large.
+    Thieves may still be reading the old ring, so it is kept until the deque is destroyed;
+    together the retired rings are smaller than the current one.
+    Thieves copy a slot before they know whether they won it, so T must be trivially copyable,
+    typically a pointer to a task. The capacity is rounded up to a power of two.
+
+    See: David Chase and Yossi Lev, "Dynamic Circular Work-Stealing Deque",
+         Nhat Minh Le et al., "Correct and Efficient Work-Stealing for Weak Memory Models".
+*/
+template<typename T, typename Allocator = std::allocator<T>>
+class work_stealing_deque final
+{
+public:
+    using value_type        = typename std::allocator_traits<Allocator>::value_type;
+    using reference         = value_type&;
+    using const_reference   = const value_type&;
+    using size_type         = typename std::allocator_traits<Allocator>::size_type;
+    using allocator_type    = Allocator;
+
+    static_assert(std::is_trivially_copyable<value_type>::value, "T must be trivially copyable.");
+
+private:
+    // Positions only grow; a signed type lets bottom - 1 fall below top on an empty deque.
+    using index_type = std::make_signed_t<size_type>;
+
+    struct ring
+    {
+        ring(std::atomic<value_type>* s, size_type capacity, ring* p) noexcept
+            : slots(s), mask(capacity - 1), previous(p)
+        {}
+
+        size_type capacity() const noexcept { return mask + 1; }
+
+        std::atomic<value_type>& at(index_type pos) noexcept { return slots[static_cast<size_type>(pos) & mask]; }
+
+        std::atomic<value_type>* slots;
+        size_type mask;
+        ring* previous;     // The next older retired ring.
+    };
+
+    using allocator_traits = std::allocator_traits<Allocator>;
+    using slot_allocator_type = typename allocator_traits::template rebind_alloc<std::atomic<value_type>>;
+    using slot_allocator_traits = std::allocator_traits<slot_allocator_type>;
+    using ring_allocator_type = typename allocator_traits::template rebind_alloc<ring>;
+    using ring_allocator_traits = std::allocator_traits<ring_allocator_type>;
+
+public:
+    work_stealing_deque() = delete;
+
+    explicit work_stealing_deque(size_type capacity, const Allocator& alloc = Allocator());
+    ~work_stealing_deque();
+
+    work_stealing_deque(const work_stealing_deque&) = delete;
+    work_stealing_deque& operator = (const work_stealing_deque&) = delete;
+
+    work_stealing_deque(work_stealing_deque&&) = delete;
+    work_stealing_deque& operator = (work_stealing_deque&&) = delete;
+
+// Owner.
+    // Grows the ring when full.
+    void push_back(const_reference item);
+
+    // Takes the newest element. Returns false when the deque is empty.
+    bool try_pop_back(reference item);
+
+    size_type capacity() const noexcept { return ring_.load(std::memory_order_relaxed)->capacity(); }
+
+// Thieves.
+    // Takes the oldest element. Returns false when the deque is empty
+    // or another thread took the element first; either way the thief should look elsewhere.
+    bool try_steal(reference item);
+
+// Any thread.
+    // Exact only when no other thread is pushing, popping or stealing.
+    size_type size() const noexcept;
+
+    bool is_empty() const noexcept { return size() == 0; }
+
+    allocator_type get_allocator() const noexcept { return alloc_; }
+
+private:
+    ring* allocate_ring(size_type capacity, ring* previous);
+    void deallocate_ring(ring* r) noexcept;
+
+    ring* grow(ring* current, index_type top, index_type bottom);
+
+private:
+    allocator_type alloc_;
+    ring* retired_;     // Owner only.
+    alignas(detail::cache_line_size) std::atomic<index_type> top_;
+    alignas(detail::cache_line_size) std::atomic<index_type> bottom_;
+    std::atomic<ring*> ring_;
+};
+
+template<typename T, typename Allocator>
+work_stealing_deque<T, Allocator>::work_stealing_deque(size_type capacity, const Allocator& alloc)
+    : alloc_(alloc)
+    , retired_(nullptr)
+    , top_(0)
+    , bottom_(0)
+    , ring_(nullptr)
+{
+    assert(capacity > 0);
+    ring_.store(allocate_ring(detail::round_up_to_power_of_2(capacity), nullptr), std::memory_order_relaxed);
+}
+
+template<typename T, typename Allocator>
+work_stealing_deque<T, Allocator>::~work_stealing_deque()
+{
+    deallocate_ring(ring_.load(std::memory_order_relaxed));
+    while(retired_ != nullptr)
+    {
+        auto previous = retired_->previous;
+        deallocate_ring(retired_);
+        retired_ = previous;
+    }
+}
+
+template<typename T, typename Allocator>
+typename work_stealing_deque<T, Allocator>::ring*
+work_stealing_deque<T, Allocator>::allocate_ring(size_type capacity, ring* previous)
+{
+    slot_allocator_type slot_alloc(alloc_);
+    auto slots = slot_allocator_traits::allocate(slot_alloc, capacity);
+    for(size_type i = 0; i < capacity; i++)
+        ::new(static_cast<void*>(slots + i)) std::atomic<value_type>();
+
+    ring_allocator_type ring_alloc(alloc_);
+    ring* r;
+    try
+    {
+        r = ring_allocator_traits::allocate(ring_alloc, 1);
+    }
+    catch(...)
+    {
+        slot_allocator_traits::deallocate(slot_alloc, slots, capacity);
+        throw;
+    }
+    return ::new(static_cast<void*>(r)) ring(slots, capacity, previous);
+}
+
+template<typename T, typename Allocator>
+void work_stealing_deque<T, Allocator>::deallocate_ring(ring* r) noexcept
+{
+    slot_allocator_type slot_alloc(alloc_);
+    slot_allocator_traits::deallocate(slot_alloc, r->slots, r->capacity());
+    r->~ring();
+    ring_allocator_type ring_alloc(alloc_);
+    ring_allocator_traits::deallocate(ring_alloc, r, 1);
+}
+
+template<typename T, typename Allocator>
+typename work_stealing_deque<T, Allocator>::ring*
+work_stealing_deque<T, Allocator>::grow(ring* current, index_type top, index_type bottom)
+{
+    // The old ring joins the retired list only once the new one exists.
+    auto next = allocate_ring(2 * current->capacity(), current);
+    for(auto pos = top; pos < bottom; pos++)
+        next->at(pos).store(current->at(pos).load(std::memory_order_relaxed), std::memory_order_relaxed);
+    ring_.store(next, std::memory_order_release);
+    retired_ = current;
+    return next;
+}
+
+template<typename T, typename Allocator>
+void work_stealing_deque<T, Allocator>::push_back(const_reference item)
+{
+    const auto bottom = bottom_.load(std::memory_order_relaxed);
+    const auto top = top_.load(std::memory_order_acquire);
+    auto r = ring_.load(std::memory_order_relaxed);
+    if(static_cast<size_type>(bottom - top) >= r->capacity())
+        r = grow(r, top, bottom);
+    r->at(bottom).store(item, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom_.store(bottom + 1, std::memory_order_relaxed);
+}
+
+template<typename T, typename Allocator>
+bool work_stealing_deque<T, Allocator>::try_pop_back(reference item)
+{
+    // Claim the bottom element first, so that thieves stop short of it.
+    const auto bottom = bottom_.load(std::memory_order_relaxed) - 1;
+    auto r = ring_.load(std::memory_order_relaxed);
+    bottom_.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto top = top_.load(std::memory_order_relaxed);
+
+    if(top > bottom)
+    {   // When empty.
+        bottom_.store(bottom + 1, std::memory_order_relaxed);
+        return false;
+    }
+
+    item = r->at(bottom).load(std::memory_order_relaxed);
+    if(top < bottom)
+        return true;
+
+    // The last element, which a thief may be taking as well.
+    const bool won = top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    bottom_.store(bottom + 1, std::memory_order_relaxed);
+    return won;
+}
+
+template<typename T, typename Allocator>
+bool work_stealing_deque<T, Allocator>::try_steal(reference item)
+{
+    auto top = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const auto bottom = bottom_.load(std::memory_order_acquire);
+    if(top >= bottom)
+        return false;
+
+    // The slot may be overwritten once the owner wraps around; the copy is kept only if the CAS wins.
+    const auto copy = ring_.load(std::memory_order_acquire)->at(top).load(std::memory_order_relaxed);
+    if(!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        return false;
+    item = copy;
+    return true;
+}
+
+template<typename T, typename Allocator>
+typename work_stealing_deque<T, Allocator>::size_type
+work_stealing_deque<T, Allocator>::size() const noexcept
+{
+    const auto top = top_.load(std::memory_order_acquire);
+    const auto bottom = bottom_.load(std::memory_order_acquire);
+    return (bottom > top)? static_cast<size_type>(bottom - top) : 0;
+}
+
+#if defined(__has_include) && __has_include(<memory_resource>)
+namespace pmr
+{
+
+template<typename T>
+using work_stealing_deque = container::work_stealing_deque<T, std::pmr::polymorphic_allocator<T>>;
+
+}   // namespace pmr
+#endif
+
+}   // namespace container
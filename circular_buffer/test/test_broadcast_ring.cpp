@@ -0,0 +1,216 @@
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <memory_resource>
+#include <gtest/gtest.h>
+#include <broadcast_ring.h>
+
+namespace
+{
+
+class BroadcastRingTest : public ::testing::Test {};
+
+using namespace container;
+
+TEST_F(BroadcastRingTest, construct)
+{
+    broadcast_ring<int> ring(5, 3, wait_strategy::yield);
+    EXPECT_EQ(8, ring.capacity());
+    EXPECT_EQ(3, ring.consumer_count());
+    EXPECT_EQ(wait_strategy::yield, ring.strategy());
+    EXPECT_EQ(0, ring.published());
+    EXPECT_EQ(false, ring.is_closed());
+}
+
+TEST_F(BroadcastRingTest, every_consumer_sees_every_element)
+{
+    broadcast_ring<int> ring(4, 2);
+    ring.push(1);
+    ring.push(2);
+    EXPECT_EQ(2, ring.available(0));
+    EXPECT_EQ(2, ring.available(1));
+
+    std::vector<int> first;
+    EXPECT_EQ(2, ring.poll(0, [&first](int value) { first.push_back(value); }));
+    EXPECT_EQ((std::vector<int>{ 1, 2 }), first);
+    EXPECT_EQ(0, ring.poll(0, [](int) {}));
+
+    // The other cursor has not moved.
+    ring.push(3);
+    std::vector<int> second;
+    EXPECT_EQ(3, ring.poll(1, [&second](int value) { second.push_back(value); }));
+    EXPECT_EQ((std::vector<int>{ 1, 2, 3 }), second);
+    EXPECT_EQ(1, ring.available(0));
+}
+
+TEST_F(BroadcastRingTest, gated_by_slowest_consumer)
+{
+    broadcast_ring<int> ring(4, 2);
+    for(int i = 0; i < 4; i++)
+        EXPECT_EQ(true, ring.try_push(i));
+    EXPECT_EQ(false, ring.try_push(4));
+
+    // Still full until every consumer has moved on.
+    ring.poll(0, [](int) {});
+    EXPECT_EQ(false, ring.try_push(4));
+
+    ring.poll(1, [](int) {});
+    EXPECT_EQ(true, ring.try_push(4));
+
+    // Wraps around.
+    std::vector<int> values;
+    ring.poll(0, [&values](int value) { values.push_back(value); });
+    EXPECT_EQ((std::vector<int>{ 4 }), values);
+}
+
+TEST_F(BroadcastRingTest, push_range)
+{
+    broadcast_ring<int> ring(8, 1);
+    std::vector<int> items(6);
+    std::iota(items.begin(), items.end(), 0);
+    ring.push(items.begin(), items.end());
+    ring.poll(0, [](int) {});
+    ring.push(items.begin(), items.end());
+
+    // Two segments.
+    std::vector<int> values;
+    EXPECT_EQ(6, ring.poll(0, [&values](int value) { values.push_back(value); }));
+    EXPECT_EQ(items, values);
+}
+
+TEST_F(BroadcastRingTest, lifetime)
+{
+    auto item = std::make_shared<int>(0);
+    {
+        broadcast_ring<std::shared_ptr<int>> ring(2, 1);
+        for(int i = 0; i < 5; i++)
+        {
+            ring.push(item);
+            ring.poll(0, [](const std::shared_ptr<int>&) {});
+        }
+        // Consumed elements stay in their slots until overwritten.
+        EXPECT_EQ(3, item.use_count());
+    }
+    EXPECT_EQ(1, item.use_count());
+}
+
+TEST_F(BroadcastRingTest, emplace_string)
+{
+    broadcast_ring<std::string> ring(2, 1);
+    ring.emplace(3u, 'a');
+    ring.push(std::string("bb"));
+    std::string joined;
+    ring.poll(0, [&joined](const std::string& value) { joined += value; });
+    EXPECT_EQ("aaabb", joined);
+}
+
+TEST_F(BroadcastRingTest, throwing_copy)
+{
+    // Copies throw once the budget runs out; moves never do.
+    struct item_type
+    {
+        static int& budget() { static int value = -1; return value; }
+        static int& live() { static int value = 0; return value; }
+
+        explicit item_type(int v) : value(v) { ++live(); }
+        item_type(const item_type& other) : value(other.value)
+        {
+            if(budget() == 0)
+                throw std::runtime_error("copy");
+            --budget();
+            ++live();
+        }
+        item_type(item_type&& other) noexcept : value(other.value) { ++live(); }
+        ~item_type() { --live(); }
+
+        int value;
+    };
+
+    {
+        broadcast_ring<item_type> ring(4, 1);
+        const std::vector<item_type> items{ item_type(1), item_type(2), item_type(3) };
+        int sum = 0;
+        const auto add = [&sum](const item_type& item) { sum += item.value; };
+        for(int i = 0; i < 4; i++)
+            ring.push(items[0]);
+        ring.poll(0, add);
+        EXPECT_EQ(7, item_type::live());
+
+        // The slot keeps its old element and nothing is published.
+        item_type::budget() = 0;
+        EXPECT_THROW(ring.push(items[1]), std::runtime_error);
+        EXPECT_EQ(0, ring.poll(0, add));
+        EXPECT_EQ(7, item_type::live());
+
+        // A range publishes the elements before the one that threw.
+        item_type::budget() = 2;
+        EXPECT_THROW(ring.push(items.begin(), items.end()), std::runtime_error);
+        item_type::budget() = -1;
+        EXPECT_EQ(2, ring.poll(0, add));
+        EXPECT_EQ(4 + 1 + 2, sum);
+        EXPECT_EQ(7, item_type::live());
+    }
+    EXPECT_EQ(0, item_type::live());
+}
+
+TEST_F(BroadcastRingTest, threads)
+{
+    constexpr std::uint64_t count = 20000;
+    constexpr std::uint64_t expected = count * (count - 1) / 2;
+
+    for(const auto strategy : { wait_strategy::busy_spin, wait_strategy::yield, wait_strategy::block })
+    {
+        broadcast_ring<std::uint64_t> ring(1024, 3, strategy);
+        std::vector<std::uint64_t> sums(3, 0);
+        std::vector<int> ordered(3, 0);
+
+        std::vector<std::thread> consumers;
+        for(std::size_t c = 0; c < 3; c++)
+        {
+            consumers.emplace_back([&, c]()
+            {
+                std::uint64_t next = 0;
+                std::uint64_t sum = 0;
+                bool in_order = true;
+                while(ring.consume(c, [&](std::uint64_t value)
+                {
+                    in_order = in_order && (value == next);
+                    next++;
+                    sum += value;
+                }) > 0)
+                    ;
+                sums[c] = sum;
+                ordered[c] = in_order;
+            });
+        }
+        for(std::uint64_t i = 0; i < count; i++)
+            ring.push(i);
+        ring.close();
+        for(auto& consumer : consumers)
+            consumer.join();
+
+        for(std::size_t c = 0; c < 3; c++)
+        {
+            EXPECT_EQ(expected, sums[c]);
+            EXPECT_EQ(true, ordered[c] != 0);
+        }
+    }
+}
+
+TEST_F(BroadcastRingTest, pmr)
+{
+    std::pmr::monotonic_buffer_resource resource;
+    pmr::broadcast_ring<int> ring(4, 1, wait_strategy::block, &resource);
+    ring.push(7);
+    int value = 0;
+    EXPECT_EQ(1, ring.consume(0, [&value](int v) { value = v; }));
+    EXPECT_EQ(7, value);
+    ring.close();
+    EXPECT_EQ(0, ring.consume(0, [](int) {}));
+}
+
+}   // namespace
@@ -0,0 +1,193 @@
+#include <cerrno>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <byte_ring.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace
+{
+
+class ByteRingTest : public ::testing::Test {};
+
+using namespace container;
+
+template<typename Ring>
+std::string contents(const Ring& ring)
+{
+    const auto one = ring.array_one();
+    const auto two = ring.array_two();
+    return std::string(one.first, one.second) + std::string(two.first, two.second);
+}
+
+// [i j _ _ e f g h]
+byte_ring make_wrapped()
+{
+    byte_ring ring(8);
+    ring.append("abcdef", 6);
+    ring.consume(4);
+    ring.append("ghij", 4);
+    return ring;
+}
+
+TEST_F(ByteRingTest, segments)
+{
+    byte_ring ring(8);
+    EXPECT_EQ(0, ring.array_one().second);
+    EXPECT_EQ(0, ring.array_two().second);
+    EXPECT_EQ(8, ring.free_one().second);
+    EXPECT_EQ(0, ring.free_two().second);
+
+    // [a b c d e f _ _] -> [_ _ _ d e f _ _] -> [i j k d e f g h]
+    EXPECT_EQ(6, ring.append("abcdef", 6));
+    ring.consume(3);
+    EXPECT_EQ(2, ring.free_one().second);
+    EXPECT_EQ(3, ring.free_two().second);
+
+    EXPECT_EQ(5, ring.append("ghijkl", 6));
+    EXPECT_EQ("defghijk", contents(ring));
+    EXPECT_EQ(5, ring.array_one().second);
+    EXPECT_EQ(3, ring.array_two().second);
+    EXPECT_EQ(true, ring.is_full());
+
+    // The head goes back to the start once drained.
+    ring.consume(8);
+    EXPECT_EQ(true, ring.is_empty());
+    EXPECT_EQ(8, ring.free_one().second);
+}
+
+TEST_F(ByteRingTest, commit_write_and_consume)
+{
+    // [_ _ c d e f _ _]
+    byte_ring ring(8);
+    ring.append("abcdef", 6);
+    ring.consume(2);
+
+    auto one = ring.free_one();
+    auto two = ring.free_two();
+    EXPECT_EQ(2, one.second);
+    EXPECT_EQ(2, two.second);
+
+    one.first[0] = 'x';
+    one.first[1] = 'y';
+    two.first[0] = 'z';
+    ring.commit_write(3);
+    EXPECT_EQ("cdefxyz", contents(ring));
+
+    ring.consume(5);
+    EXPECT_EQ("yz", contents(ring));
+}
+
+TEST_F(ByteRingTest, pipe)
+{
+    int fds[2];
+    ASSERT_EQ(0, ::pipe(fds));
+
+    // Both calls use two iovecs.
+    auto ring = make_wrapped();
+    EXPECT_EQ(6, ring.write_to(fds[1]));
+    EXPECT_EQ(true, ring.is_empty());
+
+    // [_ _ _ _ _ f _ _]
+    ring.append("abcdef", 6);
+    ring.consume(5);
+    EXPECT_EQ(6, ring.read_from(fds[0]));
+    EXPECT_EQ("fefghij", contents(ring));
+    EXPECT_EQ(4, ring.array_two().second);
+
+    // End of file.
+    ::close(fds[1]);
+    EXPECT_EQ(0, ring.read_from(fds[0]));
+    ::close(fds[0]);
+}
+
+TEST_F(ByteRingTest, socketpair)
+{
+    int fds[2];
+    ASSERT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+    ASSERT_EQ(0, ::fcntl(fds[0], F_SETFL, O_NONBLOCK));
+
+    byte_ring ring(7);
+    EXPECT_EQ(-1, ring.read_from(fds[0]));
+    EXPECT_EQ(true, (errno == EAGAIN) || (errno == EWOULDBLOCK));
+
+    // Stream more than the capacity through the ring, wrapping on every round.
+    std::string sent;
+    std::string received;
+    for(int i = 0; i < 100; i++)
+        sent += std::to_string(i);
+
+    std::size_t offset = 0;
+    while(received.size() < sent.size())
+    {
+        if(offset < sent.size())
+        {
+            const auto n = ::write(fds[1], sent.data() + offset, (std::min<std::size_t>)(5, sent.size() - offset));
+            ASSERT_EQ(true, n > 0);
+            offset += static_cast<std::size_t>(n);
+        }
+        while(!ring.is_full() && (ring.read_from(fds[0]) > 0))
+            ;
+        const auto take = (std::min<std::size_t>)(3, ring.size());
+        const auto text = contents(ring);
+        received.append(text, 0, take);
+        ring.consume(take);
+    }
+    EXPECT_EQ(sent, received);
+
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+
+TEST_F(ByteRingTest, move)
+{
+    auto ring = make_wrapped();
+    byte_ring other(std::move(ring));
+    EXPECT_EQ("efghij", contents(other));
+    EXPECT_EQ(0, ring.capacity());
+
+    byte_ring third(1);
+    third = std::move(other);
+    EXPECT_EQ("efghij", contents(third));
+}
+
+#if defined(__has_include) && __has_include(<memory_resource>)
+TEST_F(ByteRingTest, pmr_move)
+{
+    std::pmr::monotonic_buffer_resource resource1;
+    std::pmr::monotonic_buffer_resource resource2;
+
+    // [i j _ _ e f g h]
+    pmr::byte_ring ring(8, &resource1);
+    ring.append("abcdef", 6);
+    ring.consume(4);
+    ring.append("ghij", 4);
+
+    {   // When both allocators are equal, the storage is taken over.
+        pmr::byte_ring other(4, &resource1);
+        const auto data = ring.array_two().first;
+        other = std::move(ring);
+        EXPECT_EQ("efghij", contents(other));
+        EXPECT_EQ(data, other.array_two().first);
+        EXPECT_EQ(0, ring.capacity());
+        ring = std::move(other);
+    }
+    {   // When both allocators are different, the bytes are copied into storage from the own allocator.
+        pmr::byte_ring other(4, &resource2);
+        other = std::move(ring);
+        EXPECT_EQ("efghij", contents(other));
+        EXPECT_EQ(8, other.capacity());
+        EXPECT_EQ(&resource2, other.get_allocator().resource());
+        EXPECT_EQ(0, ring.capacity());
+
+        // A moved-from ring leaves the target empty.
+        other = std::move(ring);
+        EXPECT_EQ(0, other.capacity());
+        EXPECT_EQ(true, other.is_empty());
+    }
+}
+#endif
+
+}   // namespace
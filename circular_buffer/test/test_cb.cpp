@@ -1,3 +1,10 @@
+#include <string>
+#include <stdexcept>
+#include <vector>
+#include <list>
+#include <iterator>
+#include <memory>
+#include <algorithm>
 #include <gtest/gtest.h>
 #include <gtest/gtest-spi.h>
 #include <circular_buffer.h>
@@ -586,6 +593,625 @@ TEST_F(CBTest, linearize)
     EXPECT_EQ(3, *(cp + 2));
 }
 
+TEST_F(CBTest, linearize_not_full)
+{
+    {   // When the elements are in one segment.
+        circular_buffer<int> cb(5);
+        for(int i = 0; i < 4; i++)
+            cb.push_back(i);
+        cb.pop_front(2);
+
+        const auto storage = cb.data();
+        cb.linearize();
+        EXPECT_EQ(storage, cb.data());
+        EXPECT_EQ(true, cb.is_linearized());
+        EXPECT_EQ(2, cb.tail());
+        EXPECT_EQ((std::vector<int>{ 2, 3 }), cb.to_vector());
+    }
+    {   // When they wrap around.
+        circular_buffer<std::string> cb(6);
+        for(int i = 0; i < 8; i++)
+        {
+            cb.push_back(std::to_string(i));
+            if(cb.size() > 4)
+                cb.pop_front();
+        }
+        EXPECT_EQ(false, cb.is_linearized());
+
+        const auto storage = cb.data();
+        cb.linearize();
+        EXPECT_EQ(storage, cb.data());
+        EXPECT_EQ(0, cb.head());
+        EXPECT_EQ(4, cb.tail());
+        EXPECT_EQ((std::vector<std::string>{ "4", "5", "6", "7" }), std::vector<std::string>(cb.data(), cb.data() + 4));
+
+        // Still usable afterwards.
+        cb.push_back("8");
+        cb.push_back("9");
+        cb.push_back("10");
+        EXPECT_EQ((std::vector<std::string>{ "5", "6", "7", "8", "9", "10" }), cb.to_vector());
+    }
+    {
+        circular_buffer<int> cb(3);
+        cb.push_back(0);
+        cb.pop_front();
+        cb.linearize();
+        EXPECT_EQ(true, cb.is_linearized());
+        EXPECT_EQ(true, cb.is_empty());
+    }
+}
+
+TEST_F(CBTest, copy_linearized)
+{
+    circular_buffer<int> cb(4);
+    const auto& c_cb = cb;
+    EXPECT_EQ(true, c_cb.to_vector().empty());
+
+    for(int i = 0; i < 6; i++)
+        cb.push_back(i);
+
+    int dest[4] = {};
+    EXPECT_EQ(dest + 4, c_cb.copy_linearized(dest));
+    EXPECT_EQ(2, dest[0]);
+    EXPECT_EQ(5, dest[3]);
+    EXPECT_EQ((std::vector<int>{ 2, 3, 4, 5 }), c_cb.to_vector());
+
+    // Nothing moved.
+    EXPECT_EQ(false, cb.is_linearized());
+    EXPECT_EQ(2, cb.head());
+
+    std::list<int> out;
+    cb.copy_linearized(std::back_inserter(out));
+    EXPECT_EQ((std::list<int>{ 2, 3, 4, 5 }), out);
+}
+
+TEST_F(CBTest, push_back_range)
+{
+    {
+        circular_buffer<int> cb(5);
+        const int items[] = { 1, 2, 3 };
+
+        cb.push_back(std::begin(items), std::end(items));
+        EXPECT_EQ(3, cb.size());
+        EXPECT_EQ(0, cb.head());
+        EXPECT_EQ(3, cb.tail());
+
+        // Wraps around and overwrites the oldest elements.
+        cb.push_back(std::begin(items), std::end(items));
+        EXPECT_EQ(5, cb.size());
+        EXPECT_EQ(1, cb.head());
+        EXPECT_EQ(1, cb.tail());
+        EXPECT_EQ((std::vector<int>{ 2, 3, 1, 2, 3 }), std::vector<int>(cb.begin(), cb.end()));
+    }
+    {
+        circular_buffer<int> cb(3);
+        const std::vector<int> items{ 1, 2, 3, 4, 5 };
+
+        cb.push_back(0);
+        cb.push_back(items.begin(), items.end());
+        EXPECT_EQ(3, cb.size());
+        EXPECT_EQ((std::vector<int>{ 3, 4, 5 }), std::vector<int>(cb.begin(), cb.end()));
+    }
+    {
+        circular_buffer<std::string> cb(3);
+        const std::list<std::string> items{ "a", "b" };
+
+        cb.push_back("x");
+        cb.push_back("y");
+        cb.push_back(items.begin(), items.end());
+        EXPECT_EQ((std::vector<std::string>{ "y", "a", "b" }), std::vector<std::string>(cb.begin(), cb.end()));
+    }
+}
+
+TEST_F(CBTest, insert_back)
+{
+    circular_buffer<int> cb(5);
+    const int items[] = { 1, 2, 3, 4 };
+
+    cb.push_back(0);
+    cb.pop_front();
+
+    EXPECT_EQ(4, cb.insert_back(items, 4));
+    // Never overwrites.
+    EXPECT_EQ(1, cb.insert_back(std::make_pair(&items[0], std::size_t(4))));
+    EXPECT_EQ(0, cb.insert_back(items, 4));
+
+    EXPECT_EQ(5, cb.size());
+    EXPECT_EQ(1, cb.head());
+    EXPECT_EQ(1, cb.tail());
+    EXPECT_EQ((std::vector<int>{ 1, 2, 3, 4, 1 }), std::vector<int>(cb.begin(), cb.end()));
+}
+
+TEST_F(CBTest, pop_front_count)
+{
+#if !defined(NDEBUG)
+    {
+        circular_buffer<int> cb(3);
+        cb.push_back(0);
+
+        EXPECT_DEATH({ cb.pop_front(2); }, "");
+    }
+#endif
+    {
+        circular_buffer<int> cb(4);
+        const int items[] = { 1, 2, 3, 4, 5, 6 };
+
+        cb.push_back(std::begin(items), std::end(items));
+        cb.pop_front(3);
+        EXPECT_EQ(1, cb.size());
+        EXPECT_EQ(3, cb.head());
+        EXPECT_EQ(6, cb.front());
+
+        cb.pop_front(0);
+        EXPECT_EQ(1, cb.size());
+
+        cb.pop_front(1);
+        EXPECT_EQ(true, cb.is_empty());
+    }
+}
+
+TEST_F(CBTest, reserve_back_and_commit_back)
+{
+    // [_ _ 2 3 _] -> [7 _ 2 3 5 6]
+    circular_buffer<std::string> cb(5);
+    for(int i = 0; i < 4; i++)
+        cb.push_back(std::to_string(i));
+    cb.pop_front(2);
+
+    auto slots = cb.reserve_back(8);
+    EXPECT_EQ(1, slots.first.second);
+    EXPECT_EQ(2, slots.second.second);
+    EXPECT_EQ(cb.data() + 4, slots.first.first);
+    EXPECT_EQ(cb.data(), slots.second.first);
+
+    // Only the constructed slots are committed.
+    ::new(static_cast<void*>(slots.first.first)) std::string("4");
+    ::new(static_cast<void*>(slots.second.first)) std::string("5");
+    cb.commit_back(2);
+    EXPECT_EQ(4, cb.size());
+    EXPECT_EQ("2", cb.front());
+    EXPECT_EQ("5", cb.back());
+
+    slots = cb.reserve_back(8);
+    EXPECT_EQ(1, slots.first.second);
+    EXPECT_EQ(0, slots.second.second);
+    ::new(static_cast<void*>(slots.first.first)) std::string("6");
+    cb.commit_back(1);
+    EXPECT_EQ(true, cb.is_full());
+
+    // A full buffer has nothing to reserve.
+    slots = cb.reserve_back(8);
+    EXPECT_EQ(0, slots.first.second + slots.second.second);
+}
+
+TEST_F(CBTest, peek_front_and_release_front)
+{
+    // [5 6 _ 3 4]
+    auto item = std::make_shared<int>(0);
+    circular_buffer<std::shared_ptr<int>> cb(5);
+    for(int i = 0; i < 7; i++)
+        cb.push_back(std::make_shared<int>(i));
+    cb.pop_front();
+    cb.push_back(item);
+
+    const auto& c_cb = cb;
+    auto items = c_cb.peek_front(3);
+    EXPECT_EQ(2, items.first.second);
+    EXPECT_EQ(1, items.second.second);
+    EXPECT_EQ(3, *items.first.first[0]);
+    EXPECT_EQ(4, *items.first.first[1]);
+    EXPECT_EQ(5, *items.second.first[0]);
+
+    // Moving out in place, then releasing the moved-from elements.
+    auto moved = std::move(cb.peek_front(1).first.first[0]);
+    EXPECT_EQ(3, *moved);
+    cb.release_front(4);
+    EXPECT_EQ(1, cb.size());
+    EXPECT_EQ(2, item.use_count());
+
+    items = c_cb.peek_front(8);
+    EXPECT_EQ(1, items.first.second + items.second.second);
+    cb.release_front(1);
+    EXPECT_EQ(1, item.use_count());
+    EXPECT_EQ(0, c_cb.peek_front(8).first.second);
+}
+
+TEST_F(CBTest, copy_out)
+{
+    circular_buffer<float> cb(4);
+    const auto& c_cb = cb;
+    const float items[] = { 1.f, 2.f, 3.f, 4.f, 5.f, 6.f };
+
+    cb.push_back(std::begin(items), std::end(items));
+
+    float dest[4] = {};
+    EXPECT_EQ(dest + 4, c_cb.copy_out(dest, 4));
+    EXPECT_EQ(3.f, dest[0]);
+    EXPECT_EQ(4.f, dest[1]);
+    EXPECT_EQ(5.f, dest[2]);
+    EXPECT_EQ(6.f, dest[3]);
+
+    // Does not remove.
+    EXPECT_EQ(4, cb.size());
+
+    std::vector<double> out;
+    cb.copy_out(std::back_inserter(out), 3);
+    EXPECT_EQ((std::vector<double>{ 3.0, 4.0, 5.0 }), out);
+}
+
+TEST_F(CBTest, emplace_back)
+{
+    // Neither default constructible nor assignable.
+    struct item_type
+    {
+        item_type(int n, std::string s) : a(n), b(std::move(s)) {}
+        item_type(const item_type&) = default;
+        item_type& operator = (const item_type&) = delete;
+        const int a;
+        const std::string b;
+    };
+
+    circular_buffer<item_type> cb(2);
+
+    EXPECT_EQ(1, cb.emplace_back(1, "one").a);
+    EXPECT_EQ("two", cb.emplace_back(2, "two").b);
+    EXPECT_EQ(true, cb.is_full());
+
+    // The oldest element is overwritten.
+    EXPECT_EQ(3, cb.emplace_back(3, "three").a);
+    EXPECT_EQ(2, cb.size());
+    EXPECT_EQ(2, cb.front().a);
+    EXPECT_EQ(3, cb.back().a);
+}
+
+TEST_F(CBTest, emplace_front)
+{
+    circular_buffer<std::string> cb(2);
+
+    EXPECT_EQ("aa", cb.emplace_front(std::size_t(2), 'a'));
+    EXPECT_EQ("bbb", cb.emplace_front(std::size_t(3), 'b'));
+    EXPECT_EQ("c", cb.emplace_front(std::size_t(1), 'c'));
+    EXPECT_EQ(2, cb.size());
+    EXPECT_EQ("c", cb.front());
+    EXPECT_EQ("bbb", cb.back());
+}
+
+TEST_F(CBTest, element_lifetime)
+{
+    auto item = std::make_shared<int>(0);
+    {
+        // Construction does not create any element.
+        circular_buffer<std::shared_ptr<int>> cb(1000);
+        EXPECT_EQ(1, item.use_count());
+
+        cb.push_back(item);
+        cb.push_back(item);
+        cb.push_front(item);
+        EXPECT_EQ(4, item.use_count());
+
+        cb.pop_front();
+        cb.pop_back();
+        EXPECT_EQ(2, item.use_count());
+
+        cb.push_back(item);
+        cb.clear();
+        EXPECT_EQ(1, item.use_count());
+        EXPECT_EQ(1000, cb.capacity());
+
+        // Elements overwritten while full are released.
+        circular_buffer<std::shared_ptr<int>> small(2);
+        small.push_back(item);
+        small.push_back(item);
+        small.push_back(std::make_shared<int>(1));
+        small.push_back(std::make_shared<int>(2));
+        EXPECT_EQ(1, item.use_count());
+
+        cb.push_back(item);
+        cb.push_back(item);
+        cb.pop_front(2);
+        EXPECT_EQ(1, item.use_count());
+
+        cb.push_back(item);
+        cb.push_back(item);
+        auto copy = cb;
+        EXPECT_EQ(5, item.use_count());
+    }
+    EXPECT_EQ(1, item.use_count());
+}
+
+TEST_F(CBTest, linearize_non_trivial)
+{
+    circular_buffer<std::string> cb(4);
+    cb.push_back("1");
+    cb.push_back("2");
+    cb.push_back("3");
+    cb.push_back("4");
+    cb.pop_front();
+    cb.pop_front();
+    cb.push_back("5");
+
+    cb.linearize();
+    EXPECT_EQ(true, cb.is_linearized());
+    EXPECT_EQ(3, cb.size());
+    EXPECT_EQ("3", cb.data()[0]);
+    EXPECT_EQ("4", cb.data()[1]);
+    EXPECT_EQ("5", cb.data()[2]);
+}
+
+TEST_F(CBTest, linearize_throwing)
+{
+    // Copies throw once the budget runs out; there is no move constructor to fall back on.
+    struct item_type
+    {
+        static int& budget() { static int value = -1; return value; }
+        static int& live() { static int value = 0; return value; }
+
+        explicit item_type(int v) : value(v) { ++live(); }
+        item_type(const item_type& other) : value(other.value)
+        {
+            if(budget() == 0)
+                throw std::runtime_error("copy");
+            --budget();
+            ++live();
+        }
+        item_type& operator = (const item_type&) = default;
+        ~item_type() { --live(); }
+
+        int value;
+    };
+
+    {   // [5 _ _ 0 1 2 3 4]
+        circular_buffer<item_type> cb(8);
+        for(int i = 0; i < 3; i++)
+            cb.push_back(item_type(-1));
+        for(int i = 0; i < 3; i++)
+            cb.pop_front();
+        for(int i = 0; i < 6; i++)
+            cb.push_back(item_type(i));
+        ASSERT_EQ(3, cb.head());
+        ASSERT_EQ(6, cb.size());
+
+        // Nothing changes when the second copy throws.
+        item_type::budget() = 1;
+        EXPECT_THROW(cb.linearize(), std::runtime_error);
+        item_type::budget() = -1;
+        EXPECT_EQ(false, cb.is_linearized());
+        EXPECT_EQ(6, item_type::live());
+        for(int i = 0; i < 6; i++)
+            EXPECT_EQ(i, cb[static_cast<std::size_t>(i)].value);
+
+        cb.linearize();
+        EXPECT_EQ(true, cb.is_linearized());
+        for(int i = 0; i < 6; i++)
+            EXPECT_EQ(i, cb.data()[i].value);
+    }
+    EXPECT_EQ(0, item_type::live());
+}
+
+TEST_F(CBTest, set_capacity)
+{
+    // [5 6 _ 3 4] -> [3 4 5 6 _ _ _ _]
+    circular_buffer<std::string> cb(5);
+    for(int i = 0; i < 7; i++)
+        cb.push_back(std::to_string(i));
+    cb.pop_front();
+
+    cb.set_capacity(8);
+    EXPECT_EQ(8, cb.capacity());
+    EXPECT_EQ(true, cb.is_linearized());
+    EXPECT_EQ(4, cb.size());
+    EXPECT_EQ("3", cb.data()[0]);
+    EXPECT_EQ("4", cb.data()[1]);
+    EXPECT_EQ("5", cb.data()[2]);
+    EXPECT_EQ("6", cb.data()[3]);
+
+    // The newest elements are kept.
+    cb.set_capacity(2);
+    EXPECT_EQ(2, cb.capacity());
+    EXPECT_EQ(2, cb.size());
+    EXPECT_EQ("5", cb.front());
+    EXPECT_EQ("6", cb.back());
+    cb.push_back("7");
+    EXPECT_EQ("6", cb.front());
+    EXPECT_EQ("7", cb.back());
+
+    // [7 6] -> [6 7]; the same capacity still linearizes.
+    EXPECT_EQ(false, cb.is_linearized());
+    cb.set_capacity(2);
+    EXPECT_EQ(2, cb.capacity());
+    EXPECT_EQ(true, cb.is_linearized());
+    EXPECT_EQ("6", cb.data()[0]);
+    EXPECT_EQ("7", cb.data()[1]);
+}
+
+TEST_F(CBTest, reserve)
+{
+    circular_buffer<int> cb(4);
+    cb.push_back(1);
+    cb.push_back(2);
+
+    cb.reserve(2);
+    EXPECT_EQ(4, cb.capacity());
+    cb.reserve(16);
+    EXPECT_EQ(16, cb.capacity());
+    EXPECT_EQ(2, cb.size());
+    EXPECT_EQ(1, cb.front());
+    EXPECT_EQ(2, cb.back());
+}
+
+TEST_F(CBTest, shrink_to_fit)
+{
+    auto item = std::make_shared<int>(0);
+    circular_buffer<std::shared_ptr<int>> cb(100);
+    for(int i = 0; i < 100; i++)
+        cb.push_back(item);
+    cb.pop_front(97);
+    EXPECT_EQ(4, item.use_count());
+
+    cb.shrink_to_fit();
+    EXPECT_EQ(3, cb.capacity());
+    EXPECT_EQ(3, cb.size());
+    EXPECT_EQ(true, cb.is_full());
+    EXPECT_EQ(4, item.use_count());
+
+    cb.clear();
+    cb.shrink_to_fit();
+    EXPECT_EQ(1, cb.capacity());
+    EXPECT_EQ(1, item.use_count());
+}
+
+TEST_F(CBTest, growth_limit)
+{
+    circular_buffer<int> cb(2);
+    EXPECT_EQ(0, cb.growth_limit());
+
+    cb.set_growth_limit(6);
+    for(int i = 0; i < 3; i++)
+        cb.push_back(i);
+    EXPECT_EQ(4, cb.capacity());
+    cb.push_front(-1);
+    EXPECT_EQ(4, cb.capacity());
+    cb.emplace_back(3);
+    EXPECT_EQ(6, cb.capacity());
+    cb.emplace_front(-2);
+    EXPECT_EQ(6, cb.capacity());
+    EXPECT_EQ(6, cb.size());
+
+    // Overwrites once the limit is reached.
+    cb.push_back(4);
+    EXPECT_EQ(6, cb.capacity());
+    EXPECT_EQ(-1, cb.front());
+    EXPECT_EQ(4, cb.back());
+
+    // The pushed item may be an element of the buffer itself.
+    circular_buffer<std::string> cbs(1);
+    cbs.set_growth_limit(8);
+    cbs.push_back(std::string(32, 'a'));
+    cbs.push_back(cbs.front());
+    cbs.push_front(cbs.back());
+    EXPECT_EQ(4, cbs.capacity());
+    for(const auto& s : cbs)
+        EXPECT_EQ(std::string(32, 'a'), s);
+
+    // A range grows the buffer as far as needed.
+    circular_buffer<int> cbr(2);
+    cbr.set_growth_limit(100);
+    const std::vector<int> v(10, 7);
+    cbr.push_back(v.cbegin(), v.cend());
+    EXPECT_EQ(10, cbr.capacity());
+    EXPECT_EQ(10, cbr.size());
+    cbr.push_back(v.cbegin(), v.cend());
+    EXPECT_EQ(20, cbr.capacity());
+    EXPECT_EQ(20, cbr.size());
+
+    // Copies keep the limit.
+    const auto copy = cbr;
+    EXPECT_EQ(100, copy.growth_limit());
+}
+
+TEST_F(CBTest, inline_storage)
+{
+    // Counts what reaches the upstream resource.
+    class counting_resource : public std::pmr::memory_resource
+    {
+    public:
+        int allocations = 0;
+        int deallocations = 0;
+
+    private:
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override
+        {
+            ++allocations;
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+        void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override
+        {
+            ++deallocations;
+            std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+        }
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+        {
+            return this == &other;
+        }
+    };
+
+    counting_resource resource;
+    {
+        pmr::circular_buffer<std::string, 4> cb(4, &resource);
+        EXPECT_EQ(true, cb.is_inline());
+        for(int i = 0; i < 6; i++)
+            cb.push_back(std::to_string(i));
+        EXPECT_EQ(0, resource.allocations);
+        EXPECT_EQ("2", cb.front());
+        EXPECT_EQ("5", cb.back());
+
+        // Above InlineN the allocator takes over, and below it the inline storage again.
+        cb.set_capacity(8);
+        EXPECT_EQ(false, cb.is_inline());
+        EXPECT_EQ(1, resource.allocations);
+        EXPECT_EQ(4, cb.size());
+        EXPECT_EQ("2", cb.front());
+        cb.push_back("6");
+        cb.set_capacity(3);
+        EXPECT_EQ(true, cb.is_inline());
+        EXPECT_EQ(1, resource.deallocations);
+        EXPECT_EQ(3, cb.size());
+        EXPECT_EQ("4", cb.front());
+        EXPECT_EQ("6", cb.back());
+
+        // Growth leaves the inline storage once it is outgrown.
+        cb.set_growth_limit(16);
+        for(int i = 7; i < 10; i++)
+            cb.push_back(std::to_string(i));
+        EXPECT_EQ(false, cb.is_inline());
+        EXPECT_EQ(6, cb.size());
+        EXPECT_EQ("4", cb.front());
+        EXPECT_EQ("9", cb.back());
+    }
+    EXPECT_EQ(resource.allocations, resource.deallocations);
+}
+
+TEST_F(CBTest, inline_storage_move_copy)
+{
+    using buffer_type = circular_buffer<std::string, std::allocator<std::string>, 4>;
+
+    // [4 5 2 3]
+    buffer_type cb(4);
+    for(int i = 0; i < 6; i++)
+        cb.push_back(std::to_string(i));
+
+    const buffer_type copy(cb);
+    EXPECT_EQ(true, copy.is_inline());
+    EXPECT_EQ(true, std::equal(cb.cbegin(), cb.cend(), copy.cbegin(), copy.cend()));
+
+    // The elements are moved into the inline storage of the new buffer.
+    buffer_type moved(std::move(cb));
+    EXPECT_EQ(true, moved.is_inline());
+    EXPECT_EQ(0, cb.capacity());
+    EXPECT_EQ(0, cb.size());
+    EXPECT_EQ(2, moved.head());
+    EXPECT_EQ(true, std::equal(copy.cbegin(), copy.cend(), moved.cbegin(), moved.cend()));
+
+    // Between inline and allocated storage, in both directions.
+    buffer_type large(6);
+    for(int i = 0; i < 6; i++)
+        large.push_back(std::string(32, static_cast<char>('a' + i)));
+    EXPECT_EQ(false, large.is_inline());
+    moved = large;
+    EXPECT_EQ(false, moved.is_inline());
+    EXPECT_EQ(6, moved.size());
+    EXPECT_EQ(std::string(32, 'f'), moved.back());
+
+    moved = copy;
+    EXPECT_EQ(true, moved.is_inline());
+    EXPECT_EQ(true, std::equal(copy.cbegin(), copy.cend(), moved.cbegin(), moved.cend()));
+
+    large = std::move(moved);
+    EXPECT_EQ(true, large.is_inline());
+    EXPECT_EQ("2", large.front());
+    EXPECT_EQ("5", large.back());
+}
+
 TEST_F(CBTest, iterator_bounds)
 {
 #if defined(NDEBUG)
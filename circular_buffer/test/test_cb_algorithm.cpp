@@ -0,0 +1,96 @@
+#include <vector>
+#include <string>
+#include <iterator>
+#include <gtest/gtest.h>
+#include <circular_buffer.h>
+#include <static_circular_buffer.h>
+#include <spsc_circular_buffer.h>
+#include <circular_buffer_algorithm.h>
+
+namespace
+{
+
+class CBAlgorithmTest : public ::testing::Test {};
+
+using namespace container;
+
+// [5 6 _ 3 4]
+circular_buffer<int> make_wrapped()
+{
+    circular_buffer<int> cb(5);
+    for(int i = 0; i < 7; i++)
+        cb.push_back(i);
+    cb.pop_front();
+    return cb;
+}
+
+TEST_F(CBAlgorithmTest, for_each)
+{
+    auto cb = make_wrapped();
+    EXPECT_EQ(2, cb.array_one().second);
+    EXPECT_EQ(2, cb.array_two().second);
+
+    std::vector<int> visited;
+    container::for_each(cb, [&visited](int& item) { visited.push_back(item); item *= 10; });
+    EXPECT_EQ((std::vector<int>{ 3, 4, 5, 6 }), visited);
+    EXPECT_EQ((std::vector<int>{ 30, 40, 50, 60 }), std::vector<int>(cb.begin(), cb.end()));
+
+    circular_buffer<int> empty(3);
+    int count = 0;
+    container::for_each(empty, [&count](int) { count++; });
+    EXPECT_EQ(0, count);
+}
+
+TEST_F(CBAlgorithmTest, transform)
+{
+    const auto cb = make_wrapped();
+
+    std::vector<std::string> out;
+    container::transform(cb, std::back_inserter(out), [](int item) { return std::to_string(item); });
+    EXPECT_EQ((std::vector<std::string>{ "3", "4", "5", "6" }), out);
+}
+
+TEST_F(CBAlgorithmTest, accumulate)
+{
+    const auto cb = make_wrapped();
+
+    EXPECT_EQ(18, container::accumulate(cb, 0));
+    EXPECT_EQ(360, container::accumulate(cb, 1, [](int a, int b) { return a * b; }));
+    EXPECT_EQ(0, container::accumulate(circular_buffer<int>(3), 0));
+}
+
+TEST_F(CBAlgorithmTest, find)
+{
+    auto cb = make_wrapped();
+    const auto& c_cb = cb;
+
+    EXPECT_EQ(cb.begin(), container::find(cb, 3));
+    EXPECT_EQ(cb.begin() + 1, container::find(cb, 4));
+    EXPECT_EQ(cb.begin() + 2, container::find(cb, 5));
+    EXPECT_EQ(cb.begin() + 3, container::find(cb, 6));
+    EXPECT_EQ(cb.end(), container::find(cb, 7));
+    EXPECT_EQ(c_cb.cbegin() + 3, container::find(c_cb, 6));
+
+    *container::find(cb, 4) = 40;
+    EXPECT_EQ(40, cb[1]);
+}
+
+TEST_F(CBAlgorithmTest, other_buffers)
+{
+    static_circular_buffer<int, 3> scb;
+    for(int i = 1; i <= 5; i++)
+        scb.push_back(i);
+    EXPECT_EQ(12, container::accumulate(scb, 0));
+    EXPECT_EQ(scb.begin() + 2, container::find(scb, 5));
+
+    spsc_circular_buffer<int> spsc(3);
+    spsc.try_push_back(1);
+    spsc.try_push_back(2);
+    spsc.pop_front();
+    spsc.try_push_back(3);
+    spsc.try_push_back(4);
+    EXPECT_EQ(9, container::accumulate(spsc, 0));
+    EXPECT_EQ(spsc.begin() + 1, container::find(spsc, 3));
+}
+
+}   // namespace
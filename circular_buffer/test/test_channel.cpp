@@ -0,0 +1,167 @@
+#include <cstdint>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <iterator>
+#include <gtest/gtest.h>
+#include <channel.h>
+
+namespace
+{
+
+class ChannelTest : public ::testing::Test {};
+
+using namespace container;
+
+TEST_F(ChannelTest, overwrite)
+{
+    channel<int> ch(3, full_policy::overwrite);
+    for(int i = 1; i <= 5; i++)
+        EXPECT_EQ(true, ch.push(i));
+    EXPECT_EQ(3, ch.size());
+
+    int value = 0;
+    for(int expected = 3; expected <= 5; expected++)
+    {
+        EXPECT_EQ(true, ch.try_pop(value));
+        EXPECT_EQ(expected, value);
+    }
+    EXPECT_EQ(false, ch.try_pop(value));
+}
+
+TEST_F(ChannelTest, reject)
+{
+    channel<std::string> ch(2, full_policy::reject);
+    EXPECT_EQ(true, ch.push("1"));
+    EXPECT_EQ(true, ch.push("2"));
+
+    // A rejected item is not moved from.
+    std::string item("3");
+    EXPECT_EQ(false, ch.push(std::move(item)));
+    EXPECT_EQ("3", item);
+    EXPECT_EQ(2, ch.size());
+
+    std::string value;
+    EXPECT_EQ(true, ch.pop(value));
+    EXPECT_EQ("1", value);
+    EXPECT_EQ(true, ch.push(std::move(item)));
+}
+
+TEST_F(ChannelTest, timeout)
+{
+    using namespace std::chrono_literals;
+
+    channel<int> ch(1);
+    int value = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(false, ch.pop_for(value, 20ms));
+    EXPECT_EQ(true, std::chrono::steady_clock::now() - start >= 20ms);
+
+    EXPECT_EQ(true, ch.push(1));
+    start = std::chrono::steady_clock::now();
+    EXPECT_EQ(false, ch.push_for(2, 20ms));
+    EXPECT_EQ(true, std::chrono::steady_clock::now() - start >= 20ms);
+    EXPECT_EQ(false, ch.push_until(2, std::chrono::system_clock::now() + 1ms));
+
+    EXPECT_EQ(true, ch.pop_until(value, std::chrono::steady_clock::now() + 1s));
+    EXPECT_EQ(1, value);
+}
+
+TEST_F(ChannelTest, blocked_push_is_woken)
+{
+    channel<int> ch(1);
+    EXPECT_EQ(true, ch.push(1));
+
+    std::thread producer([&ch]() { ch.push(2); });
+    int value = 0;
+    EXPECT_EQ(true, ch.pop(value));
+    EXPECT_EQ(1, value);
+    EXPECT_EQ(true, ch.pop(value));
+    EXPECT_EQ(2, value);
+    producer.join();
+}
+
+TEST_F(ChannelTest, pop_all)
+{
+    channel<int> ch(4, full_policy::overwrite);
+    for(int i = 0; i < 6; i++)
+        ch.push(i);
+
+    std::vector<int> output;
+    EXPECT_EQ(4, ch.pop_all(std::back_inserter(output)));
+    EXPECT_EQ((std::vector<int>{ 2, 3, 4, 5 }), output);
+    EXPECT_EQ(true, ch.is_empty());
+
+    // Blocks until something arrives.
+    std::thread producer([&ch]() { ch.push(6); });
+    output.clear();
+    EXPECT_EQ(1, ch.pop_all(std::back_inserter(output)));
+    EXPECT_EQ(6, output.front());
+    producer.join();
+}
+
+TEST_F(ChannelTest, close)
+{
+    channel<int> ch(4);
+    ch.push(1);
+
+    std::vector<int> output;
+    std::thread consumer([&ch, &output]()
+    {
+        int value = 0;
+        while(ch.pop(value))
+            output.push_back(value);
+    });
+    ch.push(2);
+    ch.close();
+    consumer.join();
+
+    EXPECT_EQ(true, ch.is_closed());
+    EXPECT_EQ((std::vector<int>{ 1, 2 }), output);
+    EXPECT_EQ(false, ch.push(3));
+    EXPECT_EQ(0, ch.pop_all(std::back_inserter(output)));
+}
+
+TEST_F(ChannelTest, multiple_producers_and_consumers)
+{
+    constexpr int producers = 4;
+    constexpr int consumers = 4;
+    constexpr std::uint64_t count = 20000;
+
+    channel<std::uint64_t> ch(8);
+    std::atomic<std::uint64_t> sum(0);
+
+    std::vector<std::thread> threads;
+    for(int i = 0; i < consumers; i++)
+    {
+        threads.emplace_back([&ch, &sum]()
+        {
+            std::uint64_t local = 0;
+            std::uint64_t value = 0;
+            while(ch.pop(value))
+                local += value;
+            sum += local;
+        });
+    }
+    std::vector<std::thread> producer_threads;
+    for(int i = 0; i < producers; i++)
+    {
+        producer_threads.emplace_back([&ch]()
+        {
+            for(std::uint64_t value = 1; value <= count; value++)
+                ch.push(value);
+        });
+    }
+    for(auto& thread : producer_threads)
+        thread.join();
+    ch.close();
+    for(auto& thread : threads)
+        thread.join();
+
+    EXPECT_EQ(producers * count * (count + 1) / 2, sum.load());
+}
+
+}   // namespace
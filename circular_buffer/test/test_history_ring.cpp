@@ -0,0 +1,123 @@
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <history_ring.h>
+
+namespace
+{
+
+class HistoryRingTest : public ::testing::Test {};
+
+using namespace container;
+
+template<typename T>
+std::vector<T> to_vector(const typename history_ring<T>::const_array_ranges_t& ranges)
+{
+    std::vector<T> result(ranges.first.first, ranges.first.first + ranges.first.second);
+    result.insert(result.end(), ranges.second.first, ranges.second.first + ranges.second.second);
+    return result;
+}
+
+TEST_F(HistoryRingTest, get)
+{
+    history_ring<int> ring(4, 100);
+    EXPECT_EQ(100, ring.first_sequence());
+    EXPECT_EQ(100, ring.next_sequence());
+    EXPECT_EQ(history_status::not_yet_written, ring.get(100).first);
+    EXPECT_EQ(nullptr, ring.get(100).second);
+
+    for(int i = 0; i < 6; i++)
+        EXPECT_EQ(100 + i, ring.push_back(i * 10));
+
+    // [102, 106) are retained.
+    EXPECT_EQ(102, ring.first_sequence());
+    EXPECT_EQ(106, ring.next_sequence());
+    EXPECT_EQ(true, ring.is_full());
+
+    EXPECT_EQ(history_status::evicted, ring.get(0).first);
+    EXPECT_EQ(history_status::evicted, ring.get(101).first);
+    EXPECT_EQ(nullptr, ring.get(101).second);
+    for(std::uint64_t sequence = 102; sequence < 106; sequence++)
+    {
+        const auto result = ring.get(sequence);
+        ASSERT_EQ(history_status::found, result.first);
+        EXPECT_EQ(static_cast<int>(sequence - 100) * 10, *result.second);
+    }
+    EXPECT_EQ(history_status::not_yet_written, ring.get(106).first);
+    EXPECT_EQ(history_status::not_yet_written, ring.status(UINT64_MAX));
+}
+
+TEST_F(HistoryRingTest, range)
+{
+    history_ring<int> ring(5);
+    for(int i = 0; i < 8; i++)
+        ring.push_back(i);
+
+    // [3, 8) retained, stored as [5 6 7 3 4].
+    EXPECT_EQ((std::vector<int>{ 3, 4, 5, 6, 7 }), to_vector<int>(ring.range(0, 100)));
+    EXPECT_EQ((std::vector<int>{ 4, 5, 6 }), to_vector<int>(ring.range(4, 7)));
+    EXPECT_EQ((std::vector<int>{ 6, 7 }), to_vector<int>(ring.range(6, 8)));
+    EXPECT_EQ((std::vector<int>{ 3 }), to_vector<int>(ring.range(1, 4)));
+    EXPECT_EQ(std::vector<int>{}, to_vector<int>(ring.range(0, 3)));
+    EXPECT_EQ(std::vector<int>{}, to_vector<int>(ring.range(8, 10)));
+    EXPECT_EQ(std::vector<int>{}, to_vector<int>(ring.range(6, 6)));
+
+    // Wrapping ranges come in two runs.
+    const auto ranges = ring.range(4, 7);
+    EXPECT_EQ(1, ranges.first.second);
+    EXPECT_EQ(2, ranges.second.second);
+
+    // Runs after the wrap point come in one.
+    EXPECT_EQ(0, ring.range(5, 8).second.second);
+}
+
+TEST_F(HistoryRingTest, evict_before)
+{
+    history_ring<std::string> ring(4, 10);
+    ring.push_back("a");
+    ring.push_back("b");
+    ring.emplace_back(3u, 'c');
+
+    ring.evict_before(5);
+    EXPECT_EQ(3, ring.size());
+    ring.evict_before(12);
+    EXPECT_EQ(12, ring.first_sequence());
+    EXPECT_EQ(history_status::evicted, ring.get(11).first);
+    EXPECT_EQ("ccc", *ring.get(12).second);
+
+    // Sequences are not reused after clearing.
+    ring.clear();
+    EXPECT_EQ(true, ring.is_empty());
+    EXPECT_EQ(13, ring.first_sequence());
+    EXPECT_EQ(history_status::evicted, ring.get(12).first);
+    EXPECT_EQ(13, ring.push_back("d"));
+    EXPECT_EQ("d", *ring.get(13).second);
+
+    ring.evict_before(100);
+    EXPECT_EQ(14, ring.next_sequence());
+}
+
+TEST_F(HistoryRingTest, move_only)
+{
+    history_ring<std::unique_ptr<int>> ring(2);
+    ring.push_back(std::make_unique<int>(1));
+    ring.push_back(std::make_unique<int>(2));
+    ring.push_back(std::make_unique<int>(3));
+    EXPECT_EQ(history_status::evicted, ring.get(0).first);
+    EXPECT_EQ(3, **ring.get(2).second);
+}
+
+#if defined(__has_include) && __has_include(<memory_resource>)
+TEST_F(HistoryRingTest, pmr)
+{
+    std::pmr::monotonic_buffer_resource resource;
+    pmr::history_ring<int> ring(4, 0, &resource);
+    ring.push_back(1);
+    EXPECT_EQ(1, *ring.get(0).second);
+    EXPECT_EQ(&resource, ring.get_allocator().resource());
+}
+#endif
+
+}   // namespace
@@ -0,0 +1,184 @@
+#if defined(__unix__) || defined(__APPLE__)
+#include <cstdint>
+#include <cstdio>
+#include <csignal>
+#include <string>
+#include <numeric>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <gtest/gtest.h>
+#include <mapped_circular_buffer.h>
+
+namespace
+{
+
+class MappedCBTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        path_ = ::testing::TempDir() + "mapped_cb_" + std::to_string(::getpid()) + ".ring";
+        std::remove(path_.c_str());
+    }
+
+    void TearDown() override
+    {
+        std::remove(path_.c_str());
+    }
+
+    // Runs f in a child process and returns its exit status.
+    template<typename F>
+    static int run_in_child(F f)
+    {
+        const auto pid = ::fork();
+        if(pid == 0)
+            ::_exit(f());
+        int status = 0;
+        ::waitpid(pid, &status, 0);
+        return WIFEXITED(status)? WEXITSTATUS(status) : -1;
+    }
+
+    std::string path_;
+};
+
+using namespace container;
+
+struct record
+{
+    std::uint32_t id;
+    double value;
+};
+
+TEST_F(MappedCBTest, push_back)
+{
+    mapped_circular_buffer<int> cb(path_, 4);
+    EXPECT_EQ(true, cb.is_empty());
+    EXPECT_EQ(4, cb.capacity());
+
+    for(int i = 0; i < 6; i++)
+        cb.push_back(i);
+
+    EXPECT_EQ(true, cb.is_full());
+    EXPECT_EQ(2, cb.front());
+    EXPECT_EQ(5, cb.back());
+    EXPECT_EQ(14, std::accumulate(cb.begin(), cb.end(), 0));
+    EXPECT_EQ(2, cb.array_one().second);
+    EXPECT_EQ(2, cb.array_two().second);
+    EXPECT_THROW(cb.at(4), std::out_of_range);
+
+    cb.pop_front(3);
+    EXPECT_EQ(1, cb.size());
+    EXPECT_EQ(5, cb.front());
+    cb.clear();
+    EXPECT_EQ(true, cb.is_empty());
+}
+
+TEST_F(MappedCBTest, reopen_in_another_process)
+{
+    {   // When a child writes and exits.
+        const auto status = run_in_child([this]()
+        {
+            mapped_circular_buffer<record> cb(path_, 8, sync_policy::async);
+            for(std::uint32_t i = 0; i < 11; i++)
+                cb.push_back(record{ i, i * 0.5 });
+            return 0;
+        });
+        ASSERT_EQ(0, status);
+
+        mapped_circular_buffer<record> cb(path_, 8);
+        ASSERT_EQ(8, cb.size());
+        for(std::size_t i = 0; i < cb.size(); i++)
+        {
+            EXPECT_EQ(i + 3, cb[i].id);
+            EXPECT_EQ((i + 3) * 0.5, cb[i].value);
+        }
+
+        cb.pop_front(2);
+        cb.push_back(record{ 100, 1.0 });
+    }
+    {   // When a child reads what the parent left.
+        const auto status = run_in_child([this]()
+        {
+            mapped_circular_buffer<record> cb(path_, 8);
+            if((cb.size() != 7) || (cb.front().id != 5) || (cb.back().id != 100))
+                return 1;
+            return 0;
+        });
+        EXPECT_EQ(0, status);
+    }
+}
+
+TEST_F(MappedCBTest, reopen_after_kill)
+{
+    // The child dies without unmapping or flushing anything.
+    const auto status = run_in_child([this]()
+    {
+        mapped_circular_buffer<int> cb(path_, 16);
+        for(int i = 0; i < 20; i++)
+            cb.push_back(i);
+        ::kill(::getpid(), SIGKILL);
+        return 0;
+    });
+    EXPECT_EQ(-1, status);
+
+    mapped_circular_buffer<int> cb(path_, 16);
+    EXPECT_EQ(16, cb.size());
+    EXPECT_EQ(4, cb.front());
+    EXPECT_EQ(19, cb.back());
+}
+
+TEST_F(MappedCBTest, mismatch)
+{
+    {
+        mapped_circular_buffer<std::uint32_t> cb(path_, 8);
+        cb.push_back(1);
+    }
+    EXPECT_THROW(mapped_circular_buffer<std::uint32_t>(path_, 16), std::runtime_error);
+    EXPECT_THROW(mapped_circular_buffer<std::uint64_t>(path_, 8), std::runtime_error);
+    EXPECT_NO_THROW(mapped_circular_buffer<std::uint32_t>(path_, 8));
+}
+
+TEST_F(MappedCBTest, damaged_header)
+{
+    {
+        mapped_circular_buffer<int> cb(path_, 8);
+        cb.push_back(1);
+        cb.push_back(2);
+    }
+    const int fd = ::open(path_.c_str(), O_WRONLY);
+    ASSERT_LE(0, fd);
+
+    {   // When one copy is damaged, the other one is used.
+        const std::uint64_t garbage = 0xdeadbeef;
+        ASSERT_EQ(sizeof(garbage), ::pwrite(fd, &garbage, sizeof(garbage), 32));
+
+        mapped_circular_buffer<int> cb(path_, 8);
+        EXPECT_EQ(true, (cb.size() == 1) || (cb.size() == 2));
+        EXPECT_EQ(1, cb.front());
+    }
+    {   // When both copies are damaged.
+        const std::uint64_t garbage = 0xdeadbeef;
+        ASSERT_EQ(sizeof(garbage), ::pwrite(fd, &garbage, sizeof(garbage), 32));
+        ASSERT_EQ(sizeof(garbage), ::pwrite(fd, &garbage, sizeof(garbage), 64 + 32));
+
+        EXPECT_THROW(mapped_circular_buffer<int>(path_, 8), std::runtime_error);
+    }
+    ::close(fd);
+}
+
+TEST_F(MappedCBTest, move)
+{
+    mapped_circular_buffer<int> a(path_, 4, sync_policy::sync);
+    a.push_back(7);
+
+    mapped_circular_buffer<int> b(std::move(a));
+    EXPECT_EQ(0, a.size());
+    EXPECT_EQ(7, b.front());
+    EXPECT_EQ(sync_policy::sync, b.policy());
+    b.flush();
+}
+
+}   // namespace
+#endif
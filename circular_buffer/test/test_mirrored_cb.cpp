@@ -0,0 +1,124 @@
+#if defined(__linux__)
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <numeric>
+#include <stdexcept>
+#include <unistd.h>
+#include <gtest/gtest.h>
+#include <mirrored_circular_buffer.h>
+
+namespace
+{
+
+class MirroredCBTest : public ::testing::Test {};
+
+using namespace container;
+
+TEST_F(MirroredCBTest, capacity)
+{
+    const auto page_size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+
+    EXPECT_EQ(page_size, mirrored_circular_buffer<char>(1).capacity());
+    EXPECT_EQ(2 * page_size, mirrored_circular_buffer<char>(page_size + 1).capacity());
+    EXPECT_EQ(page_size / 4, mirrored_circular_buffer<std::uint32_t>(3).capacity());
+
+    // Whole pages that also hold a whole number of elements.
+    struct odd_size { char bytes[12]; };
+    const auto capacity = mirrored_circular_buffer<odd_size>(1).capacity();
+    EXPECT_EQ(0, (capacity * sizeof(odd_size)) % page_size);
+}
+
+TEST_F(MirroredCBTest, contiguous_across_wrap)
+{
+    mirrored_circular_buffer<int> cb(1);
+    const auto capacity = cb.capacity();
+
+    // Move the head close to the end of the storage.
+    for(std::size_t i = 0; i < capacity - 2; i++)
+        cb.push_back(0);
+    cb.pop_front(capacity - 2);
+
+    for(int i = 0; i < 10; i++)
+        cb.push_back(i);
+
+    EXPECT_EQ(10, cb.size());
+    EXPECT_EQ(capacity - 2, cb.head());
+    for(int i = 0; i < 10; i++)
+        EXPECT_EQ(i, cb.data()[i]);
+    EXPECT_EQ(45, std::accumulate(cb.begin(), cb.end(), 0));
+    EXPECT_EQ(9, cb.back());
+    EXPECT_THROW(cb.at(10), std::out_of_range);
+}
+
+TEST_F(MirroredCBTest, push_back_overwrites)
+{
+    mirrored_circular_buffer<int> cb(1);
+    const auto capacity = cb.capacity();
+
+    for(std::size_t i = 0; i < capacity + 3; i++)
+        cb.push_back(static_cast<int>(i));
+
+    EXPECT_EQ(true, cb.is_full());
+    EXPECT_EQ(3, cb.front());
+    EXPECT_EQ(static_cast<int>(capacity) + 2, cb.back());
+    EXPECT_EQ(static_cast<int>(capacity) + 2, cb.data()[cb.size() - 1]);
+}
+
+TEST_F(MirroredCBTest, insert_back)
+{
+    mirrored_circular_buffer<char> cb(1);
+    const auto capacity = cb.capacity();
+    const std::vector<char> items(capacity, 'x');
+
+    cb.insert_back(items.data(), capacity - 1);
+    cb.pop_front(capacity - 1);
+
+    const char text[] = "wrapped";
+    EXPECT_EQ(7, cb.insert_back(text, 7));
+    EXPECT_EQ("wrapped", std::string(cb.data(), cb.size()));
+
+    EXPECT_EQ(capacity - 7, cb.insert_back(items.data(), capacity));
+    EXPECT_EQ(0, cb.insert_back(items.data(), capacity));
+}
+
+TEST_F(MirroredCBTest, write_to_pipe)
+{
+    mirrored_circular_buffer<char> cb(1);
+    const auto capacity = cb.capacity();
+
+    for(std::size_t i = 0; i < capacity - 3; i++)
+        cb.push_back(' ');
+    cb.pop_front(capacity - 3);
+    const char text[] = "hello, world";
+    cb.insert_back(text, sizeof(text) - 1);
+
+    int fds[2];
+    ASSERT_EQ(0, ::pipe(fds));
+    EXPECT_EQ(static_cast<ssize_t>(cb.size()), ::write(fds[1], cb.data(), cb.size()));
+    char received[sizeof(text)] = {};
+    EXPECT_EQ(static_cast<ssize_t>(sizeof(text) - 1), ::read(fds[0], received, sizeof(received)));
+    EXPECT_EQ(std::string(text), std::string(received));
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+
+TEST_F(MirroredCBTest, move)
+{
+    mirrored_circular_buffer<int> cb(1);
+    cb.push_back(1);
+    cb.push_back(2);
+
+    auto moved = std::move(cb);
+    EXPECT_EQ(0, cb.capacity());
+    EXPECT_EQ(0, cb.size());
+    EXPECT_EQ(2, moved.size());
+    EXPECT_EQ(1, moved.front());
+
+    mirrored_circular_buffer<int> other(1);
+    other = std::move(moved);
+    EXPECT_EQ(2, other.back());
+}
+
+}   // namespace
+#endif
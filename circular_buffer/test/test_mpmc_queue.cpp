@@ -0,0 +1,185 @@
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <iterator>
+#include <gtest/gtest.h>
+#include <mpmc_queue.h>
+
+namespace
+{
+
+class MPMCQueueTest : public ::testing::Test {};
+
+using namespace container;
+
+TEST_F(MPMCQueueTest, capacity)
+{
+    EXPECT_EQ(1, mpmc_queue<int>(1).capacity());
+    EXPECT_EQ(4, mpmc_queue<int>(3).capacity());
+    EXPECT_EQ(4, mpmc_queue<int>(4).capacity());
+    EXPECT_EQ(8, mpmc_queue<int>(5).capacity());
+}
+
+TEST_F(MPMCQueueTest, try_push_and_try_pop)
+{
+    mpmc_queue<int> q(4);
+    int value = 0;
+
+    EXPECT_EQ(false, q.try_pop(value));
+    EXPECT_EQ(true, q.is_empty());
+
+    for(int lap = 0; lap < 3; lap++)
+    {
+        EXPECT_EQ(true, q.try_push(1));
+        EXPECT_EQ(true, q.try_push(2));
+        EXPECT_EQ(true, q.try_emplace(3));
+        EXPECT_EQ(true, q.try_push(4));
+        EXPECT_EQ(false, q.try_push(5));
+        EXPECT_EQ(4, q.size());
+
+        for(int expected = 1; expected <= 4; expected++)
+        {
+            EXPECT_EQ(true, q.try_pop(value));
+            EXPECT_EQ(expected, value);
+        }
+        EXPECT_EQ(false, q.try_pop(value));
+    }
+}
+
+TEST_F(MPMCQueueTest, bulk)
+{
+    mpmc_queue<int> q(8);
+    const std::vector<int> input{ 1, 2, 3, 4, 5 };
+
+    EXPECT_EQ(5, q.try_push_bulk(input.begin(), input.end()));
+    EXPECT_EQ(3, q.try_push_bulk(input.begin(), input.end()));
+    EXPECT_EQ(0, q.try_push_bulk(input.begin(), input.end()));
+
+    std::vector<int> output;
+    EXPECT_EQ(6, q.try_pop_bulk(std::back_inserter(output), 6));
+    EXPECT_EQ((std::vector<int>{ 1, 2, 3, 4, 5, 1 }), output);
+
+    output.clear();
+    EXPECT_EQ(2, q.try_pop_bulk(std::back_inserter(output), 6));
+    EXPECT_EQ((std::vector<int>{ 2, 3 }), output);
+    EXPECT_EQ(0, q.try_pop_bulk(std::back_inserter(output), 6));
+}
+
+TEST_F(MPMCQueueTest, destroys_elements)
+{
+    auto item = std::make_shared<int>(0);
+    {
+        mpmc_queue<std::shared_ptr<int>> q(4);
+        q.try_push(item);
+        q.try_push(item);
+        EXPECT_EQ(3, item.use_count());
+
+        std::shared_ptr<int> popped;
+        q.try_pop(popped);
+        popped.reset();
+        EXPECT_EQ(2, item.use_count());
+    }
+    EXPECT_EQ(1, item.use_count());
+}
+
+// Every value is received exactly once, and values from one producer
+// reach any one consumer in the order they were pushed.
+TEST_F(MPMCQueueTest, stress)
+{
+    constexpr std::uint64_t producers = 4;
+    constexpr std::uint64_t consumers = 4;
+    constexpr std::uint64_t per_producer = 20000;
+    constexpr std::uint64_t total = producers * per_producer;
+
+    mpmc_queue<std::uint64_t> q(64);
+    std::atomic<std::uint64_t> received(0);
+    std::vector<std::atomic<std::uint32_t>> seen(total);
+    std::atomic<bool> in_order(true);
+
+    std::vector<std::thread> threads;
+    for(std::uint64_t p = 0; p < producers; p++)
+    {
+        threads.emplace_back([&q, p]()
+        {
+            for(std::uint64_t i = 0; i < per_producer; i++)
+            {
+                const auto value = p * per_producer + i;
+                if((i % 2) == 0)
+                {
+                    while(!q.try_push(value))
+                        std::this_thread::yield();
+                }
+                else
+                {
+                    const std::uint64_t one[] = { value };
+                    while(q.try_push_bulk(std::begin(one), std::end(one)) == 0)
+                        std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for(std::uint64_t c = 0; c < consumers; c++)
+    {
+        threads.emplace_back([&q, &received, &seen, &in_order, c]()
+        {
+            std::vector<std::uint64_t> last(producers, 0);
+            std::vector<std::uint64_t> batch;
+            while(received.load() < total)
+            {
+                batch.clear();
+                if(c % 2 == 0)
+                {
+                    std::uint64_t value;
+                    if(q.try_pop(value))
+                        batch.push_back(value);
+                }
+                else
+                {
+                    q.try_pop_bulk(std::back_inserter(batch), 8);
+                }
+                if(batch.empty())
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+                for(auto value : batch)
+                {
+                    const auto p = value / per_producer;
+                    if(value < last[p])
+                        in_order = false;
+                    last[p] = value + 1;
+                    seen[value]++;
+                }
+                received += batch.size();
+            }
+        });
+    }
+    for(auto& thread : threads)
+        thread.join();
+
+    EXPECT_EQ(total, received.load());
+    EXPECT_EQ(true, in_order.load());
+    bool exactly_once = true;
+    for(const auto& count : seen)
+        exactly_once = exactly_once && (count.load() == 1);
+    EXPECT_EQ(true, exactly_once);
+    EXPECT_EQ(true, q.is_empty());
+}
+
+#if defined(__has_include) && __has_include(<memory_resource>)
+TEST_F(MPMCQueueTest, pmr)
+{
+    std::pmr::monotonic_buffer_resource resource;
+    pmr::mpmc_queue<int> q(3, &resource);
+    int value = 0;
+
+    EXPECT_EQ(true, q.try_push(1));
+    EXPECT_EQ(true, q.try_pop(value));
+    EXPECT_EQ(1, value);
+    EXPECT_EQ(&resource, q.get_allocator().resource());
+}
+#endif
+
+}   // namespace
@@ -0,0 +1,224 @@
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+#include <memory>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+#include <gtest/gtest.h>
+#include <pow2_circular_buffer.h>
+
+namespace
+{
+
+class Pow2CBTest : public ::testing::Test {};
+
+using namespace container;
+
+TEST_F(Pow2CBTest, capacity)
+{
+    EXPECT_EQ(1, pow2_circular_buffer<int>(1).capacity());
+    EXPECT_EQ(4, pow2_circular_buffer<int>(3).capacity());
+    EXPECT_EQ(4, pow2_circular_buffer<int>(4).capacity());
+    EXPECT_EQ(8, pow2_circular_buffer<int>(5).capacity());
+
+    // Capacities above the largest power of 2 throw instead of wrapping around to 0.
+    const auto largest = (std::numeric_limits<std::size_t>::max)() / 2 + 1;
+    EXPECT_EQ(largest, detail::round_up_to_power_of_2(largest));
+    EXPECT_THROW(detail::round_up_to_power_of_2(largest + 1), std::length_error);
+    EXPECT_THROW((pow2_circular_buffer<int>(largest + 1)), std::length_error);
+    EXPECT_EQ(128, detail::round_up_to_power_of_2(std::uint8_t(128)));
+    EXPECT_THROW(detail::round_up_to_power_of_2(std::uint8_t(129)), std::length_error);
+}
+
+TEST_F(Pow2CBTest, push_back)
+{
+    pow2_circular_buffer<int> cb(4);
+
+    for(int i = 0; i < 4; i++)
+        cb.push_back(i);
+    EXPECT_EQ(true, cb.is_full());
+    EXPECT_EQ(0, cb.front());
+    EXPECT_EQ(3, cb.back());
+
+    // The oldest element is overwritten.
+    cb.push_back(4);
+    EXPECT_EQ(4, cb.size());
+    EXPECT_EQ(1, cb.front());
+    EXPECT_EQ(4, cb.back());
+    EXPECT_EQ(1, cb.head());
+    EXPECT_EQ(1, cb.tail());
+
+    for(std::size_t i = 0; i < 4; i++)
+        EXPECT_EQ(static_cast<int>(i) + 1, cb[i]);
+    EXPECT_THROW(cb.at(4), std::out_of_range);
+}
+
+TEST_F(Pow2CBTest, push_front)
+{
+    pow2_circular_buffer<int> cb(2);
+
+    cb.push_front(1);
+    cb.push_front(2);
+    EXPECT_EQ(2, cb.front());
+    EXPECT_EQ(1, cb.back());
+
+    cb.push_front(3);
+    EXPECT_EQ(2, cb.size());
+    EXPECT_EQ(3, cb.front());
+    EXPECT_EQ(2, cb.back());
+}
+
+TEST_F(Pow2CBTest, emplace)
+{
+    pow2_circular_buffer<std::string> cb(2);
+
+    EXPECT_EQ("aa", cb.emplace_back(std::size_t(2), 'a'));
+    EXPECT_EQ("b", cb.emplace_front(std::size_t(1), 'b'));
+    EXPECT_EQ("ccc", cb.emplace_back(std::size_t(3), 'c'));
+    EXPECT_EQ(2, cb.size());
+    EXPECT_EQ("aa", cb.front());
+    EXPECT_EQ("ccc", cb.back());
+}
+
+TEST_F(Pow2CBTest, pop)
+{
+    pow2_circular_buffer<int> cb(4);
+
+    // Runs the counters over many laps.
+    for(int i = 0; i < 1000; i++)
+    {
+        cb.push_back(i);
+        cb.push_back(i + 1);
+        cb.pop_front();
+        EXPECT_EQ(i + 1, cb.front());
+        cb.pop_back();
+        EXPECT_EQ(true, cb.is_empty());
+    }
+}
+
+TEST_F(Pow2CBTest, array_one_and_array_two)
+{
+    pow2_circular_buffer<int> cb(4);
+
+    for(int i = 0; i < 6; i++)
+        cb.push_back(i);
+
+    // [4 5 2 3]
+    const auto one = cb.array_one();
+    const auto two = cb.array_two();
+    EXPECT_EQ(cb.data() + 2, one.first);
+    EXPECT_EQ(2, one.second);
+    EXPECT_EQ(cb.data(), two.first);
+    EXPECT_EQ(2, two.second);
+
+    cb.pop_back();
+    cb.pop_back();
+    EXPECT_EQ(2, cb.array_one().second);
+    EXPECT_EQ(0, cb.array_two().second);
+}
+
+TEST_F(Pow2CBTest, iteration)
+{
+    pow2_circular_buffer<int> cb(8);
+
+    for(int i = 0; i < 11; i++)
+        cb.push_back(i);
+    cb.pop_back();
+
+    const std::vector<int> expected{ 3, 4, 5, 6, 7, 8, 9 };
+    EXPECT_EQ(expected, std::vector<int>(cb.begin(), cb.end()));
+    EXPECT_EQ(expected, std::vector<int>(cb.cbegin(), cb.cend()));
+    EXPECT_EQ(7, std::distance(cb.begin(), cb.end()));
+    EXPECT_EQ(7, *(cb.begin() + 4));
+    EXPECT_EQ(9, *(cb.end() - 1));
+    EXPECT_EQ(std::vector<int>(expected.rbegin(), expected.rend()), std::vector<int>(cb.rbegin(), cb.rend()));
+
+    cb.push_back(10);
+    const std::vector<int> full{ 3, 4, 5, 6, 7, 8, 9, 10 };
+    EXPECT_EQ(full, std::vector<int>(cb.begin(), cb.end()));
+    EXPECT_EQ(true, std::is_sorted(cb.begin(), cb.end()));
+}
+
+TEST_F(Pow2CBTest, copy_and_move)
+{
+    pow2_circular_buffer<std::string> cb(4);
+    for(int i = 0; i < 6; i++)
+        cb.push_back(std::to_string(i));
+
+    auto copy = cb;
+    EXPECT_EQ(std::vector<std::string>(cb.begin(), cb.end()), std::vector<std::string>(copy.begin(), copy.end()));
+
+    auto moved = std::move(copy);
+    EXPECT_EQ(0, copy.capacity());
+    EXPECT_EQ(0, copy.size());
+    EXPECT_EQ(4, moved.size());
+    EXPECT_EQ("2", moved.front());
+
+    copy = moved;
+    EXPECT_EQ(4, copy.size());
+    EXPECT_EQ("5", copy.back());
+}
+
+TEST_F(Pow2CBTest, element_lifetime)
+{
+    auto item = std::make_shared<int>(0);
+    {
+        pow2_circular_buffer<std::shared_ptr<int>> cb(2);
+        cb.push_back(item);
+        cb.push_back(item);
+        EXPECT_EQ(3, item.use_count());
+
+        cb.push_back(std::make_shared<int>(1));
+        EXPECT_EQ(2, item.use_count());
+
+        cb.pop_front();
+        EXPECT_EQ(1, item.use_count());
+
+        cb.push_front(item);
+        cb.clear();
+        EXPECT_EQ(1, item.use_count());
+
+        cb.push_back(item);
+    }
+    EXPECT_EQ(1, item.use_count());
+}
+
+#if defined(__has_include) && __has_include(<memory_resource>)
+TEST_F(Pow2CBTest, pmr)
+{
+    std::pmr::monotonic_buffer_resource resource;
+    pmr::pow2_circular_buffer<int> cb(3, &resource);
+
+    cb.push_back(1);
+    EXPECT_EQ(4, cb.capacity());
+    EXPECT_EQ(1, cb.front());
+    EXPECT_EQ(&resource, cb.get_allocator().resource());
+}
+
+TEST_F(Pow2CBTest, pmr_move)
+{
+    std::pmr::monotonic_buffer_resource resource1;
+    std::pmr::monotonic_buffer_resource resource2;
+    pmr::pow2_circular_buffer<int> cb(4, &resource1);
+    cb.push_back(1);
+    cb.push_back(2);
+
+    // When both allocators are different, the elements are moved into storage from the own allocator.
+    pmr::pow2_circular_buffer<int> other(2, &resource2);
+    other = std::move(cb);
+    EXPECT_EQ(4, other.capacity());
+    EXPECT_EQ(2, other.size());
+    EXPECT_EQ(1, other.front());
+    EXPECT_EQ(&resource2, other.get_allocator().resource());
+    EXPECT_EQ(0, cb.capacity());
+
+    // A moved-from buffer leaves the target without storage.
+    other = std::move(cb);
+    EXPECT_EQ(0, other.capacity());
+    EXPECT_EQ(true, other.is_empty());
+}
+#endif
+
+}   // namespace
@@ -0,0 +1,250 @@
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <deque>
+#include <random>
+#include <gtest/gtest.h>
+#include <record_ring.h>
+
+namespace
+{
+
+class RecordRingTest : public ::testing::Test {};
+
+using namespace container;
+
+constexpr std::size_t block = record_ring::record_alignment;
+
+std::string to_string(const record_ring::record_type& record)
+{
+    return std::string(reinterpret_cast<const char*>(record.first), record.second);
+}
+
+bool push(record_ring& ring, const std::string& s)
+{
+    return ring.try_push_back(s.data(), s.size());
+}
+
+std::vector<std::string> contents(const record_ring& ring)
+{
+    std::vector<std::string> result;
+    for(const auto& record : ring)
+        result.push_back(to_string(record));
+    return result;
+}
+
+TEST_F(RecordRingTest, capacity)
+{
+    EXPECT_EQ(2 * block, record_ring(1).capacity());
+    EXPECT_EQ(4 * block, record_ring(4 * block - 1).capacity());
+    EXPECT_EQ(3 * block, record_ring(3 * block).max_record_size() + block);
+
+    EXPECT_EQ(block, record_ring::footprint(0));
+    EXPECT_EQ(2 * block, record_ring::footprint(1));
+    EXPECT_EQ(2 * block, record_ring::footprint(block));
+    EXPECT_EQ(3 * block, record_ring::footprint(block + 1));
+}
+
+TEST_F(RecordRingTest, push_and_pop)
+{
+    record_ring ring(8 * block);
+    EXPECT_EQ(true, ring.is_empty());
+    EXPECT_EQ(ring.begin(), ring.end());
+
+    EXPECT_EQ(true, push(ring, "a"));
+    EXPECT_EQ(true, push(ring, ""));
+    EXPECT_EQ(true, push(ring, std::string(block + 1, 'b')));
+    EXPECT_EQ(3, ring.size());
+    EXPECT_EQ(6 * block, ring.used_bytes());
+    EXPECT_EQ((std::vector<std::string>{ "a", "", std::string(block + 1, 'b') }), contents(ring));
+
+    // Every payload is aligned.
+    for(const auto& record : ring)
+        EXPECT_EQ(0, reinterpret_cast<std::uintptr_t>(record.first) % block);
+
+    // A full ring rejects the record and keeps the others.
+    EXPECT_EQ(false, push(ring, std::string(2 * block, 'c')));
+    EXPECT_EQ(true, push(ring, "d"));
+    EXPECT_EQ(ring.capacity(), ring.used_bytes());
+
+    EXPECT_EQ("a", to_string(ring.front()));
+    ring.pop_front();
+    EXPECT_EQ("", to_string(ring.front()));
+    ring.pop_front();
+    EXPECT_EQ(std::string(block + 1, 'b'), to_string(ring.front()));
+    EXPECT_EQ(2, ring.size());
+
+    ring.clear();
+    EXPECT_EQ(true, ring.is_empty());
+    EXPECT_EQ(0, ring.used_bytes());
+}
+
+TEST_F(RecordRingTest, skip_marker)
+{
+    // [a a b b c c _ _] -> [_ _ _ _ c c _ _]
+    record_ring ring(8 * block);
+    EXPECT_EQ(true, push(ring, "a"));
+    EXPECT_EQ(true, push(ring, "b"));
+    EXPECT_EQ(true, push(ring, "c"));
+    ring.pop_front();
+    ring.pop_front();
+
+    // Does not fit before the end, so [d d d _ c c s s] with the last two blocks skipped.
+    EXPECT_EQ(true, push(ring, std::string(2 * block, 'd')));
+    EXPECT_EQ(7 * block, ring.used_bytes());
+    EXPECT_EQ((std::vector<std::string>{ "c", std::string(2 * block, 'd') }), contents(ring));
+
+    // Popping the record before the skipped space steps over it.
+    ring.pop_front();
+    EXPECT_EQ(1, ring.size());
+    EXPECT_EQ(3 * block, ring.used_bytes());
+    EXPECT_EQ(std::string(2 * block, 'd'), to_string(ring.front()));
+
+    // [d d d e e e e _]; a record that fits neither before the end nor before the head is rejected.
+    EXPECT_EQ(true, push(ring, std::string(3 * block, 'e')));
+    EXPECT_EQ(false, push(ring, "f"));
+    ring.pop_front();
+    EXPECT_EQ(std::string(3 * block, 'e'), to_string(ring.front()));
+    ring.pop_front();
+    EXPECT_EQ(0, ring.used_bytes());
+
+    // Drained, so the whole storage is contiguous again.
+    EXPECT_EQ(true, push(ring, std::string(ring.max_record_size(), 'g')));
+}
+
+TEST_F(RecordRingTest, reserve_back_and_commit_back)
+{
+    record_ring ring(8 * block);
+
+    // Reserve for the largest case, commit what was written.
+    auto payload = static_cast<char*>(ring.reserve_back(4 * block));
+    ASSERT_NE(nullptr, payload);
+    EXPECT_EQ(true, ring.is_empty());
+    payload[0] = 'x';
+    payload[1] = 'y';
+    ring.commit_back(2);
+    EXPECT_EQ("xy", to_string(ring.front()));
+    EXPECT_EQ(2 * block, ring.used_bytes());
+
+    // An object can be built in place.
+    struct message
+    {
+        std::uint64_t id;
+        double value;
+    };
+    auto m = ::new(ring.reserve_back(sizeof(message))) message{ 7, 0.5 };
+    ring.commit_back(sizeof(message));
+    ring.pop_front();
+    EXPECT_EQ(static_cast<const void*>(m), static_cast<const void*>(ring.front().first));
+    EXPECT_EQ(7, reinterpret_cast<const message*>(ring.front().first)->id);
+
+    EXPECT_EQ(nullptr, ring.reserve_back(ring.max_record_size() + 1));
+}
+
+TEST_F(RecordRingTest, matches_deque)
+{
+    std::mt19937 engine(1);
+    std::uniform_int_distribution<std::size_t> size_dist(0, 300);
+    std::uniform_int_distribution<int> op_dist(0, 2);
+
+    record_ring ring(1024);
+    std::deque<std::string> model;
+    std::size_t used = 0;
+    for(int i = 0; i < 20000; i++)
+    {
+        if(op_dist(engine) > 0)
+        {
+            const std::string s(size_dist(engine), static_cast<char>('a' + i % 26));
+            if(push(ring, s))
+            {
+                model.push_back(s);
+                used += record_ring::footprint(s.size());
+            }
+            else
+            {   // Rejected only when neither the space before the end nor the space before the head suffices.
+                EXPECT_LT(ring.capacity() - ring.used_bytes(), 2 * record_ring::footprint(s.size()));
+            }
+        }
+        else if(!model.empty())
+        {
+            EXPECT_EQ(model.front(), to_string(ring.front()));
+            used -= record_ring::footprint(model.front().size());
+            ring.pop_front();
+            model.pop_front();
+        }
+        ASSERT_EQ(model.size(), ring.size());
+        ASSERT_LE(used, ring.used_bytes());
+    }
+    EXPECT_EQ(std::vector<std::string>(model.begin(), model.end()), contents(ring));
+}
+
+TEST_F(RecordRingTest, move)
+{
+    record_ring ring(4 * block);
+    push(ring, "a");
+
+    record_ring other(std::move(ring));
+    EXPECT_EQ("a", to_string(other.front()));
+    EXPECT_EQ(0, ring.capacity());
+
+    record_ring third(2 * block);
+    third = std::move(other);
+    EXPECT_EQ("a", to_string(third.front()));
+    EXPECT_EQ(4 * block, third.capacity());
+}
+
+#if defined(__has_include) && __has_include(<memory_resource>)
+TEST_F(RecordRingTest, pmr)
+{
+    // Unaligned leftovers in the resource do not affect the records.
+    unsigned char buffer[1024];
+    std::pmr::monotonic_buffer_resource resource(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+    static_cast<void>(resource.allocate(1, 1));
+    pmr::record_ring ring(8 * block, &resource);
+
+    EXPECT_EQ(true, ring.try_push_back("abc", 3));
+    EXPECT_EQ(0, reinterpret_cast<std::uintptr_t>(ring.front().first) % block);
+    EXPECT_EQ(&resource, ring.get_allocator().resource());
+}
+
+TEST_F(RecordRingTest, pmr_move)
+{
+    std::pmr::monotonic_buffer_resource resource1;
+    std::pmr::monotonic_buffer_resource resource2;
+
+    pmr::record_ring ring(8 * block, &resource1);
+    ring.try_push_back("abc", 3);
+    ring.try_push_back("de", 2);
+    ring.pop_front();
+    ring.try_push_back(std::string(3 * block, 'f').data(), 3 * block);
+
+    {   // When both allocators are equal, the storage is taken over.
+        pmr::record_ring other(2 * block, &resource1);
+        const auto data = ring.front().first;
+        other = std::move(ring);
+        EXPECT_EQ(data, other.front().first);
+        EXPECT_EQ(0, ring.capacity());
+        ring = std::move(other);
+    }
+    {   // When both allocators are different, the records are copied with their layout.
+        pmr::record_ring other(2 * block, &resource2);
+        other = std::move(ring);
+        EXPECT_EQ(8 * block, other.capacity());
+        EXPECT_EQ(&resource2, other.get_allocator().resource());
+        EXPECT_EQ(2, other.size());
+        EXPECT_EQ("de", std::string(reinterpret_cast<const char*>(other.front().first), other.front().second));
+        other.pop_front();
+        EXPECT_EQ(std::string(3 * block, 'f'), std::string(reinterpret_cast<const char*>(other.front().first), other.front().second));
+        EXPECT_EQ(0, ring.capacity());
+        EXPECT_EQ(true, ring.is_empty());
+
+        // A moved-from ring leaves the target empty.
+        other = std::move(ring);
+        EXPECT_EQ(0, other.capacity());
+        EXPECT_EQ(true, other.is_empty());
+    }
+}
+#endif
+
+}   // namespace
@@ -0,0 +1,120 @@
+#include <cstdint>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <rollup_ring.h>
+
+namespace
+{
+
+class RollupRingTest : public ::testing::Test {};
+
+using namespace container;
+
+struct stats
+{
+    std::int64_t count;
+    std::int64_t sum;
+    std::int64_t max;
+};
+
+struct merge_stats
+{
+    stats operator()(const stats& a, const stats& b) const
+    {
+        return { a.count + b.count, a.sum + b.sum, (std::max)(a.max, b.max) };
+    }
+};
+
+TEST_F(RollupRingTest, fold_into_coarser_tiers)
+{
+    // 4 buckets of 1, 3 buckets of 4, 2 buckets of 16.
+    rollup_ring<int> ring({ { 1, 4 }, { 4, 3 }, { 16, 2 } });
+    EXPECT_EQ(3, ring.tier_count());
+    EXPECT_EQ(4, ring.resolution(1));
+
+    for(std::int64_t t = 0; t < 8; t++)
+        ring.push(t, 1);
+
+    // [4 5 6 7] in the finest tier, [0..3] folded into one bucket of 4.
+    EXPECT_EQ(4, ring.tier(0).size());
+    EXPECT_EQ(4, ring.tier(0).front().start);
+    EXPECT_EQ(1, ring.tier(1).size());
+    EXPECT_EQ(0, ring.tier(1).front().start);
+    EXPECT_EQ(4, ring.tier(1).front().value);
+    EXPECT_EQ(true, ring.tier(2).is_empty());
+
+    // Samples in the same bucket are folded on ingest.
+    ring.push(8, 10);
+    ring.push(8, 10);
+    EXPECT_EQ(20, ring.tier(0).back().value);
+
+    for(std::int64_t t = 9; t < 40; t++)
+        ring.push(t, 1);
+    EXPECT_EQ(36, ring.tier(0).front().start);
+    EXPECT_EQ(24, ring.tier(1).front().start);
+    EXPECT_EQ(2, ring.tier(2).size());
+    EXPECT_EQ(0, ring.tier(2).front().start);
+    EXPECT_EQ(16 + 19, ring.tier(2).front().value);
+
+    // Nothing is lost until the coarsest tier evicts.
+    EXPECT_EQ(40 + 19, *ring.query(0, 40));
+}
+
+TEST_F(RollupRingTest, query)
+{
+    rollup_ring<stats, merge_stats> ring({ { 10, 6 }, { 60, 10 } });
+    EXPECT_EQ(false, ring.query(0, 1000).has_value());
+
+    for(std::int64_t t = 0; t < 300; t++)
+        ring.push(t, stats{ 1, t, t });
+
+    // The finest tier covers [240, 300), the coarser [0, 240).
+    EXPECT_EQ(240, ring.tier(0).front().start);
+    EXPECT_EQ(4, ring.tier(1).size());
+
+    const auto all = ring.query(0, 300);
+    EXPECT_EQ(300, all->count);
+    EXPECT_EQ(299 * 300 / 2, all->sum);
+    EXPECT_EQ(299, all->max);
+
+    // Buckets in the range, from both tiers, oldest first.
+    std::vector<std::pair<std::int64_t, std::size_t>> visited;
+    ring.for_each(120, 260, [&visited](const auto& b, std::size_t tier) { visited.emplace_back(b.start, tier); });
+    const std::vector<std::pair<std::int64_t, std::size_t>> expected{ { 120, 1 }, { 180, 1 }, { 240, 0 }, { 250, 0 } };
+    EXPECT_EQ(expected, visited);
+
+    const auto range = ring.query(120, 260);
+    EXPECT_EQ(140, range->count);
+    EXPECT_EQ(259, range->max);
+
+    ring.clear();
+    EXPECT_EQ(false, ring.query(0, 1000).has_value());
+}
+
+TEST_F(RollupRingTest, query_straddling_buckets)
+{
+    rollup_ring<int> ring({ { 1, 2 }, { 10, 10 } });
+    for(std::int64_t t = 0; t <= 12; t++)
+        ring.push(t, 1);
+
+    // [11 12] in the finest tier, [0, 10) and [10, 20) in the coarser.
+    EXPECT_EQ(11, ring.tier(0).front().start);
+    EXPECT_EQ(2, ring.tier(1).size());
+
+    // Buckets reaching into the range from either end count as a whole.
+    std::vector<std::pair<std::int64_t, std::size_t>> visited;
+    ring.for_each(5, 15, [&visited](const auto& b, std::size_t tier) { visited.emplace_back(b.start, tier); });
+    const std::vector<std::pair<std::int64_t, std::size_t>> expected{ { 0, 1 }, { 10, 1 }, { 11, 0 }, { 12, 0 } };
+    EXPECT_EQ(expected, visited);
+    EXPECT_EQ(10 + 1 + 1 + 1, *ring.query(5, 15));
+
+    EXPECT_EQ(10, *ring.query(5, 10));
+    EXPECT_EQ(1, *ring.query(10, 11));
+    EXPECT_EQ(1 + 1, *ring.query(12, 13));
+    EXPECT_EQ(1, *ring.query(13, 20));
+    EXPECT_EQ(false, ring.query(20, 30).has_value());
+}
+
+}   // namespace
@@ -0,0 +1,161 @@
+#include <cstdint>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <memory_resource>
+#include <gtest/gtest.h>
+#include <seqlock_circular_buffer.h>
+
+namespace
+{
+
+class SeqlockCBTest : public ::testing::Test {};
+
+using namespace container;
+
+TEST_F(SeqlockCBTest, push_back)
+{
+    seqlock_circular_buffer<int> cb(4);
+    EXPECT_EQ(true, cb.is_empty());
+    EXPECT_EQ(4, cb.capacity());
+
+    int dest[4] = {};
+    EXPECT_EQ(0, cb.read_latest(dest, 4));
+
+    cb.push_back(1);
+    cb.push_back(2);
+    EXPECT_EQ(2, cb.size());
+    EXPECT_EQ(2, cb.read_latest(dest, 4));
+    EXPECT_EQ(1, dest[0]);
+    EXPECT_EQ(2, dest[1]);
+
+    // Wraps around and overwrites the oldest.
+    for(int i = 3; i <= 7; i++)
+        cb.push_back(i);
+    EXPECT_EQ(4, cb.size());
+    EXPECT_EQ(7, cb.pushed());
+    EXPECT_EQ(4, cb.read_latest(dest, 4));
+    for(int i = 0; i < 4; i++)
+        EXPECT_EQ(i + 4, dest[i]);
+
+    // Only the latest.
+    EXPECT_EQ(3, cb.read_latest(dest, 3));
+    for(int i = 0; i < 3; i++)
+        EXPECT_EQ(i + 5, dest[i]);
+}
+
+TEST_F(SeqlockCBTest, push_back_items)
+{
+    seqlock_circular_buffer<int> cb(5);
+    const int items[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 };
+
+    cb.push_back(items, 3);
+    cb.push_back(items + 3, 4);
+    int dest[5] = {};
+    EXPECT_EQ(5, cb.read_latest(dest, 5));
+    for(int i = 0; i < 5; i++)
+        EXPECT_EQ(i + 2, dest[i]);
+
+    // More than the capacity keeps the last ones.
+    cb.push_back(items, 12);
+    EXPECT_EQ(19, cb.pushed());
+    EXPECT_EQ(5, cb.read_latest(dest, 5));
+    for(int i = 0; i < 5; i++)
+        EXPECT_EQ(i + 7, dest[i]);
+}
+
+TEST_F(SeqlockCBTest, try_read_latest)
+{
+    seqlock_circular_buffer<int> cb(4);
+    for(int i = 0; i < 6; i++)
+        cb.push_back(i);
+
+    int dest[4] = {};
+    std::size_t copied = 0;
+    EXPECT_EQ(true, cb.try_read_latest(dest, 8, copied));
+    EXPECT_EQ(4, copied);
+    EXPECT_EQ(2, dest[0]);
+    EXPECT_EQ(5, dest[3]);
+}
+
+TEST_F(SeqlockCBTest, narrow_elements)
+{
+    // Elements whose size is not a multiple of the word are copied in narrower words.
+    struct rgb
+    {
+        unsigned char r, g, b;
+    };
+    seqlock_circular_buffer<rgb> cb(3);
+    for(int i = 0; i < 4; i++)
+        cb.push_back(rgb{ static_cast<unsigned char>(i), static_cast<unsigned char>(i + 1), static_cast<unsigned char>(i + 2) });
+
+    rgb dest[3] = {};
+    EXPECT_EQ(3, cb.read_latest(dest, 3));
+    EXPECT_EQ(1, dest[0].r);
+    EXPECT_EQ(4, dest[2].g);
+    EXPECT_EQ(5, dest[2].b);
+
+    seqlock_circular_buffer<std::uint16_t> shorts(2);
+    shorts.push_back(7);
+    std::uint16_t value = 0;
+    EXPECT_EQ(1, shorts.read_latest(&value, 1));
+    EXPECT_EQ(7, value);
+}
+
+TEST_F(SeqlockCBTest, concurrent_readers)
+{
+    // Each element carries its number twice, so a torn copy would show.
+    struct sample
+    {
+        std::uint64_t number;
+        std::uint64_t check;
+    };
+    constexpr std::size_t capacity = 64;
+    constexpr std::size_t latest = 16;
+    constexpr std::uint64_t count = 200000;
+
+    seqlock_circular_buffer<sample> cb(capacity);
+    std::atomic<bool> done(false);
+    std::atomic<std::size_t> errors(0);
+
+    std::vector<std::thread> readers;
+    for(int r = 0; r < 3; r++)
+    {
+        readers.emplace_back([&]()
+        {
+            sample dest[latest];
+            while(!done.load(std::memory_order_acquire))
+            {
+                const auto copied = cb.read_latest(dest, latest);
+                for(std::size_t i = 0; i < copied; i++)
+                {
+                    if((dest[i].check != ~dest[i].number) || ((i > 0) && (dest[i].number != dest[i - 1].number + 1)))
+                        errors.fetch_add(1);
+                }
+            }
+        });
+    }
+
+    for(std::uint64_t i = 0; i < count; i++)
+        cb.push_back(sample{ i, ~i });
+    done.store(true, std::memory_order_release);
+    for(auto& reader : readers)
+        reader.join();
+
+    EXPECT_EQ(0, errors.load());
+    sample last;
+    EXPECT_EQ(1, cb.read_latest(&last, 1));
+    EXPECT_EQ(count - 1, last.number);
+}
+
+TEST_F(SeqlockCBTest, pmr)
+{
+    std::pmr::monotonic_buffer_resource resource;
+    pmr::seqlock_circular_buffer<int> cb(8, &resource);
+    cb.push_back(1);
+    int dest = 0;
+    EXPECT_EQ(1, cb.read_latest(&dest, 1));
+    EXPECT_EQ(1, dest);
+}
+
+}   // namespace
@@ -0,0 +1,183 @@
+#if defined(__linux__)
+#include <cstdint>
+#include <chrono>
+#include <string>
+#include <stdexcept>
+#include <thread>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <gtest/gtest.h>
+#include <shm_spsc_ring.h>
+
+namespace
+{
+
+class ShmSpscRingTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        name_ = "/shm_spsc_ring_test_" + std::to_string(::getpid());
+        container::shm_spsc_ring<int>::unlink(name_);
+    }
+
+    void TearDown() override
+    {
+        container::shm_spsc_ring<int>::unlink(name_);
+    }
+
+    // The exit status of a child whose function threw.
+    static constexpr int child_threw = 125;
+
+    // Runs f in a child process and returns its exit status, after calling parent in this process.
+    // An exception must not unwind the child into the test runner, which would run the rest of the tests twice.
+    // Threads are only to be started by parent, so the child forks from a single-threaded process.
+    template<typename F, typename Parent>
+    static int run_in_child(F f, Parent parent)
+    {
+        const auto pid = ::fork();
+        if(pid == 0)
+        {
+            int status = child_threw;
+            try
+            {
+                status = f();
+            }
+            catch(...)
+            {
+            }
+            ::_exit(status);
+        }
+        parent();
+        int status = 0;
+        ::waitpid(pid, &status, 0);
+        return WIFEXITED(status)? WEXITSTATUS(status) : -1;
+    }
+
+    template<typename F>
+    static int run_in_child(F f)
+    {
+        return run_in_child(f, []() {});
+    }
+
+    std::string name_;
+};
+
+using namespace container;
+
+struct sample
+{
+    std::uint64_t sequence;
+    double value;
+};
+
+TEST_F(ShmSpscRingTest, push_and_pop)
+{
+    shm_spsc_ring<int> producer(name_, 3);
+    shm_spsc_ring<int> consumer(name_, 4);
+    EXPECT_EQ(4, producer.capacity());
+    EXPECT_EQ(true, consumer.is_empty());
+
+    for(int i = 0; i < 4; i++)
+        EXPECT_EQ(true, producer.try_push(i));
+    EXPECT_EQ(false, producer.try_push(4));
+    EXPECT_EQ(4, consumer.size());
+
+    int value = -1;
+    EXPECT_EQ(true, consumer.try_pop(value));
+    EXPECT_EQ(0, value);
+
+    // Batches wrap around the end of the slots.
+    const int items[] = { 4, 5, 6 };
+    EXPECT_EQ(1, producer.try_push(items, 3));
+    int dest[8] = {};
+    EXPECT_EQ(4, consumer.try_pop(dest, 8));
+    EXPECT_EQ(1, dest[0]);
+    EXPECT_EQ(4, dest[3]);
+    EXPECT_EQ(3, producer.try_push(items, 3));
+    EXPECT_EQ(3, consumer.try_pop(dest, 8));
+    EXPECT_EQ(6, dest[2]);
+    EXPECT_EQ(false, consumer.try_pop(value));
+
+    // Popping from a closed ring drains it first.
+    producer.try_push(7);
+    producer.close();
+    EXPECT_EQ(true, consumer.is_closed());
+    EXPECT_EQ(true, consumer.pop(value));
+    EXPECT_EQ(7, value);
+    EXPECT_EQ(false, consumer.pop(value));
+}
+
+TEST_F(ShmSpscRingTest, attach_mismatch)
+{
+    shm_spsc_ring<int> ring(name_, 8);
+    EXPECT_THROW((shm_spsc_ring<int>(name_, 16)), std::runtime_error);
+    EXPECT_THROW((shm_spsc_ring<sample>(name_, 8)), std::runtime_error);
+
+    // The name outlives the processes until it is unlinked.
+    EXPECT_EQ(true, ring.try_push(1));
+    shm_spsc_ring<int> other(name_, 8);
+    EXPECT_EQ(1, other.size());
+    EXPECT_EQ(true, shm_spsc_ring<int>::unlink(name_));
+    EXPECT_EQ(false, shm_spsc_ring<int>::unlink(name_));
+}
+
+TEST_F(ShmSpscRingTest, move)
+{
+    shm_spsc_ring<int> ring(name_, 8);
+    ring.try_push(1);
+
+    shm_spsc_ring<int> other(std::move(ring));
+    int value = 0;
+    EXPECT_EQ(true, other.try_pop(value));
+    EXPECT_EQ(1, value);
+}
+
+TEST_F(ShmSpscRingTest, child_throws)
+{
+    // Attaching with another capacity throws in the child, which must exit instead of running the tests.
+    shm_spsc_ring<int> ring(name_, 8);
+    const auto status = run_in_child([this]()
+    {
+        shm_spsc_ring<int> other(name_, 16);
+        return 0;
+    });
+    EXPECT_EQ(child_threw, status);
+}
+
+TEST_F(ShmSpscRingTest, across_processes)
+{
+    constexpr std::uint64_t count = 100000;
+    shm_spsc_ring<sample> producer(name_, 64);
+
+    // The child attaches by name and checks the order while the parent keeps it waiting now and then.
+    const auto produce = [&producer]()
+    {
+        for(std::uint64_t i = 0; i < count; i++)
+        {
+            while(!producer.try_push(sample{ i, 0.5 * static_cast<double>(i) }))
+                std::this_thread::yield();
+            if(i % 10000 == 0)
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        producer.close();
+    };
+    const auto status = run_in_child([this]()
+    {
+        shm_spsc_ring<sample> consumer(name_, 64);
+        sample s;
+        std::uint64_t expected = 0;
+        while(consumer.pop(s))
+        {
+            if(s.sequence != expected || s.value != 0.5 * static_cast<double>(expected))
+                return 1;
+            expected++;
+        }
+        return (expected == count)? 0 : 2;
+    }, produce);
+    EXPECT_EQ(0, status);
+    EXPECT_EQ(true, producer.is_empty());
+}
+
+}   // namespace
+#endif
@@ -0,0 +1,122 @@
+#include <cstdint>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <iterator>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <sliding_window.h>
+
+namespace
+{
+
+class SlidingWindowTest : public ::testing::Test {};
+
+using namespace container;
+
+// Recomputes everything from the values in the window.
+template<typename Window>
+void expect_statistics(const Window& window)
+{
+    const std::vector<double> values(window.values().begin(), window.values().end());
+    ASSERT_EQ(false, values.empty());
+
+    const auto n = static_cast<double>(values.size());
+    const auto sum = std::accumulate(values.begin(), values.end(), 0.0);
+    const auto mean = sum / n;
+    double m2 = 0.0;
+    for(auto value : values)
+        m2 += (value - mean) * (value - mean);
+
+    EXPECT_NEAR(sum, window.sum(), 1e-6 * (1.0 + std::abs(sum)));
+    EXPECT_NEAR(mean, window.mean(), 1e-6 * (1.0 + std::abs(mean)));
+    EXPECT_NEAR(m2 / n, window.variance(), 1e-6 * (1.0 + m2 / n));
+    EXPECT_EQ(*std::min_element(values.begin(), values.end()), static_cast<double>(window.min()));
+    EXPECT_EQ(*std::max_element(values.begin(), values.end()), static_cast<double>(window.max()));
+}
+
+TEST_F(SlidingWindowTest, push_back)
+{
+    sliding_window<double> window(4);
+    EXPECT_EQ(true, window.is_empty());
+    EXPECT_EQ(0.0, window.variance());
+
+    // [1] [1 2] [1 2 3] [1 2 3 4] [2 3 4 5]
+    for(int i = 1; i <= 5; i++)
+    {
+        window.push_back(i);
+        expect_statistics(window);
+    }
+    EXPECT_EQ(true, window.is_full());
+    EXPECT_DOUBLE_EQ(14.0, window.sum());
+    EXPECT_DOUBLE_EQ(3.5, window.mean());
+    EXPECT_DOUBLE_EQ(1.25, window.variance());
+    EXPECT_DOUBLE_EQ(5.0 / 3.0, window.sample_variance());
+    EXPECT_EQ(2.0, window.min());
+    EXPECT_EQ(5.0, window.max());
+
+    window.clear();
+    EXPECT_EQ(true, window.is_empty());
+    EXPECT_EQ(0.0, window.sum());
+}
+
+TEST_F(SlidingWindowTest, min_max)
+{
+    sliding_window<int> window(3);
+    const int input[] = { 5, 1, 4, 3, 2, 6, 6, 0 };
+    const int expected_min[] = { 5, 1, 1, 1, 2, 2, 2, 0 };
+    const int expected_max[] = { 5, 5, 5, 4, 4, 6, 6, 6 };
+    for(std::size_t i = 0; i < std::size(input); i++)
+    {
+        window.push_back(input[i]);
+        EXPECT_EQ(expected_min[i], window.min());
+        EXPECT_EQ(expected_max[i], window.max());
+    }
+}
+
+TEST_F(SlidingWindowTest, random)
+{
+    std::mt19937 engine(12345);
+    std::normal_distribution<double> distribution(100.0, 15.0);
+
+    sliding_window<double> window(100);
+    for(int i = 0; i < 10000; i++)
+    {
+        window.push_back(distribution(engine));
+        if(i % 97 == 0)
+            expect_statistics(window);
+    }
+    expect_statistics(window);
+}
+
+TEST_F(SlidingWindowTest, batch)
+{
+    std::mt19937 engine(54321);
+    std::uniform_int_distribution<std::int32_t> distribution(-1000, 1000);
+    std::uniform_int_distribution<std::size_t> batch_size(0, 150);
+
+    // The batches are smaller and larger than the window, and wrap around.
+    sliding_window<std::int32_t> batched(64);
+    sliding_window<std::int32_t> single(64);
+    std::vector<std::int32_t> batch;
+    for(int round = 0; round < 200; round++)
+    {
+        batch.resize(batch_size(engine));
+        for(auto& value : batch)
+            value = distribution(engine);
+
+        batched.push_back(batch.data(), batch.size());
+        for(auto value : batch)
+            single.push_back(value);
+        if(batched.is_empty())
+            continue;
+
+        expect_statistics(batched);
+        EXPECT_EQ(true, std::equal(single.values().begin(), single.values().end(), batched.values().begin(), batched.values().end()));
+        EXPECT_EQ(single.min(), batched.min());
+        EXPECT_EQ(single.max(), batched.max());
+    }
+}
+
+}   // namespace
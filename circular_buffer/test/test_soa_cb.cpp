@@ -0,0 +1,119 @@
+#include <cstdint>
+#include <tuple>
+#include <vector>
+#include <stdexcept>
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <soa_circular_buffer.h>
+#include <circular_buffer_algorithm.h>
+
+namespace
+{
+
+class SoACBTest : public ::testing::Test {};
+
+using namespace container;
+
+using row_buffer = soa_circular_buffer<std::int64_t, double, std::uint8_t>;
+
+// [5 6 _ 3 4] in every column; the timestamp is i, the price i / 2, the flags i * 10.
+row_buffer make_wrapped()
+{
+    row_buffer cb(5);
+    for(int i = 0; i < 7; i++)
+        cb.push_back(i, i / 2.0, static_cast<std::uint8_t>(i * 10));
+    cb.pop_front();
+    return cb;
+}
+
+TEST_F(SoACBTest, push_back)
+{
+    row_buffer cb(3);
+    EXPECT_EQ(true, cb.is_empty());
+    EXPECT_EQ(3, cb.capacity());
+
+    cb.push_back(1, 0.5, 10);
+    cb.push_back(2, 1.0, 20);
+    cb.push_back(std::make_tuple(std::int64_t(3), 1.5, std::uint8_t(30)));
+    EXPECT_EQ(true, cb.is_full());
+    EXPECT_EQ(std::make_tuple(std::int64_t(1), 0.5, std::uint8_t(10)), row_buffer::row_type(cb.front()));
+
+    // Overwrites the oldest row.
+    cb.push_back(4, 2.0, 40);
+    EXPECT_EQ(3, cb.size());
+    EXPECT_EQ(2, std::get<0>(cb.front()));
+    EXPECT_EQ(4, std::get<0>(cb.back()));
+    EXPECT_EQ(2.0, cb.get<1>(2));
+    EXPECT_EQ(40, cb.get<2>(2));
+
+    EXPECT_THROW(cb.at(3), std::out_of_range);
+}
+
+TEST_F(SoACBTest, array_one_and_two)
+{
+    auto cb = make_wrapped();
+    EXPECT_EQ(4, cb.size());
+
+    const auto one = cb.array_one<0>();
+    const auto two = cb.array_two<0>();
+    EXPECT_EQ(2, one.second);
+    EXPECT_EQ(2, two.second);
+    EXPECT_EQ(3, one.first[0]);
+    EXPECT_EQ(4, one.first[1]);
+    EXPECT_EQ(5, two.first[0]);
+    EXPECT_EQ(6, two.first[1]);
+
+    // Every column is split at the same row.
+    const auto& ccb = cb;
+    EXPECT_EQ(2, ccb.array_one<1>().second);
+    EXPECT_EQ(1.5, ccb.array_one<1>().first[0]);
+    EXPECT_EQ(3.0, ccb.array_two<1>().first[1]);
+    EXPECT_EQ(60, ccb.array_two<2>().first[1]);
+}
+
+TEST_F(SoACBTest, row_iterator)
+{
+    auto cb = make_wrapped();
+
+    std::vector<std::int64_t> timestamps;
+    for(const auto& row : cb)
+        timestamps.push_back(std::get<0>(row));
+    EXPECT_EQ((std::vector<std::int64_t>{ 3, 4, 5, 6 }), timestamps);
+
+    // Rows are proxies: writing through one updates the columns.
+    for(auto row : cb)
+        std::get<2>(row) = 1;
+    EXPECT_EQ(4, container::accumulate(cb.column<2>(), 0));
+
+    EXPECT_EQ(4, cb.end() - cb.begin());
+    EXPECT_EQ(5, std::get<0>(cb.begin()[2]));
+    EXPECT_EQ(6, std::get<0>(*(cb.cend() - 1)));
+}
+
+TEST_F(SoACBTest, column)
+{
+    const auto cb = make_wrapped();
+    EXPECT_EQ(3 + 4 + 5 + 6, container::accumulate(cb.column<0>(), std::int64_t(0)));
+    EXPECT_EQ(1.5 + 2.0 + 2.5 + 3.0, container::accumulate(cb.column<1>(), 0.0));
+    EXPECT_EQ(2.5, cb.column<1>()[2]);
+}
+
+TEST_F(SoACBTest, copy_and_move)
+{
+    auto cb = make_wrapped();
+    auto copy = cb;
+    cb.push_back(100, 0.0, 0);
+    EXPECT_EQ(4, copy.size());
+    EXPECT_EQ(6, std::get<0>(copy.back()));
+
+    row_buffer moved(std::move(copy));
+    EXPECT_EQ(4, moved.size());
+    EXPECT_EQ(3, std::get<0>(moved.front()));
+
+    copy = moved;
+    EXPECT_EQ(3, std::get<0>(copy.front()));
+    moved.pop_front(3);
+    EXPECT_EQ(6, std::get<0>(moved.front()));
+}
+
+}   // namespace
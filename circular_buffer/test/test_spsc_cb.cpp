@@ -0,0 +1,269 @@
+#include <thread>
+#include <vector>
+#include <string>
+#include <memory>
+#include <numeric>
+#include <gtest/gtest.h>
+#include <gtest/gtest-spi.h>
+#include <spsc_circular_buffer.h>
+
+namespace
+{
+
+class SPSCCBTest : public ::testing::Test {};
+
+using namespace container;
+
+struct NoDefault
+{
+    NoDefault() = delete;
+    explicit NoDefault(int value) : value_(value) {}
+    int value_;
+};
+
+TEST_F(SPSCCBTest, try_push_back)
+{
+    spsc_circular_buffer<int> cb(3);
+
+    EXPECT_EQ(3, cb.capacity());
+    EXPECT_EQ(true, cb.is_empty());
+
+    EXPECT_EQ(true, cb.try_push_back(1));
+    EXPECT_EQ(true, cb.try_push_back(2));
+    EXPECT_EQ(true, cb.try_push_back(3));
+    EXPECT_EQ(true, cb.is_full());
+
+    // Never overwrites.
+    EXPECT_EQ(false, cb.try_push_back(4));
+    EXPECT_EQ(3, cb.size());
+    EXPECT_EQ(1, cb.front());
+}
+
+TEST_F(SPSCCBTest, try_emplace_back)
+{
+    spsc_circular_buffer<NoDefault> cb(2);
+
+    EXPECT_EQ(true, cb.try_emplace_back(1));
+    EXPECT_EQ(true, cb.try_emplace_back(2));
+    EXPECT_EQ(false, cb.try_emplace_back(3));
+
+    EXPECT_EQ(1, cb.front().value_);
+    cb.pop_front();
+    EXPECT_EQ(2, cb.front().value_);
+}
+
+TEST_F(SPSCCBTest, try_pop_front)
+{
+    spsc_circular_buffer<int> cb(3);
+    int value = 0;
+
+    EXPECT_EQ(false, cb.try_pop_front(value));
+
+    for(int i = 0; i < 10; i++)
+    {
+        EXPECT_EQ(true, cb.try_push_back(i));
+        EXPECT_EQ(true, cb.try_push_back(i + 100));
+        EXPECT_EQ(true, cb.try_pop_front(value));
+        EXPECT_EQ(i, value);
+        EXPECT_EQ(true, cb.try_pop_front(value));
+        EXPECT_EQ(i + 100, value);
+    }
+    EXPECT_EQ(false, cb.try_pop_front(value));
+    EXPECT_EQ(0, cb.size());
+}
+
+TEST_F(SPSCCBTest, array_one_and_array_two)
+{
+    spsc_circular_buffer<int> cb(4);
+
+    cb.try_push_back(1);
+    cb.try_push_back(2);
+    cb.try_push_back(3);
+    cb.pop_front();
+    cb.pop_front();
+    cb.try_push_back(4);
+    cb.try_push_back(5);
+    cb.try_push_back(6);
+
+    // 5 slots: [6 _ 3 4 5]
+    auto a1 = cb.array_one();
+    auto a2 = cb.array_two();
+    EXPECT_EQ(3, a1.second);
+    EXPECT_EQ(3, a1.first[0]);
+    EXPECT_EQ(4, a1.first[1]);
+    EXPECT_EQ(5, a1.first[2]);
+    EXPECT_EQ(1, a2.second);
+    EXPECT_EQ(6, a2.first[0]);
+
+    cb.pop_front();
+    cb.pop_front();
+    cb.pop_front();
+    a1 = cb.array_one();
+    a2 = cb.array_two();
+    EXPECT_EQ(1, a1.second);
+    EXPECT_EQ(6, a1.first[0]);
+    EXPECT_EQ(0, a2.second);
+}
+
+TEST_F(SPSCCBTest, iterator)
+{
+    spsc_circular_buffer<int> cb(4);
+
+    for(int i = 1; i <= 6; i++)
+    {
+        cb.try_push_back(i);
+        if(cb.is_full())
+            cb.pop_front();
+    }
+
+    std::vector<int> actual(cb.begin(), cb.end());
+    EXPECT_EQ((std::vector<int>{ 4, 5, 6 }), actual);
+    EXPECT_EQ(3, cb.end() - cb.begin());
+    EXPECT_EQ(15, std::accumulate(cb.cbegin(), cb.cend(), 0));
+    EXPECT_EQ(6, *cb.rbegin());
+    EXPECT_EQ(5, cb[1]);
+}
+
+TEST_F(SPSCCBTest, destroys_elements)
+{
+    auto item = std::make_shared<int>(0);
+    {
+        spsc_circular_buffer<std::shared_ptr<int>> cb(4);
+        cb.try_push_back(item);
+        cb.try_push_back(item);
+        EXPECT_EQ(3, item.use_count());
+
+        cb.pop_front();
+        EXPECT_EQ(2, item.use_count());
+    }
+    EXPECT_EQ(1, item.use_count());
+}
+
+TEST_F(SPSCCBTest, two_threads)
+{
+    constexpr int count = 100000;
+    spsc_circular_buffer<int> cb(64);
+
+    std::thread producer([&cb]()
+    {
+        for(int i = 0; i < count; i++)
+        {
+            while(!cb.try_push_back(i))
+                std::this_thread::yield();
+        }
+    });
+
+    bool in_order = true;
+    for(int expected = 0; expected < count;)
+    {
+        int value;
+        if(!cb.try_pop_front(value))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        in_order = in_order && (value == expected);
+        expected++;
+    }
+    producer.join();
+
+    EXPECT_EQ(true, in_order);
+    EXPECT_EQ(true, cb.is_empty());
+}
+
+TEST_F(SPSCCBTest, reserve_back_and_peek_front)
+{
+    spsc_circular_buffer<std::string> cb(4);
+
+    // Wrapped: [_ _ _ x _] with the head at 3.
+    for(int i = 0; i < 3; i++)
+        cb.try_push_back("");
+    for(int i = 0; i < 3; i++)
+        cb.pop_front();
+
+    auto slots = cb.reserve_back(8);
+    EXPECT_EQ(2, slots.first.second);
+    EXPECT_EQ(2, slots.second.second);
+    ::new(static_cast<void*>(slots.first.first)) std::string("a");
+    ::new(static_cast<void*>(slots.first.first + 1)) std::string("b");
+    ::new(static_cast<void*>(slots.second.first)) std::string("c");
+    EXPECT_EQ(true, cb.is_empty());
+    cb.commit_back(3);
+    EXPECT_EQ(3, cb.size());
+    EXPECT_EQ(1, cb.reserve_back(8).first.second + cb.reserve_back(8).second.second);
+
+    auto items = cb.peek_front(2);
+    EXPECT_EQ(2, items.first.second);
+    EXPECT_EQ(0, items.second.second);
+    EXPECT_EQ("a", items.first.first[0]);
+    EXPECT_EQ("b", items.first.first[1]);
+    cb.release_front(2);
+
+    // The head has wrapped to the start.
+    items = cb.peek_front(8);
+    EXPECT_EQ(1, items.first.second);
+    EXPECT_EQ(0, items.second.second);
+    EXPECT_EQ("c", items.first.first[0]);
+    cb.release_front(1);
+    EXPECT_EQ(true, cb.is_empty());
+}
+
+TEST_F(SPSCCBTest, reserve_back_two_threads)
+{
+    constexpr int count = 100000;
+    spsc_circular_buffer<int> cb(64);
+
+    std::thread producer([&cb]()
+    {
+        for(int i = 0; i < count;)
+        {
+            const auto slots = cb.reserve_back(16);
+            const auto n = slots.first.second + slots.second.second;
+            if(n == 0)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            for(std::size_t k = 0; k < slots.first.second; k++)
+                slots.first.first[k] = i++;
+            for(std::size_t k = 0; k < slots.second.second; k++)
+                slots.second.first[k] = i++;
+            cb.commit_back(n);
+        }
+    });
+
+    // The producer may overshoot count by less than one reservation.
+    bool in_order = true;
+    for(int expected = 0; expected < count;)
+    {
+        const auto items = cb.peek_front(16);
+        const auto n = items.first.second + items.second.second;
+        if(n == 0)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        for(std::size_t k = 0; k < items.first.second; k++)
+            in_order = in_order && (items.first.first[k] == expected++);
+        for(std::size_t k = 0; k < items.second.second; k++)
+            in_order = in_order && (items.second.first[k] == expected++);
+        cb.release_front(n);
+    }
+    producer.join();
+
+    EXPECT_EQ(true, in_order);
+}
+
+#if defined(__has_include) && __has_include(<memory_resource>)
+TEST_F(SPSCCBTest, pmr)
+{
+    std::pmr::monotonic_buffer_resource resource;
+    pmr::spsc_circular_buffer<int> cb(3, &resource);
+
+    cb.try_push_back(1);
+    EXPECT_EQ(1, cb.front());
+    EXPECT_EQ(&resource, cb.get_allocator().resource());
+}
+#endif
+
+}   // namespace
@@ -0,0 +1,259 @@
+#include <string>
+#include <vector>
+#include <memory>
+#include <iterator>
+#include <stdexcept>
+#include <gtest/gtest.h>
+#include <static_circular_buffer.h>
+
+namespace
+{
+
+class StaticCBTest : public ::testing::Test {};
+
+using namespace container;
+
+TEST_F(StaticCBTest, capacity)
+{
+    static_assert(static_circular_buffer<int, 5>::capacity() == 5, "");
+
+    static_circular_buffer<int, 5> cb;
+    EXPECT_EQ(5, cb.capacity());
+    EXPECT_EQ(true, cb.is_empty());
+
+    // The storage is part of the object.
+    EXPECT_EQ(true, sizeof(cb) >= 5 * sizeof(int));
+    EXPECT_EQ(true, static_cast<const void*>(cb.data()) >= static_cast<const void*>(&cb));
+    EXPECT_EQ(true, static_cast<const void*>(cb.data() + 5) <= static_cast<const void*>(&cb + 1));
+}
+
+TEST_F(StaticCBTest, push_back)
+{
+    static_circular_buffer<int, 3> cb;
+
+    cb.push_back(1);
+    cb.push_back(2);
+    cb.push_back(3);
+    EXPECT_EQ(true, cb.is_full());
+
+    // The oldest element is overwritten.
+    cb.push_back(4);
+    EXPECT_EQ(3, cb.size());
+    EXPECT_EQ(2, cb.front());
+    EXPECT_EQ(4, cb.back());
+    EXPECT_EQ(2, cb[0]);
+    EXPECT_EQ(3, cb[1]);
+    EXPECT_EQ(4, cb[2]);
+    EXPECT_EQ(1, cb.head());
+    EXPECT_EQ(1, cb.tail());
+    EXPECT_THROW(cb.at(3), std::out_of_range);
+}
+
+TEST_F(StaticCBTest, push_front)
+{
+    static_circular_buffer<int, 2> cb;
+
+    cb.push_front(1);
+    cb.push_front(2);
+    cb.push_front(3);
+    EXPECT_EQ(2, cb.size());
+    EXPECT_EQ(3, cb.front());
+    EXPECT_EQ(2, cb.back());
+}
+
+TEST_F(StaticCBTest, emplace)
+{
+    struct item_type
+    {
+        explicit item_type(int n) : value(n) {}
+        item_type(const item_type&) = default;
+        item_type& operator = (const item_type&) = delete;
+        const int value;
+    };
+
+    static_circular_buffer<item_type, 2> cb;
+
+    EXPECT_EQ(1, cb.emplace_back(1).value);
+    EXPECT_EQ(0, cb.emplace_front(0).value);
+    EXPECT_EQ(2, cb.emplace_back(2).value);
+    EXPECT_EQ(1, cb.front().value);
+    EXPECT_EQ(2, cb.back().value);
+}
+
+TEST_F(StaticCBTest, range)
+{
+    static_circular_buffer<float, 4> cb;
+    const float items[] = { 1.f, 2.f, 3.f, 4.f, 5.f, 6.f };
+
+    cb.push_back(std::begin(items), std::end(items));
+    EXPECT_EQ(4, cb.size());
+    EXPECT_EQ(3.f, cb.front());
+
+    cb.pop_front(3);
+    EXPECT_EQ(2, cb.insert_back(items, 2));
+    EXPECT_EQ(1, cb.insert_back(items, 2));
+
+    float dest[4] = {};
+    cb.copy_out(dest, 4);
+    EXPECT_EQ(6.f, dest[0]);
+    EXPECT_EQ(1.f, dest[1]);
+    EXPECT_EQ(2.f, dest[2]);
+    EXPECT_EQ(1.f, dest[3]);
+}
+
+TEST_F(StaticCBTest, iteration)
+{
+    static_circular_buffer<int, 4> cb;
+    for(int i = 0; i < 6; i++)
+        cb.push_back(i);
+
+    EXPECT_EQ((std::vector<int>{ 2, 3, 4, 5 }), std::vector<int>(cb.begin(), cb.end()));
+    EXPECT_EQ((std::vector<int>{ 5, 4, 3, 2 }), std::vector<int>(cb.rbegin(), cb.rend()));
+    EXPECT_EQ(4, std::distance(cb.cbegin(), cb.cend()));
+
+    const auto one = cb.array_one();
+    const auto two = cb.array_two();
+    EXPECT_EQ(cb.data() + 2, one.first);
+    EXPECT_EQ(2, one.second);
+    EXPECT_EQ(cb.data(), two.first);
+    EXPECT_EQ(2, two.second);
+}
+
+TEST_F(StaticCBTest, linearize)
+{
+    {   // Full.
+        static_circular_buffer<std::string, 4> cb;
+        for(int i = 0; i < 6; i++)
+            cb.push_back(std::to_string(i));
+        cb.linearize();
+        EXPECT_EQ(true, cb.is_linearized());
+        EXPECT_EQ("2", cb.data()[0]);
+        EXPECT_EQ("5", cb.data()[3]);
+    }
+    {   // Contiguous.
+        static_circular_buffer<std::string, 4> cb;
+        cb.push_back("a");
+        cb.push_back("b");
+        cb.push_back("c");
+        cb.pop_front();
+        cb.linearize();
+        EXPECT_EQ(0, cb.head());
+        EXPECT_EQ(2, cb.tail());
+        EXPECT_EQ("b", cb.data()[0]);
+        EXPECT_EQ("c", cb.data()[1]);
+    }
+    {   // Wrapped.
+        static_circular_buffer<std::string, 5> cb;
+        for(int i = 0; i < 7; i++)
+            cb.push_back(std::to_string(i));
+        cb.pop_front();
+        cb.pop_front();
+        // [5 6 _ _ 4]
+        cb.linearize();
+        EXPECT_EQ(3, cb.size());
+        EXPECT_EQ(3, cb.tail());
+        EXPECT_EQ("4", cb.data()[0]);
+        EXPECT_EQ("5", cb.data()[1]);
+        EXPECT_EQ("6", cb.data()[2]);
+    }
+}
+
+TEST_F(StaticCBTest, throwing_copy)
+{
+    // Copies throw once the budget runs out; there is no move constructor to fall back on.
+    struct item_type
+    {
+        static int& budget() { static int value = -1; return value; }
+        static int& live() { static int value = 0; return value; }
+
+        explicit item_type(int v) : value(v) { ++live(); }
+        item_type(const item_type& other) : value(other.value)
+        {
+            if(budget() == 0)
+                throw std::runtime_error("copy");
+            --budget();
+            ++live();
+        }
+        item_type& operator = (const item_type&) = default;
+        ~item_type() { --live(); }
+
+        int value;
+    };
+
+    {   // [5 _ _ 0 1 2 3 4]
+        static_circular_buffer<item_type, 8> cb;
+        for(int i = 0; i < 3; i++)
+            cb.push_back(item_type(-1));
+        for(int i = 0; i < 3; i++)
+            cb.pop_front();
+        for(int i = 0; i < 6; i++)
+            cb.push_back(item_type(i));
+
+        // The copies made before the throw are destroyed.
+        item_type::budget() = 2;
+        EXPECT_THROW((static_circular_buffer<item_type, 8>(cb)), std::runtime_error);
+        EXPECT_EQ(6, item_type::live());
+
+        // Nothing changes when a copy out throws.
+        item_type::budget() = 1;
+        EXPECT_THROW(cb.linearize(), std::runtime_error);
+        item_type::budget() = -1;
+        EXPECT_EQ(false, cb.is_linearized());
+        EXPECT_EQ(6, item_type::live());
+        for(int i = 0; i < 6; i++)
+            EXPECT_EQ(i, cb[static_cast<std::size_t>(i)].value);
+
+        cb.linearize();
+        EXPECT_EQ(true, cb.is_linearized());
+        EXPECT_EQ(6, item_type::live());
+        for(int i = 0; i < 6; i++)
+            EXPECT_EQ(i, cb.data()[i].value);
+    }
+    EXPECT_EQ(0, item_type::live());
+}
+
+TEST_F(StaticCBTest, copy_and_move)
+{
+    static_circular_buffer<std::string, 3> cb;
+    cb.push_back("a");
+    cb.push_back("b");
+    cb.push_back("c");
+    cb.push_back("d");
+
+    auto copy = cb;
+    EXPECT_EQ((std::vector<std::string>{ "b", "c", "d" }), std::vector<std::string>(copy.begin(), copy.end()));
+
+    auto moved = std::move(copy);
+    EXPECT_EQ(true, copy.is_empty());
+    EXPECT_EQ(3, moved.size());
+    EXPECT_EQ("b", moved.front());
+
+    copy = moved;
+    EXPECT_EQ("d", copy.back());
+    moved = std::move(copy);
+    EXPECT_EQ("d", moved.back());
+}
+
+TEST_F(StaticCBTest, element_lifetime)
+{
+    auto item = std::make_shared<int>(0);
+    {
+        static_circular_buffer<std::shared_ptr<int>, 2> cb;
+        cb.push_back(item);
+        cb.push_back(item);
+        EXPECT_EQ(3, item.use_count());
+
+        cb.push_back(std::make_shared<int>(1));
+        EXPECT_EQ(2, item.use_count());
+
+        cb.pop_back();
+        cb.push_front(item);
+        cb.clear();
+        EXPECT_EQ(1, item.use_count());
+
+        cb.push_back(item);
+    }
+    EXPECT_EQ(1, item.use_count());
+}
+
+}   // namespace
@@ -0,0 +1,159 @@
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <gtest/gtest.h>
+#include <work_stealing_deque.h>
+
+namespace
+{
+
+class WorkStealingDequeTest : public ::testing::Test {};
+
+using namespace container;
+
+TEST_F(WorkStealingDequeTest, capacity)
+{
+    EXPECT_EQ(1, work_stealing_deque<int>(1).capacity());
+    EXPECT_EQ(4, work_stealing_deque<int>(3).capacity());
+    EXPECT_EQ(8, work_stealing_deque<int>(5).capacity());
+}
+
+TEST_F(WorkStealingDequeTest, pop_back_and_steal)
+{
+    work_stealing_deque<int> dq(4);
+    int value = 0;
+
+    EXPECT_EQ(false, dq.try_pop_back(value));
+    EXPECT_EQ(false, dq.try_steal(value));
+    EXPECT_EQ(true, dq.is_empty());
+
+    for(int lap = 0; lap < 3; lap++)
+    {
+        for(int i = 1; i <= 4; i++)
+            dq.push_back(i);
+        EXPECT_EQ(4, dq.size());
+
+        // The owner takes the newest, thieves the oldest.
+        EXPECT_EQ(true, dq.try_pop_back(value));
+        EXPECT_EQ(4, value);
+        EXPECT_EQ(true, dq.try_steal(value));
+        EXPECT_EQ(1, value);
+        EXPECT_EQ(true, dq.try_pop_back(value));
+        EXPECT_EQ(3, value);
+        EXPECT_EQ(true, dq.try_steal(value));
+        EXPECT_EQ(2, value);
+
+        EXPECT_EQ(false, dq.try_pop_back(value));
+        EXPECT_EQ(false, dq.try_steal(value));
+    }
+    EXPECT_EQ(4, dq.capacity());
+}
+
+TEST_F(WorkStealingDequeTest, grow)
+{
+    work_stealing_deque<int> dq(2);
+    int value = 0;
+
+    // Wrapped, so that the elements straddle the end of the ring when it grows.
+    dq.push_back(-1);
+    EXPECT_EQ(true, dq.try_steal(value));
+    for(int i = 0; i < 9; i++)
+        dq.push_back(i);
+    EXPECT_EQ(16, dq.capacity());
+    EXPECT_EQ(9, dq.size());
+
+    for(int i = 0; i < 4; i++)
+    {
+        EXPECT_EQ(true, dq.try_steal(value));
+        EXPECT_EQ(i, value);
+    }
+    for(int i = 8; i >= 4; i--)
+    {
+        EXPECT_EQ(true, dq.try_pop_back(value));
+        EXPECT_EQ(i, value);
+    }
+    EXPECT_EQ(true, dq.is_empty());
+}
+
+TEST_F(WorkStealingDequeTest, owner_and_thieves)
+{
+    constexpr std::uint32_t thieves = 3;
+    constexpr std::uint32_t total = 100000;
+
+    // Starts small, so that it grows while thieves are stealing.
+    work_stealing_deque<std::uint32_t> dq(2);
+    std::vector<std::atomic<std::uint32_t>> seen(total);
+    std::atomic<std::uint32_t> taken(0);
+    std::vector<std::uint32_t> stolen(thieves, 0);
+
+    std::vector<std::thread> threads;
+    for(std::uint32_t t = 0; t < thieves; t++)
+    {
+        threads.emplace_back([&dq, &seen, &taken, &stolen, t]()
+        {
+            std::uint32_t count = 0;
+            std::uint32_t value;
+            while(taken.load() < total)
+            {
+                if(!dq.try_steal(value))
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+                seen[value]++;
+                taken++;
+                count++;
+            }
+            stolen[t] = count;
+        });
+    }
+
+    // The owner pops about one element for every two it pushes.
+    std::uint32_t value;
+    for(std::uint32_t i = 0; i < total; i++)
+    {
+        dq.push_back(i);
+        if((i % 2 == 1) && dq.try_pop_back(value))
+        {
+            seen[value]++;
+            taken++;
+        }
+    }
+    while(taken.load() < total)
+    {
+        if(dq.try_pop_back(value))
+        {
+            seen[value]++;
+            taken++;
+        }
+    }
+    for(auto& thread : threads)
+        thread.join();
+
+    EXPECT_EQ(total, taken.load());
+    bool exactly_once = true;
+    for(const auto& count : seen)
+        exactly_once = exactly_once && (count.load() == 1);
+    EXPECT_EQ(true, exactly_once);
+    EXPECT_EQ(true, dq.is_empty());
+}
+
+#if defined(__has_include) && __has_include(<memory_resource>)
+TEST_F(WorkStealingDequeTest, pmr)
+{
+    std::pmr::monotonic_buffer_resource resource;
+    pmr::work_stealing_deque<int> dq(1, &resource);
+    int value = 0;
+
+    dq.push_back(1);
+    dq.push_back(2);
+    EXPECT_EQ(2, dq.capacity());
+    EXPECT_EQ(true, dq.try_steal(value));
+    EXPECT_EQ(1, value);
+    EXPECT_EQ(&resource, dq.get_allocator().resource());
+}
+#endif
+
+}   // namespace